@@ -0,0 +1,45 @@
+# swc: bench/local.mk
+
+dir := bench
+
+$(dir)_PACKAGES = wayland-client wld
+
+$(dir): $(dir)/swc-bench $(dir)/swc-damage-bench $(dir)/swc-replay
+
+$(dir)/swc-bench.o: protocol/presentation-time-client-protocol.h
+
+$(dir)/swc-bench: $(dir)/swc-bench.o protocol/presentation-time-protocol.o
+	$(link) $(bench_PACKAGE_LIBS)
+
+# The damage benchmark is linked against the compositor's own objects, with
+# the rest of libswc and the renderer replaced by stubs, so it needs the same
+# headers as libswc but only links against pixman and wayland-server.
+SWC_DAMAGE_BENCH_OBJECTS =          \
+    $(dir)/swc-damage-bench.o       \
+    $(dir)/swc-damage-bench-stubs.o \
+    libswc/compositor.o             \
+    libswc/damage.o                 \
+    libswc/grid.o                   \
+    libswc/timing.o                 \
+    libswc/view.o
+
+$(dir)/swc-damage-bench.o $(dir)/swc-damage-bench-stubs.o: \
+    bench_PACKAGE_CFLAGS = $(libswc_PACKAGE_CFLAGS)
+
+$(dir)/swc-damage-bench: $(SWC_DAMAGE_BENCH_OBJECTS)
+	$(link) $(call pkgconfig,pixman-1 wayland-server,libs,LIBS)
+
+$(dir)/swc-replay: $(dir)/swc-replay.o
+	$(link) $(bench_PACKAGE_LIBS)
+
+CLEAN_FILES +=                      \
+    $(dir)/swc-bench.o              \
+    $(dir)/swc-bench                \
+    $(dir)/swc-damage-bench.o       \
+    $(dir)/swc-damage-bench-stubs.o \
+    $(dir)/swc-damage-bench         \
+    $(dir)/swc-replay.o             \
+    $(dir)/swc-replay
+
+include common.mk
+
@@ -0,0 +1,869 @@
+/* swc: bench/swc-bench.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* A Wayland client that puts a compositor under a repeatable load, and
+ * reports frame timing as JSON on stdout.
+ *
+ * With -c, the compositor is sent SIGUSR2 at the start of the run to reset
+ * its frame timing, and SIGUSR1 at the end to report it. With -f as well, the
+ * frame timing it writes to that file (see swc_write_frame_timing) is
+ * included in the output.
+ *
+ * Buffer contents are only updated where the damage pattern says they change,
+ * so what ends up on screen is not meant to be looked at. */
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/param.h>
+#include <sys/timerfd.h>
+#include <wayland-client.h>
+#include <wld/wld.h>
+#include <wld/wayland.h>
+#include "protocol/presentation-time-client-protocol.h"
+
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof(array[0]))
+#define NUM_BUFFERS 3
+
+/* The size of the rectangles drawn by the rects and move patterns. */
+#define RECT_SIZE 32
+#define RECTS_PER_FRAME 8
+#define SPRITE_SIZE (RECT_SIZE * 4)
+
+enum pattern
+{
+    PATTERN_FULL,
+    PATTERN_SCROLL,
+    PATTERN_RECTS,
+    PATTERN_MOVE
+};
+
+static const char * pattern_names[] = {
+    [PATTERN_FULL]      = "full",
+    [PATTERN_SCROLL]    = "scroll",
+    [PATTERN_RECTS]     = "rects",
+    [PATTERN_MOVE]      = "move"
+};
+
+struct samples
+{
+    uint64_t * data;
+    size_t size, capacity;
+};
+
+struct buffer
+{
+    struct wld_buffer * wld;
+    struct wl_buffer * wl;
+    bool busy;
+};
+
+struct surface
+{
+    unsigned index;
+    struct wl_surface * wl;
+    struct wl_shell_surface * shell_surface;
+    struct buffer buffers[NUM_BUFFERS];
+    struct buffer * last;
+
+    /* The callback for the last commit, and when it was made. */
+    struct wl_callback * frame;
+    uint64_t commit_time;
+
+    uint64_t frames, last_sequence;
+    int32_t x, y;
+};
+
+struct feedback
+{
+    struct wp_presentation_feedback * wp;
+    struct surface * surface;
+    uint64_t commit_time;
+};
+
+static struct
+{
+    unsigned num_surfaces;
+    uint32_t width, height;
+    enum pattern pattern;
+    double rate, duration;
+    enum wld_wayland_interface_id interface;
+    pid_t compositor;
+    const char * timing_file;
+} options = {
+    .num_surfaces = 1,
+    .width = 640,
+    .height = 480,
+    .pattern = PATTERN_FULL,
+    .rate = 0,
+    .duration = 10,
+    .interface = WLD_SHM,
+    .compositor = 0,
+    .timing_file = NULL
+};
+
+static struct
+{
+    struct wl_display * display;
+    struct wl_registry * registry;
+    struct wl_compositor * compositor;
+    struct wl_shell * shell;
+    struct wp_presentation * presentation;
+    clockid_t presentation_clock;
+
+    struct wld_context * context;
+    struct wld_renderer * renderer;
+
+    struct surface * surfaces;
+    uint64_t frame_number;
+
+    /* Frame callback round trips, and the time from a commit until it was
+     * presented according to the presentation-time extension. */
+    struct samples callback, latency;
+    uint64_t commits, skipped, discarded, missed_vblanks;
+
+    bool running;
+} bench;
+
+static void __attribute__((noreturn,format(printf,1,2)))
+    die(const char * format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+
+    exit(EXIT_FAILURE);
+}
+
+static void __attribute__((noreturn)) usage(const char * name)
+{
+    fprintf(stderr, "Usage: %s [-h] [-n surfaces] [-s WIDTHxHEIGHT] "
+                    "[-p full|scroll|rects|move] [-r rate] [-t seconds] "
+                    "[-b shm|drm] [-c compositor-pid [-f timing-file]]\n",
+            name);
+    exit(EXIT_FAILURE);
+}
+
+static uint64_t timespec_to_nsec(const struct timespec * time)
+{
+    return (uint64_t) time->tv_sec * 1000000000 + time->tv_nsec;
+}
+
+static uint64_t now(clockid_t clock)
+{
+    struct timespec time;
+
+    clock_gettime(clock, &time);
+    return timespec_to_nsec(&time);
+}
+
+/* Samples {{{ */
+
+static void samples_add(struct samples * samples, uint64_t value)
+{
+    if (samples->size == samples->capacity)
+    {
+        samples->capacity = samples->capacity ? samples->capacity * 2 : 1024;
+        samples->data = realloc(samples->data,
+                                samples->capacity * sizeof *samples->data);
+
+        if (!samples->data)
+            die("Could not allocate samples");
+    }
+
+    samples->data[samples->size++] = value;
+}
+
+static int compare_samples(const void * a, const void * b)
+{
+    uint64_t value_a = *(const uint64_t *) a, value_b = *(const uint64_t *) b;
+
+    return value_a < value_b ? -1 : value_a > value_b;
+}
+
+static void print_samples(const char * name, struct samples * samples)
+{
+    static const unsigned percentiles[] = { 50, 90, 99 };
+    uint64_t total = 0;
+    unsigned index;
+
+    printf("\t\"%s\": { \"count\": %zu", name, samples->size);
+
+    if (samples->size > 0)
+    {
+        qsort(samples->data, samples->size, sizeof *samples->data,
+              &compare_samples);
+
+        for (index = 0; index < samples->size; ++index)
+            total += samples->data[index];
+
+        printf(", \"min_us\": %.1f, \"mean_us\": %.1f",
+               samples->data[0] / 1e3, total / 1e3 / samples->size);
+
+        for (index = 0; index < ARRAY_SIZE(percentiles); ++index)
+        {
+            printf(", \"p%u_us\": %.1f", percentiles[index],
+                   samples->data[(samples->size - 1) * percentiles[index]
+                                 / 100] / 1e3);
+        }
+
+        printf(", \"max_us\": %.1f", samples->data[samples->size - 1] / 1e3);
+    }
+
+    printf(" }");
+}
+
+/* }}} */
+
+/* Registry {{{ */
+
+static void handle_clock_id(void * data, struct wp_presentation * presentation,
+                            uint32_t clock_id)
+{
+    bench.presentation_clock = clock_id;
+}
+
+static const struct wp_presentation_listener presentation_listener = {
+    .clock_id = &handle_clock_id
+};
+
+static void handle_global(void * data, struct wl_registry * registry,
+                          uint32_t name, const char * interface,
+                          uint32_t version)
+{
+    if (strcmp(interface, "wl_compositor") == 0)
+    {
+        bench.compositor = wl_registry_bind(registry, name,
+                                            &wl_compositor_interface, 1);
+    }
+    else if (strcmp(interface, "wl_shell") == 0)
+    {
+        bench.shell = wl_registry_bind(registry, name, &wl_shell_interface, 1);
+    }
+    else if (strcmp(interface, "wp_presentation") == 0)
+    {
+        bench.presentation = wl_registry_bind(registry, name,
+                                              &wp_presentation_interface, 1);
+        wp_presentation_add_listener(bench.presentation,
+                                     &presentation_listener, NULL);
+    }
+}
+
+static void handle_global_remove(void * data, struct wl_registry * registry,
+                                 uint32_t name)
+{
+}
+
+static const struct wl_registry_listener registry_listener = {
+    .global = &handle_global,
+    .global_remove = &handle_global_remove
+};
+
+/* }}} */
+
+/* Surfaces {{{ */
+
+static void handle_release(void * data, struct wl_buffer * wl)
+{
+    struct buffer * buffer = data;
+
+    buffer->busy = false;
+}
+
+static const struct wl_buffer_listener buffer_listener = {
+    .release = &handle_release
+};
+
+static void handle_ping(void * data, struct wl_shell_surface * shell_surface,
+                        uint32_t serial)
+{
+    wl_shell_surface_pong(shell_surface, serial);
+}
+
+static void handle_configure(void * data,
+                             struct wl_shell_surface * shell_surface,
+                             uint32_t edges, int32_t width, int32_t height)
+{
+}
+
+static void handle_popup_done(void * data,
+                              struct wl_shell_surface * shell_surface)
+{
+}
+
+static const struct wl_shell_surface_listener shell_surface_listener = {
+    .ping = &handle_ping,
+    .configure = &handle_configure,
+    .popup_done = &handle_popup_done
+};
+
+static void surface_initialize(struct surface * surface, unsigned index)
+{
+    struct buffer * buffer;
+    union wld_object object;
+    unsigned buffer_index;
+
+    surface->index = index;
+    surface->wl = wl_compositor_create_surface(bench.compositor);
+    surface->shell_surface = wl_shell_get_shell_surface(bench.shell,
+                                                        surface->wl);
+    wl_shell_surface_add_listener(surface->shell_surface,
+                                  &shell_surface_listener, surface);
+    wl_shell_surface_set_toplevel(surface->shell_surface);
+
+    for (buffer_index = 0; buffer_index < NUM_BUFFERS; ++buffer_index)
+    {
+        buffer = &surface->buffers[buffer_index];
+        buffer->wld = wld_create_buffer(bench.context,
+                                        options.width, options.height,
+                                        WLD_FORMAT_XRGB8888, 0);
+
+        if (!buffer->wld)
+            die("Could not create buffer");
+
+        if (!wld_export(buffer->wld, WLD_WAYLAND_OBJECT_BUFFER, &object))
+            die("Could not export buffer to Wayland");
+
+        buffer->wl = object.ptr;
+        buffer->busy = false;
+        wl_buffer_add_listener(buffer->wl, &buffer_listener, buffer);
+
+        wld_set_target_buffer(bench.renderer, buffer->wld);
+        wld_fill_rectangle(bench.renderer, 0xff202020, 0, 0,
+                           options.width, options.height);
+    }
+
+    wld_flush(bench.renderer);
+
+    surface->last = NULL;
+    surface->frame = NULL;
+    surface->frames = 0;
+    surface->last_sequence = 0;
+    surface->x = 0;
+    surface->y = 0;
+}
+
+static struct buffer * surface_next_buffer(struct surface * surface)
+{
+    unsigned index;
+
+    for (index = 0; index < NUM_BUFFERS; ++index)
+    {
+        if (!surface->buffers[index].busy)
+            return &surface->buffers[index];
+    }
+
+    return NULL;
+}
+
+static uint32_t color(uint64_t frame, unsigned index)
+{
+    return 0xff000000 | ((frame * 2654435761u + index * 40503) & 0xffffff);
+}
+
+/* Draws the next frame of the pattern into the buffer, and damages the
+ * surface accordingly. */
+static void draw(struct surface * surface, struct buffer * buffer)
+{
+    uint64_t frame = surface->frames;
+    uint32_t width = options.width, height = options.height;
+    uint32_t line = MIN(16, height);
+    int32_t x, y;
+    unsigned index;
+
+    wld_set_target_buffer(bench.renderer, buffer->wld);
+
+    switch (options.pattern)
+    {
+        case PATTERN_FULL:
+            wld_fill_rectangle(bench.renderer, color(frame, surface->index),
+                               0, 0, width, height);
+            wl_surface_damage(surface->wl, 0, 0, width, height);
+            break;
+        case PATTERN_SCROLL:
+            /* Move the contents of the last frame up by a line, and draw a
+             * new line at the bottom, like a terminal would. */
+            if (surface->last && surface->last != buffer && height > line)
+            {
+                wld_copy_rectangle(bench.renderer, surface->last->wld,
+                                   0, 0, 0, line, width, height - line);
+            }
+
+            wld_fill_rectangle(bench.renderer, color(frame, surface->index),
+                               0, height - line, width, line);
+            wl_surface_damage(surface->wl, 0, 0, width, height);
+            break;
+        case PATTERN_RECTS:
+            for (index = 0; index < RECTS_PER_FRAME; ++index)
+            {
+                x = (frame * 7919 + index * 104729) % MAX(width - RECT_SIZE, 1);
+                y = (frame * 6271 + index * 15485863)
+                    % MAX(height - RECT_SIZE, 1);
+                wld_fill_rectangle(bench.renderer,
+                                   color(frame, surface->index + index),
+                                   x, y, RECT_SIZE, RECT_SIZE);
+                wl_surface_damage(surface->wl, x, y, RECT_SIZE, RECT_SIZE);
+            }
+            break;
+        case PATTERN_MOVE:
+            /* A rectangle bouncing around the surface, which damages both
+             * where it was and where it is now. */
+            wld_fill_rectangle(bench.renderer, 0xff202020,
+                               surface->x, surface->y,
+                               SPRITE_SIZE, SPRITE_SIZE);
+            wl_surface_damage(surface->wl, surface->x, surface->y,
+                              SPRITE_SIZE, SPRITE_SIZE);
+
+            width = MAX(width - SPRITE_SIZE, 1);
+            height = MAX(height - SPRITE_SIZE, 1);
+            x = frame * 5 % (2 * width);
+            y = frame * 3 % (2 * height);
+            surface->x = x < width ? x : 2 * width - x;
+            surface->y = y < height ? y : 2 * height - y;
+
+            wld_fill_rectangle(bench.renderer, color(frame, surface->index),
+                               surface->x, surface->y,
+                               SPRITE_SIZE, SPRITE_SIZE);
+            wl_surface_damage(surface->wl, surface->x, surface->y,
+                              SPRITE_SIZE, SPRITE_SIZE);
+            break;
+    }
+
+    wld_flush(bench.renderer);
+}
+
+static void handle_presented(void * data,
+                             struct wp_presentation_feedback * wp,
+                             uint32_t tv_sec_hi, uint32_t tv_sec_lo,
+                             uint32_t tv_nsec, uint32_t refresh,
+                             uint32_t seq_hi, uint32_t seq_lo, uint32_t flags)
+{
+    struct feedback * feedback = data;
+    struct surface * surface = feedback->surface;
+    uint64_t sequence = (uint64_t) seq_hi << 32 | seq_lo;
+    struct timespec time = {
+        .tv_sec = (uint64_t) tv_sec_hi << 32 | tv_sec_lo,
+        .tv_nsec = tv_nsec
+    };
+    uint64_t presented = timespec_to_nsec(&time);
+
+    if (presented > feedback->commit_time)
+        samples_add(&bench.latency, presented - feedback->commit_time);
+
+    /* We commit once per frame, so every vblank that passes between two
+     * presentations is one where the surface could have been updated. */
+    if (surface->last_sequence && sequence > surface->last_sequence + 1
+        && options.rate == 0)
+    {
+        bench.missed_vblanks += sequence - surface->last_sequence - 1;
+    }
+
+    surface->last_sequence = sequence;
+    wp_presentation_feedback_destroy(wp);
+    free(feedback);
+}
+
+static void handle_discarded(void * data, struct wp_presentation_feedback * wp)
+{
+    struct feedback * feedback = data;
+
+    ++bench.discarded;
+    wp_presentation_feedback_destroy(wp);
+    free(feedback);
+}
+
+static void handle_sync_output(void * data,
+                               struct wp_presentation_feedback * wp,
+                               struct wl_output * output)
+{
+}
+
+static const struct wp_presentation_feedback_listener feedback_listener = {
+    .sync_output = &handle_sync_output,
+    .presented = &handle_presented,
+    .discarded = &handle_discarded
+};
+
+static void surface_commit(struct surface * surface);
+
+static void handle_frame(void * data, struct wl_callback * callback,
+                         uint32_t time)
+{
+    struct surface * surface = data;
+
+    samples_add(&bench.callback,
+                now(CLOCK_MONOTONIC) - surface->commit_time);
+    wl_callback_destroy(callback);
+    surface->frame = NULL;
+
+    /* Without a fixed rate, commit as fast as the compositor lets us. */
+    if (options.rate == 0 && bench.running)
+        surface_commit(surface);
+}
+
+static const struct wl_callback_listener frame_listener = {
+    .done = &handle_frame
+};
+
+static void surface_commit(struct surface * surface)
+{
+    struct buffer * buffer;
+    struct feedback * feedback;
+
+    /* Don't get ahead of the compositor. */
+    if (surface->frame || !(buffer = surface_next_buffer(surface)))
+    {
+        ++bench.skipped;
+        return;
+    }
+
+    draw(surface, buffer);
+    wl_surface_attach(surface->wl, buffer->wl, 0, 0);
+    surface->frame = wl_surface_frame(surface->wl);
+    wl_callback_add_listener(surface->frame, &frame_listener, surface);
+
+    if (bench.presentation && (feedback = malloc(sizeof *feedback)))
+    {
+        feedback->wp = wp_presentation_feedback(bench.presentation,
+                                                surface->wl);
+        feedback->surface = surface;
+        wp_presentation_feedback_add_listener(feedback->wp,
+                                              &feedback_listener, feedback);
+    }
+    else
+        feedback = NULL;
+
+    surface->commit_time = now(CLOCK_MONOTONIC);
+
+    if (feedback)
+        feedback->commit_time = now(bench.presentation_clock);
+
+    wl_surface_commit(surface->wl);
+    buffer->busy = true;
+    surface->last = buffer;
+    ++surface->frames;
+    ++bench.commits;
+}
+
+/* }}} */
+
+static void parse_options(int argc, char * argv[])
+{
+    int option;
+    char * end;
+
+    while ((option = getopt(argc, argv, "hn:s:p:r:t:b:c:f:")) != -1)
+    {
+        switch (option)
+        {
+            case 'n':
+                options.num_surfaces = strtoul(optarg, &end, 10);
+                if (*end || options.num_surfaces == 0)
+                    usage(argv[0]);
+                break;
+            case 's':
+                if (sscanf(optarg, "%ux%u", &options.width,
+                           &options.height) != 2
+                    || options.width < SPRITE_SIZE
+                    || options.height < SPRITE_SIZE)
+                {
+                    usage(argv[0]);
+                }
+                break;
+            case 'p':
+                for (options.pattern = 0;
+                     options.pattern < ARRAY_SIZE(pattern_names);
+                     ++options.pattern)
+                {
+                    if (strcmp(optarg, pattern_names[options.pattern]) == 0)
+                        break;
+                }
+
+                if (options.pattern == ARRAY_SIZE(pattern_names))
+                    usage(argv[0]);
+                break;
+            case 'r':
+                options.rate = strtod(optarg, &end);
+                if (*end || options.rate < 0)
+                    usage(argv[0]);
+                break;
+            case 't':
+                options.duration = strtod(optarg, &end);
+                if (*end || !(options.duration > 0))
+                    usage(argv[0]);
+                break;
+            case 'b':
+                if (strcmp(optarg, "shm") == 0)
+                    options.interface = WLD_SHM;
+                else if (strcmp(optarg, "drm") == 0)
+                    options.interface = WLD_DRM;
+                else
+                    usage(argv[0]);
+                break;
+            case 'c':
+                options.compositor = strtol(optarg, &end, 10);
+                if (*end)
+                    usage(argv[0]);
+                break;
+            case 'f':
+                options.timing_file = optarg;
+                break;
+            case 'h':
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (options.timing_file && options.compositor <= 0)
+        usage(argv[0]);
+}
+
+/* Sends the compositor a signal: SIGUSR2 to reset its frame timing before the
+ * run, or SIGUSR1 to report it afterwards. If it writes the statistics to the
+ * timing file in response, returns their JSON. */
+static char * signal_compositor(int signal_number)
+{
+    const struct timespec delay = { .tv_nsec = 10000000 };
+    FILE * file = NULL;
+    char * contents = NULL;
+    size_t size = 0;
+    ssize_t length;
+    unsigned attempt;
+
+    /* Don't pick up the statistics of an earlier run. */
+    if (options.timing_file && unlink(options.timing_file) != 0
+        && errno != ENOENT)
+    {
+        fprintf(stderr, "Could not remove %s: %s\n",
+                options.timing_file, strerror(errno));
+        return NULL;
+    }
+
+    if (kill(options.compositor, signal_number) != 0)
+    {
+        fprintf(stderr, "Could not signal compositor: %s\n", strerror(errno));
+        return NULL;
+    }
+
+    if (!options.timing_file)
+        return NULL;
+
+    /* The compositor writes the file when it gets around to handling the
+     * signal, and moves it into place once it is complete. */
+    for (attempt = 0; attempt < 100; ++attempt)
+    {
+        if ((file = fopen(options.timing_file, "r")) || errno != ENOENT)
+            break;
+
+        nanosleep(&delay, NULL);
+    }
+
+    if (!file)
+    {
+        fprintf(stderr, "Compositor did not write %s\n", options.timing_file);
+        return NULL;
+    }
+
+    length = getdelim(&contents, &size, '\0', file);
+    fclose(file);
+
+    if (length <= 0)
+    {
+        fprintf(stderr, "Could not read %s\n", options.timing_file);
+        free(contents);
+        return NULL;
+    }
+
+    while (length > 0 && contents[length - 1] == '\n')
+        contents[--length] = '\0';
+
+    return contents;
+}
+
+static int create_timer(double interval)
+{
+    struct itimerspec timer;
+    int fd;
+
+    if ((fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC)) == -1)
+        die("Could not create timer: %s", strerror(errno));
+
+    timer.it_value.tv_sec = interval;
+    timer.it_value.tv_nsec = (interval - (time_t) interval) * 1e9;
+    timer.it_interval = timer.it_value;
+
+    /* A zero interval would disarm the timer. */
+    if (timer.it_value.tv_sec == 0 && timer.it_value.tv_nsec == 0)
+        timer.it_value.tv_nsec = timer.it_interval.tv_nsec = 1;
+
+    if (timerfd_settime(fd, 0, &timer, NULL) != 0)
+        die("Could not arm timer: %s", strerror(errno));
+
+    return fd;
+}
+
+static void print_results(double elapsed, const char * compositor_timing)
+{
+    printf("{\n");
+    printf("\t\"surfaces\": %u,\n", options.num_surfaces);
+    printf("\t\"width\": %u,\n\t\"height\": %u,\n",
+           options.width, options.height);
+    printf("\t\"pattern\": \"%s\",\n", pattern_names[options.pattern]);
+    printf("\t\"buffers\": \"%s\",\n",
+           options.interface == WLD_DRM ? "drm" : "shm");
+    printf("\t\"rate\": %g,\n", options.rate);
+    printf("\t\"duration\": %.3f,\n", elapsed);
+    printf("\t\"commits\": %llu,\n", (unsigned long long) bench.commits);
+    printf("\t\"commits_per_second\": %.1f,\n", bench.commits / elapsed);
+    printf("\t\"skipped\": %llu,\n", (unsigned long long) bench.skipped);
+    printf("\t\"discarded\": %llu,\n", (unsigned long long) bench.discarded);
+    printf("\t\"missed_vblanks\": %llu,\n",
+           (unsigned long long) bench.missed_vblanks);
+    print_samples("frame_callback", &bench.callback);
+    printf(",\n");
+    print_samples("presentation", &bench.latency);
+
+    if (compositor_timing)
+        printf(",\n\t\"compositor\": %s", compositor_timing);
+
+    printf("\n}\n");
+}
+
+int main(int argc, char * argv[])
+{
+    struct pollfd fds[3];
+    uint64_t start, end, expirations;
+    unsigned index;
+    char * compositor_timing = NULL;
+
+    parse_options(argc, argv);
+
+    if (!(bench.display = wl_display_connect(NULL)))
+        die("Could not connect to Wayland display");
+
+    bench.presentation_clock = CLOCK_MONOTONIC;
+    bench.registry = wl_display_get_registry(bench.display);
+    wl_registry_add_listener(bench.registry, &registry_listener, NULL);
+    wl_display_roundtrip(bench.display);
+    wl_display_roundtrip(bench.display);
+
+    if (!bench.compositor || !bench.shell)
+        die("Compositor does not support wl_compositor and wl_shell");
+
+    if (!bench.presentation)
+        fprintf(stderr, "No wp_presentation, not measuring presentation\n");
+
+    bench.context = wld_wayland_create_context(bench.display,
+                                               options.interface, WLD_NONE);
+
+    if (!bench.context)
+        die("Could not create %s context",
+            options.interface == WLD_DRM ? "DRM" : "SHM");
+
+    if (!(bench.renderer = wld_create_renderer(bench.context)))
+        die("Could not create renderer");
+
+    if (!(bench.surfaces = calloc(options.num_surfaces,
+                                  sizeof *bench.surfaces)))
+    {
+        die("Could not allocate surfaces");
+    }
+
+    for (index = 0; index < options.num_surfaces; ++index)
+        surface_initialize(&bench.surfaces[index], index);
+
+    wl_display_roundtrip(bench.display);
+
+    fds[0].fd = wl_display_get_fd(bench.display);
+    fds[0].events = POLLIN;
+    fds[1].fd = create_timer(options.duration);
+    fds[1].events = POLLIN;
+    fds[2].fd = options.rate > 0 ? create_timer(1 / options.rate) : -1;
+    fds[2].events = POLLIN;
+
+    /* Only count the compositor's frames from this run. Once the timing file
+     * is written, the reset has been handled. */
+    if (options.compositor > 0)
+        free(signal_compositor(SIGUSR2));
+
+    bench.running = true;
+    start = now(CLOCK_MONOTONIC);
+
+    for (index = 0; index < options.num_surfaces; ++index)
+        surface_commit(&bench.surfaces[index]);
+
+    while (bench.running)
+    {
+        wl_display_dispatch_pending(bench.display);
+
+        if (wl_display_flush(bench.display) == -1 && errno != EAGAIN)
+            die("Could not flush display: %s", strerror(errno));
+
+        if (poll(fds, ARRAY_SIZE(fds), -1) == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            die("poll failed: %s", strerror(errno));
+        }
+
+        if (fds[0].revents & POLLIN && wl_display_dispatch(bench.display) == -1)
+            die("Lost connection to the compositor");
+
+        if (fds[1].revents & POLLIN)
+            bench.running = false;
+
+        if (fds[2].revents & POLLIN)
+        {
+            if (read(fds[2].fd, &expirations, sizeof expirations) > 0)
+                bench.skipped += expirations - 1;
+
+            for (index = 0; index < options.num_surfaces; ++index)
+                surface_commit(&bench.surfaces[index]);
+        }
+    }
+
+    end = now(CLOCK_MONOTONIC);
+
+    /* Collect the feedback for frames that are still in flight. */
+    wl_display_roundtrip(bench.display);
+
+    if (options.compositor > 0)
+        compositor_timing = signal_compositor(SIGUSR1);
+
+    print_results((end - start) / 1e9, compositor_timing);
+    free(compositor_timing);
+
+    return EXIT_SUCCESS;
+}
+
@@ -0,0 +1,243 @@
+/* swc: bench/swc-damage-bench-stubs.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Stand-ins for the parts of libswc and wld that the objects linked into
+ * swc-damage-bench depend on, but that the benchmark never exercises. */
+
+#include "libswc/dmabuf.h"
+#include "libswc/drm.h"
+#include "libswc/framebuffer_plane.h"
+#include "libswc/internal.h"
+#include "libswc/launch.h"
+#include "libswc/overlay_plane.h"
+#include "libswc/pointer.h"
+#include "libswc/presentation.h"
+#include "libswc/region.h"
+#include "libswc/shm.h"
+#include "libswc/subsurface.h"
+#include "libswc/surface.h"
+#include "libswc/swc.h"
+#include "libswc/upload.h"
+#include "libswc/wayland_buffer.h"
+
+#include <wld/wld.h>
+
+extern const struct swc_compositor swc_compositor;
+
+static struct swc_launch launch;
+static struct swc_drm drm;
+static struct swc_shm shm;
+
+struct swc swc = {
+    .launch = &launch,
+    .compositor = &swc_compositor,
+    .shm = &shm,
+    .drm = &drm,
+};
+
+void swc_add_binding(enum swc_binding_type type,
+                     uint32_t modifiers, uint32_t value,
+                     swc_binding_handler_t handler, void * data)
+{
+}
+
+bool swc_launch_activate_vt(unsigned vt)
+{
+    return false;
+}
+
+bool swc_overlay_plane_supports_format(struct swc_overlay_plane * plane,
+                                       uint32_t format, uint64_t modifier)
+{
+    return false;
+}
+
+bool swc_framebuffer_plane_supports_format
+    (struct swc_framebuffer_plane * plane, uint32_t format, uint64_t modifier)
+{
+    return false;
+}
+
+uint64_t swc_dmabuf_get_modifier(struct wld_buffer * buffer)
+{
+    return 0;
+}
+
+void swc_pointer_set_focus(struct swc_pointer * pointer,
+                           struct swc_surface * surface)
+{
+}
+
+void swc_presentation_present(struct wl_list * feedbacks,
+                              const struct swc_frame * frame)
+{
+}
+
+void swc_presentation_discard(struct wl_list * feedbacks)
+{
+}
+
+struct swc_region * swc_region_new(struct wl_client * client, uint32_t id)
+{
+    return NULL;
+}
+
+struct swc_surface * swc_surface_new(struct wl_client * client,
+                                     uint32_t version, uint32_t id)
+{
+    return NULL;
+}
+
+void swc_surface_set_view(struct swc_surface * surface, struct swc_view * view)
+{
+    surface->view = view;
+}
+
+void swc_subsurface_update_position(struct swc_subsurface * subsurface)
+{
+}
+
+struct swc_surface * swc_subsurface_get_root(struct swc_surface * surface)
+{
+    return surface;
+}
+
+void swc_wayland_buffer_begin_scanout(struct wld_buffer * buffer)
+{
+}
+
+void swc_wayland_buffer_end_scanout(struct wld_buffer * buffer)
+{
+}
+
+bool swc_upload_initialize()
+{
+    return true;
+}
+
+void swc_upload_finalize()
+{
+}
+
+bool swc_upload_queue(struct wld_buffer * dst, struct wld_buffer * src,
+                      pixman_region32_t * region)
+{
+    return false;
+}
+
+bool swc_upload_convert(struct wld_buffer * dst,
+                        const struct swc_convert_source * source,
+                        pixman_region32_t * region)
+{
+    return false;
+}
+
+void swc_upload_wait()
+{
+}
+
+/* The renderer reads client buffers directly, so no proxies are created, and
+ * nothing is ever drawn. */
+static struct wld_buffer target_buffer;
+
+void wld_buffer_reference(struct wld_buffer * buffer)
+{
+}
+
+void wld_buffer_unreference(struct wld_buffer * buffer)
+{
+}
+
+uint32_t wld_capabilities(struct wld_renderer * renderer,
+                          struct wld_buffer * buffer)
+{
+    return WLD_CAPABILITY_READ | WLD_CAPABILITY_WRITE;
+}
+
+bool wld_export(struct wld_buffer * buffer, uint32_t type,
+                union wld_object * object)
+{
+    return false;
+}
+
+struct wld_buffer * wld_create_buffer(struct wld_context * context,
+                                      uint32_t width, uint32_t height,
+                                      uint32_t format, uint32_t flags)
+{
+    return NULL;
+}
+
+struct wld_surface * wld_create_surface(struct wld_context * context,
+                                        uint32_t width, uint32_t height,
+                                        uint32_t format, uint32_t flags)
+{
+    /* Only ever passed back to the stubs below. */
+    return (struct wld_surface *) &target_buffer;
+}
+
+void wld_destroy_surface(struct wld_surface * surface)
+{
+}
+
+struct wld_buffer * wld_surface_take(struct wld_surface * surface)
+{
+    return &target_buffer;
+}
+
+void wld_surface_release(struct wld_surface * surface,
+                         struct wld_buffer * buffer)
+{
+}
+
+pixman_region32_t * wld_surface_damage(struct wld_surface * surface,
+                                       pixman_region32_t * new_damage)
+{
+    return &target_buffer.damage;
+}
+
+bool wld_set_target_buffer(struct wld_renderer * renderer,
+                           struct wld_buffer * buffer)
+{
+    return true;
+}
+
+bool wld_set_target_surface(struct wld_renderer * renderer,
+                            struct wld_surface * surface)
+{
+    return true;
+}
+
+void wld_copy_region(struct wld_renderer * renderer,
+                     struct wld_buffer * buffer,
+                     int32_t dst_x, int32_t dst_y, pixman_region32_t * region)
+{
+}
+
+void wld_fill_region(struct wld_renderer * renderer, uint32_t color,
+                     pixman_region32_t * region)
+{
+}
+
+void wld_flush(struct wld_renderer * renderer)
+{
+}
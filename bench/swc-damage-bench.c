@@ -0,0 +1,600 @@
+/* swc: bench/swc-damage-bench.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Measures the region arithmetic of the compositor on synthetic stacks of
+ * views, without a display device or renderer.
+ *
+ * This program is linked against the compositor, view, grid and timing
+ * objects of libswc, and drives them through the hooks in compositor.h.
+ * Everything else they depend on, including wld, is replaced by the stubs in
+ * swc-damage-bench-stubs.c, so only the time spent deciding what to draw is
+ * measured, not the drawing itself. */
+
+#include "libswc/compositor.h"
+#include "libswc/damage.h"
+#include "libswc/internal.h"
+#include "libswc/launch.h"
+#include "libswc/pointer.h"
+#include "libswc/screen.h"
+#include "libswc/surface.h"
+#include "libswc/util.h"
+#include "libswc/view.h"
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/param.h>
+#include <wayland-server.h>
+#include <wld/wld.h>
+
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof(array[0]))
+
+#define SCREEN_WIDTH 1920
+#define SCREEN_HEIGHT 1080
+#define NUM_SCREENS 2
+#define BORDER_WIDTH 1
+
+/* Each handle_motion iteration sweeps the pointer over this many points. */
+#define MOTIONS 64
+
+enum layout
+{
+    /* Opaque views side by side, not overlapping. */
+    LAYOUT_TILED,
+    /* Opaque views of the same size, each offset a little from the one below
+     * it, so that most of each is clipped. */
+    LAYOUT_CASCADE,
+    /* Views of random position and size. A third are opaque, a third have an
+     * opaque region inset from their edges (as with client-side shadows),
+     * and the rest are transparent. */
+    LAYOUT_RANDOM,
+    /* Like random, but none of the views are opaque, so nothing is clipped. */
+    LAYOUT_TRANSPARENT
+};
+
+static const char * layout_names[] = {
+    [LAYOUT_TILED]          = "tiled",
+    [LAYOUT_CASCADE]        = "cascade",
+    [LAYOUT_RANDOM]         = "random",
+    [LAYOUT_TRANSPARENT]    = "transparent"
+};
+
+struct surface
+{
+    struct swc_surface base;
+    struct wld_buffer buffer;
+};
+
+static struct
+{
+    unsigned num_views[8], num_view_counts;
+    unsigned layouts;
+    unsigned iterations;
+} options = {
+    .num_views = { 10, 100, 1000, 5000 },
+    .num_view_counts = 4,
+    .layouts = ~0u,
+    .iterations = 100
+};
+
+static struct
+{
+    struct surface * surfaces;
+    unsigned num_surfaces;
+    struct screen screens[NUM_SCREENS];
+    uint64_t * samples;
+    uint32_t random;
+    bool first_result;
+} bench;
+
+static void __attribute__((noreturn,format(printf,1,2)))
+    die(const char * format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+
+    exit(EXIT_FAILURE);
+}
+
+static void __attribute__((noreturn)) usage(const char * name)
+{
+    fprintf(stderr, "Usage: %s [-h] [-n views[,views...]] "
+                    "[-l tiled|cascade|random|transparent] "
+                    "[-i iterations]\n", name);
+    exit(EXIT_FAILURE);
+}
+
+/* xorshift32, so that every run uses the same layouts. */
+static uint32_t random_next()
+{
+    bench.random ^= bench.random << 13;
+    bench.random ^= bench.random >> 17;
+    bench.random ^= bench.random << 5;
+
+    return bench.random;
+}
+
+static int32_t random_range(int32_t min, int32_t max)
+{
+    return min + random_next() % (max - min + 1);
+}
+
+/* Setup {{{ */
+
+/* Nothing is ever shown on the screens' framebuffer planes. */
+
+static bool framebuffer_update(struct swc_view * view)
+{
+    return true;
+}
+
+static bool framebuffer_attach(struct swc_view * view,
+                               struct wld_buffer * buffer)
+{
+    return true;
+}
+
+static bool framebuffer_move(struct swc_view * view, int32_t x, int32_t y)
+{
+    return false;
+}
+
+static const struct swc_view_impl framebuffer_impl = {
+    .update = &framebuffer_update,
+    .attach = &framebuffer_attach,
+    .move = &framebuffer_move
+};
+
+static void screens_setup()
+{
+    struct screen * screen;
+    unsigned index;
+
+    for (index = 0; index < NUM_SCREENS; ++index)
+    {
+        screen = &bench.screens[index];
+        screen->id = index;
+        screen->base.geometry.x = index * SCREEN_WIDTH;
+        screen->base.geometry.y = 0;
+        screen->base.geometry.width = SCREEN_WIDTH;
+        screen->base.geometry.height = SCREEN_HEIGHT;
+        screen->base.usable_geometry = screen->base.geometry;
+        wl_signal_init(&screen->base.event_signal);
+        screen->planes.framebuffer.mode.width = SCREEN_WIDTH;
+        screen->planes.framebuffer.mode.height = SCREEN_HEIGHT;
+        screen->planes.framebuffer.mode.refresh = 60000;
+        swc_view_initialize(&screen->planes.framebuffer.view,
+                            &framebuffer_impl);
+        screen->planes.framebuffer.view.geometry = screen->base.geometry;
+        wl_list_init(&screen->planes.overlays);
+        wl_list_init(&screen->outputs);
+        wl_list_init(&screen->modifiers);
+        wl_list_insert(swc.screens.prev, &screen->link);
+    }
+}
+
+static void place_view(enum layout layout, unsigned index, unsigned num_views,
+                       struct swc_rectangle * geometry,
+                       pixman_region32_t * opaque)
+{
+    const uint32_t width = NUM_SCREENS * SCREEN_WIDTH, height = SCREEN_HEIGHT;
+    unsigned columns, rows;
+    int32_t inset;
+
+    switch (layout)
+    {
+        case LAYOUT_TILED:
+            for (columns = 1; columns * columns < num_views; ++columns);
+            rows = (num_views + columns - 1) / columns;
+            geometry->width = width / columns;
+            geometry->height = height / rows;
+            geometry->x = index % columns * geometry->width;
+            geometry->y = index / columns * geometry->height;
+            break;
+        case LAYOUT_CASCADE:
+            geometry->width = 640;
+            geometry->height = 480;
+            geometry->x = index * 8 % (width - geometry->width);
+            geometry->y = index * 8 % (height - geometry->height);
+            break;
+        case LAYOUT_RANDOM:
+        case LAYOUT_TRANSPARENT:
+            geometry->width = random_range(64, 800);
+            geometry->height = random_range(64, 600);
+            geometry->x = random_range(0, width - geometry->width);
+            geometry->y = random_range(0, height - geometry->height);
+            break;
+    }
+
+    /* Keep every view big enough to have an inset opaque region. */
+    geometry->width = MAX(geometry->width, 32);
+    geometry->height = MAX(geometry->height, 32);
+
+    switch (layout)
+    {
+        case LAYOUT_TILED:
+        case LAYOUT_CASCADE:
+            pixman_region32_init_rect(opaque, 0, 0,
+                                      geometry->width, geometry->height);
+            break;
+        case LAYOUT_RANDOM:
+            inset = index % 3 == 1 ? 8 : 0;
+
+            if (index % 3 == 2)
+                pixman_region32_init(opaque);
+            else
+            {
+                pixman_region32_init_rect(opaque, inset, inset,
+                                          geometry->width - 2 * inset,
+                                          geometry->height - 2 * inset);
+            }
+            break;
+        case LAYOUT_TRANSPARENT:
+            pixman_region32_init(opaque);
+            break;
+    }
+}
+
+static void views_setup(enum layout layout, unsigned num_views)
+{
+    struct surface * surface;
+    struct swc_rectangle geometry;
+    unsigned index;
+
+    if (!(bench.surfaces = calloc(num_views, sizeof *bench.surfaces)))
+        die("Could not allocate surfaces");
+
+    bench.num_surfaces = num_views;
+    bench.random = 0x9e3779b9;
+
+    for (index = 0; index < num_views; ++index)
+    {
+        surface = &bench.surfaces[index];
+        place_view(layout, index, num_views, &geometry,
+                   &surface->base.state.opaque);
+        pixman_region32_init(&surface->base.state.damage);
+        pixman_region32_init_rect(&surface->base.state.input, 0, 0,
+                                  geometry.width, geometry.height);
+        wl_list_init(&surface->base.state.frame_callbacks);
+        wl_list_init(&surface->base.state.feedbacks);
+        surface->base.subsurface = NULL;
+        wl_list_init(&surface->base.stack.current);
+        wl_list_insert(&surface->base.stack.current, &surface->base.stack.link);
+
+        surface->buffer.width = geometry.width;
+        surface->buffer.height = geometry.height;
+        surface->buffer.pitch = geometry.width * 4;
+        surface->buffer.format = WLD_FORMAT_ARGB8888;
+        surface->base.state.buffer = &surface->buffer;
+
+        if (!swc_compositor_add_surface(&surface->base))
+            die("Could not add surface");
+
+        swc_view_attach(surface->base.view, &surface->buffer);
+        swc_view_move(surface->base.view, geometry.x, geometry.y);
+        swc_compositor_surface_set_border_width(&surface->base, BORDER_WIDTH);
+        swc_compositor_surface_set_border_color(&surface->base, 0xff808080);
+        swc_compositor_surface_show(&surface->base);
+    }
+
+    /* Settle the clip regions, and start with no damage. */
+    swc_compositor_calculate_damage();
+    swc_compositor_reset_damage();
+}
+
+static void views_teardown()
+{
+    struct surface * surface;
+    unsigned index;
+
+    for (index = 0; index < bench.num_surfaces; ++index)
+    {
+        surface = &bench.surfaces[index];
+        swc_compositor_remove_surface(&surface->base);
+        pixman_region32_fini(&surface->base.state.damage);
+        pixman_region32_fini(&surface->base.state.opaque);
+        pixman_region32_fini(&surface->base.state.input);
+    }
+
+    free(bench.surfaces);
+    bench.surfaces = NULL;
+    bench.num_surfaces = 0;
+}
+
+/* }}} */
+
+/* Benchmarks {{{ */
+
+static struct
+{
+    /* The whole of each screen, in global coordinates. */
+    pixman_region32_t damage[NUM_SCREENS];
+    pixman_region32_t base_damage;
+    struct swc_pointer pointer;
+} state;
+
+static void damage_surfaces()
+{
+    struct surface * surface;
+    unsigned index;
+
+    swc_compositor_reset_damage();
+
+    for (index = 0; index < bench.num_surfaces; ++index)
+    {
+        surface = &bench.surfaces[index];
+        pixman_region32_union_rect(&surface->base.state.damage,
+                                   &surface->base.state.damage, 0, 0,
+                                   surface->buffer.width,
+                                   surface->buffer.height);
+    }
+}
+
+static unsigned run_calculate_damage(unsigned iteration)
+{
+    swc_compositor_calculate_damage();
+
+    return 1;
+}
+
+static unsigned run_repaint(unsigned iteration)
+{
+    struct screen * screen;
+
+    wl_list_for_each(screen, &swc.screens, link)
+    {
+        swc_compositor_repaint(screen, &state.damage[screen->id],
+                               &state.base_damage);
+    }
+
+    return NUM_SCREENS;
+}
+
+static unsigned run_handle_motion(unsigned iteration)
+{
+    unsigned index;
+
+    for (index = 0; index < MOTIONS; ++index)
+    {
+        state.pointer.x = wl_fixed_from_int
+            (random_next() % (NUM_SCREENS * SCREEN_WIDTH));
+        state.pointer.y = wl_fixed_from_int(random_next() % SCREEN_HEIGHT);
+        swc.compositor->pointer_handler->motion(&state.pointer, 0);
+    }
+
+    return MOTIONS;
+}
+
+static unsigned run_update_screens(unsigned iteration)
+{
+    unsigned index;
+
+    for (index = 0; index < bench.num_surfaces; ++index)
+        swc_view_update_screens(bench.surfaces[index].base.view);
+
+    return bench.num_surfaces;
+}
+
+static const struct benchmark
+{
+    const char * name;
+
+    /* Called before each iteration, outside of the measured time. */
+    void (* prepare)();
+
+    /* Runs one iteration, and returns the number of operations it performed,
+     * which the time is divided among. */
+    unsigned (* run)(unsigned iteration);
+} benchmarks[] = {
+    { "calculate_damage", &damage_surfaces, &run_calculate_damage },
+    { "repaint", NULL, &run_repaint },
+    { "handle_motion", NULL, &run_handle_motion },
+    { "update_screens", NULL, &run_update_screens }
+};
+
+static int compare_samples(const void * a, const void * b)
+{
+    uint64_t sample_a = *(const uint64_t *) a, sample_b = *(const uint64_t *) b;
+
+    return sample_a < sample_b ? -1 : sample_a > sample_b;
+}
+
+static void run_benchmark(const struct benchmark * benchmark,
+                          enum layout layout, unsigned num_views)
+{
+    uint64_t start, total = 0;
+    unsigned iteration, operations;
+
+#if ENABLE_DEBUG
+    swc_compositor_take_allocations();
+#endif
+
+    for (iteration = 0; iteration < options.iterations; ++iteration)
+    {
+        if (benchmark->prepare)
+            benchmark->prepare();
+
+        start = swc_time_nsec();
+        operations = benchmark->run(iteration);
+        bench.samples[iteration] = (swc_time_nsec() - start) / operations;
+        total += bench.samples[iteration];
+    }
+
+    qsort(bench.samples, options.iterations, sizeof *bench.samples,
+          &compare_samples);
+
+    printf("%s  {\n"
+           "    \"benchmark\": \"%s\",\n"
+           "    \"layout\": \"%s\",\n"
+           "    \"views\": %u,\n"
+           "    \"clip_rects\": %u,\n"
+           "    \"iterations\": %u,\n"
+           "    \"min_ns\": %" PRIu64 ",\n"
+           "    \"median_ns\": %" PRIu64 ",\n"
+           "    \"mean_ns\": %" PRIu64,
+           bench.first_result ? "" : ",\n", benchmark->name,
+           layout_names[layout], num_views, swc_compositor_count_clip_rects(),
+           options.iterations, bench.samples[0],
+           bench.samples[options.iterations / 2], total / options.iterations);
+#if ENABLE_DEBUG
+    /* Region allocations are only counted in debug builds. */
+    printf(",\n    \"allocations\": %" PRIu32,
+           swc_compositor_take_allocations());
+#endif
+    printf("\n  }");
+    bench.first_result = false;
+}
+
+/* }}} */
+
+static void parse_options(int argc, char * argv[])
+{
+    int option;
+    char * token, * end;
+
+    while ((option = getopt(argc, argv, "hn:l:i:")) != -1)
+    {
+        switch (option)
+        {
+            case 'n':
+                options.num_view_counts = 0;
+                for (token = strtok(optarg, ","); token;
+                     token = strtok(NULL, ","))
+                {
+                    if (options.num_view_counts == ARRAY_SIZE(options.num_views))
+                        usage(argv[0]);
+
+                    options.num_views[options.num_view_counts]
+                        = strtoul(token, &end, 10);
+
+                    if (*end || options.num_views[options.num_view_counts] == 0)
+                        usage(argv[0]);
+
+                    ++options.num_view_counts;
+                }
+
+                if (options.num_view_counts == 0)
+                    usage(argv[0]);
+                break;
+            case 'l':
+            {
+                unsigned layout;
+
+                for (layout = 0; layout < ARRAY_SIZE(layout_names); ++layout)
+                {
+                    if (strcmp(optarg, layout_names[layout]) == 0)
+                        break;
+                }
+
+                if (layout == ARRAY_SIZE(layout_names))
+                    usage(argv[0]);
+
+                options.layouts = 1 << layout;
+                break;
+            }
+            case 'i':
+                options.iterations = strtoul(optarg, &end, 10);
+                if (*end || options.iterations == 0)
+                    usage(argv[0]);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (optind != argc)
+        usage(argv[0]);
+}
+
+int main(int argc, char * argv[])
+{
+    unsigned layout, count, index;
+
+    parse_options(argc, argv);
+
+    if (!(swc.display = wl_display_create()))
+        die("Could not create Wayland display");
+
+    swc.event_loop = wl_display_get_event_loop(swc.display);
+    swc.headless = true;
+    wl_signal_init(&swc.launch->event_signal);
+    wl_list_init(&swc.screens);
+    screens_setup();
+
+    swc_damage_initialize();
+
+    if (!swc_compositor_initialize())
+        die("Could not initialize compositor");
+
+    if (!(bench.samples = malloc(options.iterations * sizeof *bench.samples)))
+        die("Could not allocate samples");
+
+    for (index = 0; index < NUM_SCREENS; ++index)
+    {
+        pixman_region32_init_rect(&state.damage[index],
+                                  bench.screens[index].base.geometry.x,
+                                  bench.screens[index].base.geometry.y,
+                                  SCREEN_WIDTH, SCREEN_HEIGHT);
+    }
+
+    pixman_region32_init(&state.base_damage);
+    bench.first_result = true;
+    printf("[\n");
+
+    for (layout = 0; layout < ARRAY_SIZE(layout_names); ++layout)
+    {
+        if (!(options.layouts & 1 << layout))
+            continue;
+
+        for (count = 0; count < options.num_view_counts; ++count)
+        {
+            views_setup(layout, options.num_views[count]);
+
+            for (index = 0; index < ARRAY_SIZE(benchmarks); ++index)
+                run_benchmark(&benchmarks[index], layout,
+                              options.num_views[count]);
+
+            views_teardown();
+        }
+    }
+
+    printf("\n]\n");
+
+    for (index = 0; index < NUM_SCREENS; ++index)
+        pixman_region32_fini(&state.damage[index]);
+    pixman_region32_fini(&state.base_damage);
+    free(bench.samples);
+    swc_compositor_finalize();
+    wl_display_destroy(swc.display);
+
+    return EXIT_SUCCESS;
+}
+
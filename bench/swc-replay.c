@@ -0,0 +1,1042 @@
+/* swc: bench/swc-replay.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Replays a recording made with SWC_RECORD against a running compositor,
+ * usually swc started with SWC_HEADLESS.
+ *
+ * Each recorded client gets its own connection, and its requests are sent
+ * again with the objects they refer to mapped to the replay's own. Buffer
+ * contents are restored from the recording if it has them, or otherwise
+ * filled with a pattern derived from their hash, so that unchanged contents
+ * stay unchanged. */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <wayland-client.h>
+
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof(array[0]))
+#define MAX_ARGUMENTS 20
+
+/* Recorded object IDs above this are not mapped. Client-allocated IDs start
+ * at 1 and are reused, so they stay small. */
+#define MAX_OBJECT_ID (1 << 20)
+
+/* At maximum speed, requests recorded this close together are sent in one
+ * batch, as the client that made them most likely did. */
+#define BATCH_INTERVAL 100000
+
+struct pool
+{
+    int fd;
+    void * data;
+    size_t size;
+    unsigned references;
+};
+
+struct object
+{
+    struct wl_proxy * proxy;
+    const struct wl_interface * interface;
+
+    /* The memory backing a wl_shm_pool or wl_buffer. */
+    struct pool * pool;
+    int32_t offset;
+};
+
+struct global
+{
+    uint32_t name, version;
+    char * interface;
+};
+
+struct client
+{
+    unsigned id;
+    struct wl_display * display;
+    struct object * objects;
+    uint32_t num_objects;
+    struct global * globals;
+    unsigned num_globals;
+    bool dirty;
+    struct client * next;
+};
+
+/* The interfaces that can be replayed. Requests to objects of any other
+ * interface are not in recordings, and binds to them are skipped. */
+static const struct wl_interface * interfaces[] = {
+    &wl_display_interface, &wl_registry_interface, &wl_callback_interface,
+    &wl_compositor_interface, &wl_region_interface, &wl_surface_interface,
+    &wl_shm_interface, &wl_shm_pool_interface, &wl_buffer_interface,
+    &wl_shell_interface, &wl_shell_surface_interface, &wl_seat_interface,
+    &wl_output_interface, &wl_subcompositor_interface, &wl_subsurface_interface
+};
+
+static struct
+{
+    bool fast;
+} options;
+
+static struct
+{
+    struct client * clients;
+    unsigned num_clients;
+    uint64_t start, requests, skipped, line;
+} replay;
+
+static void __attribute__((noreturn,format(printf,1,2)))
+    die(const char * format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+
+    exit(EXIT_FAILURE);
+}
+
+static void __attribute__((format(printf,1,2))) skip(const char * format, ...)
+{
+    va_list args;
+
+    fprintf(stderr, "line %" PRIu64 ": ", replay.line);
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+
+    ++replay.skipped;
+}
+
+static void __attribute__((noreturn)) usage(const char * name)
+{
+    fprintf(stderr, "Usage: %s [-h] [-s] [recording]\n", name);
+    exit(EXIT_FAILURE);
+}
+
+static uint64_t now()
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t) time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+/* Pools {{{ */
+
+static struct pool * pool_new(int32_t size)
+{
+    struct pool * pool;
+
+    if (size <= 0 || !(pool = malloc(sizeof *pool)))
+        goto error0;
+
+    if ((pool->fd = memfd_create("swc-replay", MFD_CLOEXEC)) == -1)
+        goto error1;
+
+    if (ftruncate(pool->fd, size) == -1)
+        goto error2;
+
+    pool->data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      pool->fd, 0);
+
+    if (pool->data == MAP_FAILED)
+        goto error2;
+
+    pool->size = size;
+    pool->references = 1;
+
+    return pool;
+
+  error2:
+    close(pool->fd);
+  error1:
+    free(pool);
+  error0:
+    return NULL;
+}
+
+static bool pool_resize(struct pool * pool, int32_t size)
+{
+    void * data;
+
+    if (size <= 0 || ftruncate(pool->fd, size) == -1)
+        return false;
+
+    data = mremap(pool->data, pool->size, size, MREMAP_MAYMOVE);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    pool->data = data;
+    pool->size = size;
+
+    return true;
+}
+
+static void pool_unreference(struct pool * pool)
+{
+    if (!pool || --pool->references > 0)
+        return;
+
+    munmap(pool->data, pool->size);
+    close(pool->fd);
+    free(pool);
+}
+
+/* }}} */
+
+/* Clients and objects {{{ */
+
+static struct object * object_get(struct client * client, uint32_t id)
+{
+    if (id >= client->num_objects || !client->objects[id].proxy)
+        return NULL;
+
+    return &client->objects[id];
+}
+
+static void object_destroy(struct client * client, uint32_t id)
+{
+    struct object * object = object_get(client, id);
+
+    if (!object)
+        return;
+
+    /* The wl_display is owned by the connection. */
+    if (object->interface != &wl_display_interface)
+        wl_proxy_destroy(object->proxy);
+
+    pool_unreference(object->pool);
+    memset(object, 0, sizeof *object);
+}
+
+static struct object * object_set(struct client * client, uint32_t id,
+                                  struct wl_proxy * proxy,
+                                  const struct wl_interface * interface)
+{
+    struct object * objects;
+    uint32_t size;
+
+    if (id == 0 || id >= MAX_OBJECT_ID)
+    {
+        skip("Object ID %" PRIu32 " is out of range", id);
+        wl_proxy_destroy(proxy);
+        return NULL;
+    }
+
+    if (id >= client->num_objects)
+    {
+        size = client->num_objects ? client->num_objects : 64;
+        while (size <= id)
+            size *= 2;
+
+        if (!(objects = realloc(client->objects, size * sizeof *objects)))
+            die("Could not allocate objects");
+
+        memset(objects + client->num_objects, 0,
+               (size - client->num_objects) * sizeof *objects);
+        client->objects = objects;
+        client->num_objects = size;
+    }
+
+    /* The recorded client has reused the ID of an object that the server
+     * destroyed, such as a wl_callback. */
+    object_destroy(client, id);
+
+    client->objects[id].proxy = proxy;
+    client->objects[id].interface = interface;
+
+    return &client->objects[id];
+}
+
+static struct client * client_get(unsigned id, bool create)
+{
+    struct client * client;
+
+    for (client = replay.clients; client; client = client->next)
+    {
+        if (client->id == id)
+            return client;
+    }
+
+    if (!create)
+        return NULL;
+
+    if (!(client = calloc(1, sizeof *client)))
+        die("Could not allocate client");
+
+    if (!(client->display = wl_display_connect(NULL)))
+        die("Could not connect to Wayland display");
+
+    client->id = id;
+    object_set(client, 1, (struct wl_proxy *) client->display,
+               &wl_display_interface);
+    client->next = replay.clients;
+    replay.clients = client;
+    ++replay.num_clients;
+
+    return client;
+}
+
+static void client_destroy(struct client * client)
+{
+    struct client ** link;
+    uint32_t id;
+    unsigned index;
+
+    for (link = &replay.clients; *link != client; link = &(*link)->next);
+    *link = client->next;
+
+    wl_display_roundtrip(client->display);
+
+    for (id = 0; id < client->num_objects; ++id)
+        object_destroy(client, id);
+
+    for (index = 0; index < client->num_globals; ++index)
+        free(client->globals[index].interface);
+
+    wl_display_disconnect(client->display);
+    free(client->objects);
+    free(client->globals);
+    free(client);
+}
+
+static void handle_global(void * data, struct wl_registry * registry,
+                          uint32_t name, const char * interface,
+                          uint32_t version)
+{
+    struct client * client = data;
+    struct global * globals;
+
+    globals = realloc(client->globals,
+                      (client->num_globals + 1) * sizeof *globals);
+
+    if (!globals)
+        die("Could not allocate globals");
+
+    client->globals = globals;
+    globals[client->num_globals].name = name;
+    globals[client->num_globals].version = version;
+    globals[client->num_globals].interface = strdup(interface);
+    ++client->num_globals;
+}
+
+static void handle_global_remove(void * data, struct wl_registry * registry,
+                                 uint32_t name)
+{
+}
+
+static const struct wl_registry_listener registry_listener = {
+    .global = &handle_global,
+    .global_remove = &handle_global_remove
+};
+
+static struct global * find_global(struct client * client,
+                                   const char * interface)
+{
+    unsigned index;
+
+    for (index = 0; index < client->num_globals; ++index)
+    {
+        if (strcmp(client->globals[index].interface, interface) == 0)
+            return &client->globals[index];
+    }
+
+    return NULL;
+}
+
+static const struct wl_interface * find_interface(const char * name)
+{
+    unsigned index;
+
+    for (index = 0; index < ARRAY_SIZE(interfaces); ++index)
+    {
+        if (strcmp(interfaces[index]->name, name) == 0)
+            return interfaces[index];
+    }
+
+    return NULL;
+}
+
+/* }}} */
+
+/* Event handling {{{ */
+
+static void flush(struct client * client)
+{
+    struct pollfd fd = {
+        .fd = wl_display_get_fd(client->display),
+        .events = POLLOUT
+    };
+
+    while (wl_display_flush(client->display) == -1)
+    {
+        if (errno != EAGAIN)
+            die("Lost connection to the compositor");
+
+        /* The compositor is behind; wait until it catches up. */
+        if (poll(&fd, 1, -1) == -1 && errno != EINTR)
+            die("Could not poll display: %s", strerror(errno));
+    }
+
+    client->dirty = false;
+}
+
+/* Dispatches events for all clients until the given time. Events are only
+ * read to keep the connections flowing; none of them affect the replay,
+ * other than the globals announced to registries. */
+static void dispatch_until(uint64_t time)
+{
+    struct pollfd * fds;
+    struct client * client;
+    struct timespec timeout;
+    uint64_t current;
+    unsigned index;
+
+    if (!(fds = calloc(replay.num_clients, sizeof *fds)))
+        die("Could not allocate poll descriptors");
+
+    for (;;)
+    {
+        index = 0;
+        for (client = replay.clients; client; client = client->next, ++index)
+        {
+            if (client->dirty)
+                flush(client);
+            wl_display_dispatch_pending(client->display);
+            fds[index].fd = wl_display_get_fd(client->display);
+            fds[index].events = POLLIN;
+        }
+
+        current = now();
+        if (current >= time)
+            timeout.tv_sec = timeout.tv_nsec = 0;
+        else
+        {
+            timeout.tv_sec = (time - current) / 1000000000;
+            timeout.tv_nsec = (time - current) % 1000000000;
+        }
+
+        if (ppoll(fds, index, &timeout, NULL) == -1 && errno != EINTR)
+            die("Could not poll displays: %s", strerror(errno));
+
+        index = 0;
+        for (client = replay.clients; client; client = client->next, ++index)
+        {
+            if (fds[index].revents & (POLLIN | POLLHUP | POLLERR)
+                && wl_display_dispatch(client->display) == -1)
+            {
+                die("Lost connection to the compositor");
+            }
+        }
+
+        if (current >= time)
+            break;
+    }
+
+    free(fds);
+}
+
+/* }}} */
+
+/* Parsing {{{ */
+
+/* Splits off the next space-separated token, decoding it in place if it is a
+ * quoted string. */
+static char * next_token(char ** cursor, bool * quoted)
+{
+    char * token, * in, * out;
+
+    while (**cursor == ' ')
+        ++*cursor;
+
+    if (**cursor == '\0' || **cursor == '\n')
+        return NULL;
+
+    if (quoted)
+        *quoted = **cursor == '"';
+
+    if (**cursor != '"')
+    {
+        token = *cursor;
+        *cursor += strcspn(*cursor, " \n");
+        if (**cursor)
+            *(*cursor)++ = '\0';
+        return token;
+    }
+
+    token = out = in = *cursor + 1;
+
+    while (*in && *in != '"')
+    {
+        if (*in == '\\' && in[1] == 'x' && in[2] && in[3])
+        {
+            char digits[3] = { in[2], in[3] };
+
+            *out++ = strtoul(digits, NULL, 16);
+            in += 4;
+        }
+        else if (*in == '\\' && in[1])
+        {
+            *out++ = in[1];
+            in += 2;
+        }
+        else
+            *out++ = *in++;
+    }
+
+    *cursor = *in ? in + 1 : in;
+    *out = '\0';
+
+    return token;
+}
+
+static bool parse_uint(const char * token, uint32_t * value)
+{
+    char * end;
+
+    if (!token)
+        return false;
+
+    *value = strtoul(token, &end, 10);
+
+    return *end == '\0';
+}
+
+static bool parse_int(const char * token, int32_t * value)
+{
+    char * end;
+
+    if (!token)
+        return false;
+
+    *value = strtol(token, &end, 10);
+
+    return *end == '\0';
+}
+
+static bool parse_array(const char * token, struct wl_array * array)
+{
+    size_t size, index;
+    char digits[3] = { 0 };
+    uint8_t * data;
+
+    wl_array_init(array);
+
+    if (!token)
+        return false;
+
+    if (strcmp(token, "-") == 0)
+        return true;
+
+    size = strlen(token) / 2;
+
+    if (!(data = wl_array_add(array, size)))
+        return false;
+
+    for (index = 0; index < size; ++index)
+    {
+        digits[0] = token[index * 2];
+        digits[1] = token[index * 2 + 1];
+        data[index] = strtoul(digits, NULL, 16);
+    }
+
+    return true;
+}
+
+static int base64_value(char digit)
+{
+    if (digit >= 'A' && digit <= 'Z')
+        return digit - 'A';
+    if (digit >= 'a' && digit <= 'z')
+        return digit - 'a' + 26;
+    if (digit >= '0' && digit <= '9')
+        return digit - '0' + 52;
+    if (digit == '+')
+        return 62;
+    if (digit == '/')
+        return 63;
+    return -1;
+}
+
+static size_t decode_base64(const char * string, uint8_t * data, size_t size)
+{
+    uint32_t bits = 0;
+    unsigned count = 0;
+    size_t length = 0;
+    int value;
+
+    for (; *string && length < size; ++string)
+    {
+        if ((value = base64_value(*string)) == -1)
+            break;
+
+        bits = bits << 6 | value;
+
+        if (++count == 4)
+        {
+            data[length++] = bits >> 16;
+            if (length < size)
+                data[length++] = bits >> 8;
+            if (length < size)
+                data[length++] = bits;
+            bits = count = 0;
+        }
+    }
+
+    /* Trailing partial group, before the padding. */
+    if (count >= 2 && length < size)
+        data[length++] = bits >> (count * 6 - 8);
+    if (count == 3 && length < size)
+        data[length++] = bits;
+
+    return length;
+}
+
+/* }}} */
+
+/* Replay {{{ */
+
+static void replay_contents(struct client * client, char * cursor)
+{
+    struct object * buffer;
+    uint32_t id, width, height, stride, format;
+    uint64_t hash, state;
+    size_t size, index;
+    uint8_t * data;
+    char * token;
+
+    if (!parse_uint(next_token(&cursor, NULL), &id)
+        || !parse_uint(next_token(&cursor, NULL), &width)
+        || !parse_uint(next_token(&cursor, NULL), &height)
+        || !parse_uint(next_token(&cursor, NULL), &stride)
+        || !parse_uint(next_token(&cursor, NULL), &format)
+        || !(token = next_token(&cursor, NULL)))
+    {
+        skip("Malformed buffer contents");
+        return;
+    }
+
+    hash = strtoull(token, NULL, 16);
+
+    if (!(buffer = object_get(client, id)) || !buffer->pool)
+    {
+        skip("Contents for unknown buffer %" PRIu32, id);
+        return;
+    }
+
+    size = (size_t) height * stride;
+
+    /* The chroma plane of NV12 data follows the luma plane. */
+    if (format == WL_SHM_FORMAT_NV12)
+        size += (size_t) (height + 1) / 2 * stride;
+
+    if (buffer->offset < 0 || buffer->offset + size > buffer->pool->size)
+    {
+        skip("Contents of buffer %" PRIu32 " do not fit in its pool", id);
+        return;
+    }
+
+    data = (uint8_t *) buffer->pool->data + buffer->offset;
+
+    if ((token = next_token(&cursor, NULL)))
+    {
+        decode_base64(token, data, size);
+        return;
+    }
+
+    /* xorshift64, seeded with the hash. */
+    state = hash ? hash : 1;
+
+    for (index = 0; index + sizeof state <= size; index += sizeof state)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        memcpy(data + index, &state, sizeof state);
+    }
+}
+
+static void replay_bind(struct client * client, struct wl_proxy * registry,
+                        uint32_t opcode, char * cursor)
+{
+    const struct wl_interface * interface;
+    union wl_argument arguments[4];
+    struct global * global;
+    struct wl_proxy * proxy;
+    uint32_t name, version, id;
+    char * interface_name;
+
+    if (!parse_uint(next_token(&cursor, NULL), &name)
+        || !(interface_name = next_token(&cursor, NULL))
+        || !parse_uint(next_token(&cursor, NULL), &version)
+        || !parse_uint(next_token(&cursor, NULL), &id))
+    {
+        skip("Malformed bind");
+        return;
+    }
+
+    if (!(interface = find_interface(interface_name)))
+    {
+        skip("Not binding unsupported interface %s", interface_name);
+        return;
+    }
+
+    if (!(global = find_global(client, interface_name)))
+    {
+        skip("Compositor has no %s global", interface_name);
+        return;
+    }
+
+    if (version > global->version)
+        version = global->version;
+    if (version > (uint32_t) interface->version)
+        version = interface->version;
+
+    arguments[0].u = global->name;
+    arguments[1].s = interface->name;
+    arguments[2].u = version;
+    arguments[3].n = 0;
+
+    proxy = wl_proxy_marshal_array_constructor_versioned
+        (registry, opcode, arguments, interface, version);
+    object_set(client, id, proxy, interface);
+    ++replay.requests;
+    client->dirty = true;
+}
+
+static void replay_request(struct client * client, char * target,
+                           char * cursor)
+{
+    const struct wl_interface * interface, * new_interface = NULL;
+    const struct wl_message * message;
+    union wl_argument arguments[MAX_ARGUMENTS];
+    struct wl_array arrays[MAX_ARGUMENTS];
+    struct object * object, * argument;
+    struct wl_proxy * proxy;
+    struct pool * pool;
+    const char * signature;
+    unsigned index, num_arrays = 0;
+    uint32_t id, argument_id, new_id = 0;
+    int opcode, fd_index = -1;
+    char * request, * token;
+    bool quoted;
+
+    if (!(request = strchr(target, '@')))
+        goto malformed;
+
+    *request++ = '\0';
+    id = strtoul(request, &request, 10);
+
+    if (*request++ != '.')
+        goto malformed;
+
+    if (!(object = object_get(client, id)))
+    {
+        skip("Request to unknown object %s@%" PRIu32, target, id);
+        return;
+    }
+
+    /* Creating objects can move the object table, so keep what is needed
+     * from the target object. */
+    interface = object->interface;
+    proxy = object->proxy;
+    pool = object->pool;
+
+    if (strcmp(interface->name, target) != 0)
+    {
+        skip("Object %" PRIu32 " is a %s, not a %s",
+             id, interface->name, target);
+        return;
+    }
+
+    for (opcode = 0; opcode < interface->method_count; ++opcode)
+    {
+        if (strcmp(interface->methods[opcode].name, request) == 0)
+            break;
+    }
+
+    if (opcode == interface->method_count)
+    {
+        skip("%s has no request %s", target, request);
+        return;
+    }
+
+    message = &interface->methods[opcode];
+
+    if (interface == &wl_registry_interface && strcmp(request, "bind") == 0)
+    {
+        replay_bind(client, proxy, opcode, cursor);
+        return;
+    }
+
+    index = 0;
+    for (signature = message->signature; *signature; ++signature)
+    {
+        if (index == MAX_ARGUMENTS)
+            goto malformed;
+
+        switch (*signature)
+        {
+            case 'i':
+            case 'f':
+                if (!parse_int(next_token(&cursor, NULL), &arguments[index].i))
+                    goto malformed;
+                break;
+            case 'u':
+                if (!parse_uint(next_token(&cursor, NULL),
+                                &arguments[index].u))
+                {
+                    goto malformed;
+                }
+                break;
+            case 's':
+                if (!(token = next_token(&cursor, &quoted)))
+                    goto malformed;
+                arguments[index].s = quoted ? token : NULL;
+                break;
+            case 'o':
+                if (!parse_uint(next_token(&cursor, NULL), &argument_id))
+                    goto malformed;
+
+                if (argument_id == 0)
+                    arguments[index].o = NULL;
+                else if ((argument = object_get(client, argument_id)))
+                    arguments[index].o = (struct wl_object *) argument->proxy;
+                else
+                {
+                    skip("%s.%s refers to unknown object %" PRIu32,
+                         target, request, argument_id);
+                    goto done;
+                }
+                break;
+            case 'n':
+                if (!parse_uint(next_token(&cursor, NULL), &new_id))
+                    goto malformed;
+                new_interface = message->types[index];
+                arguments[index].n = 0;
+                break;
+            case 'a':
+                if (!parse_array(next_token(&cursor, NULL),
+                                 &arrays[num_arrays]))
+                {
+                    wl_array_release(&arrays[num_arrays]);
+                    goto malformed;
+                }
+                arguments[index].a = &arrays[num_arrays++];
+                break;
+            case 'h':
+                next_token(&cursor, NULL);
+                fd_index = index;
+                break;
+            default:
+                continue;
+        }
+
+        ++index;
+    }
+
+    /* The only request in the replayed interfaces that passes a file
+     * descriptor is wl_shm.create_pool, whose memory is recreated here. */
+    if (fd_index != -1)
+    {
+        if (interface != &wl_shm_interface
+            || !(pool = pool_new(arguments[fd_index + 1].i)))
+        {
+            skip("Could not create pool for %s.%s", target, request);
+            goto done;
+        }
+
+        arguments[fd_index].h = pool->fd;
+    }
+    else if (interface == &wl_shm_pool_interface
+             && strcmp(request, "resize") == 0
+             && !pool_resize(pool, arguments[0].i))
+    {
+        skip("Could not resize pool");
+        goto done;
+    }
+
+    if (new_interface)
+    {
+        proxy = wl_proxy_marshal_array_constructor(proxy, opcode, arguments,
+                                                   new_interface);
+
+        if (!(argument = object_set(client, new_id, proxy, new_interface)))
+        {
+            if (fd_index != -1)
+                pool_unreference(pool);
+            goto done;
+        }
+
+        if (new_interface == &wl_registry_interface)
+        {
+            wl_registry_add_listener((struct wl_registry *) proxy,
+                                     &registry_listener, client);
+            wl_display_roundtrip(client->display);
+        }
+        else if (fd_index != -1)
+            argument->pool = pool;
+        else if (new_interface == &wl_buffer_interface && pool)
+        {
+            argument->pool = pool;
+            argument->offset = arguments[0].i;
+            ++pool->references;
+        }
+    }
+    else
+        wl_proxy_marshal_array(proxy, opcode, arguments);
+
+    if (strcmp(request, "destroy") == 0)
+        object_destroy(client, id);
+
+    ++replay.requests;
+    client->dirty = true;
+
+  done:
+    while (num_arrays > 0)
+        wl_array_release(&arrays[--num_arrays]);
+    return;
+
+  malformed:
+    skip("Malformed request %s", target);
+    goto done;
+}
+
+static void replay_line(char * line, uint64_t * last_time)
+{
+    struct client * client;
+    uint32_t client_id;
+    uint64_t time;
+    char * cursor = line, * token, * target, * end;
+
+    if (!(token = next_token(&cursor, NULL)))
+        return;
+
+    time = strtoull(token, &end, 10);
+
+    if (*end || !parse_uint(next_token(&cursor, NULL), &client_id)
+        || !(target = next_token(&cursor, NULL)))
+    {
+        skip("Malformed line");
+        return;
+    }
+
+    if (options.fast)
+    {
+        if (time > *last_time + BATCH_INTERVAL)
+            dispatch_until(0);
+    }
+    else
+        dispatch_until(replay.start + time);
+
+    *last_time = time;
+
+    if (strcmp(target, "@disconnect") == 0)
+    {
+        if ((client = client_get(client_id, false)))
+            client_destroy(client);
+        return;
+    }
+
+    client = client_get(client_id, true);
+
+    if (strcmp(target, "@content") == 0)
+        replay_contents(client, cursor);
+    else
+        replay_request(client, target, cursor);
+}
+
+/* }}} */
+
+static void parse_options(int argc, char * argv[])
+{
+    int option;
+
+    while ((option = getopt(argc, argv, "hs")) != -1)
+    {
+        switch (option)
+        {
+            case 's':
+                options.fast = true;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    FILE * file = stdin;
+    char * line = NULL;
+    size_t size = 0;
+    uint64_t last_time = 0, elapsed;
+
+    parse_options(argc, argv);
+
+    if (optind < argc - 1)
+        usage(argv[0]);
+
+    if (optind == argc - 1 && !(file = fopen(argv[optind], "r")))
+        die("Could not open %s: %s", argv[optind], strerror(errno));
+
+    signal(SIGPIPE, SIG_IGN);
+    replay.start = now();
+
+    while (getline(&line, &size, file) != -1)
+    {
+        ++replay.line;
+        replay_line(line, &last_time);
+    }
+
+    while (replay.clients)
+        client_destroy(replay.clients);
+
+    elapsed = now() - replay.start;
+
+    printf("{\n"
+           "  \"requests\": %" PRIu64 ",\n"
+           "  \"skipped\": %" PRIu64 ",\n"
+           "  \"recorded_ns\": %" PRIu64 ",\n"
+           "  \"elapsed_ns\": %" PRIu64 "\n"
+           "}\n", replay.requests, replay.skipped, last_time, elapsed);
+
+    free(line);
+    fclose(file);
+
+    return EXIT_SUCCESS;
+}
+
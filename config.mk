@@ -19,4 +19,5 @@ ENABLE_STATIC       = 1
 ENABLE_SHARED       = 1
 ENABLE_HOTPLUGGING  = 1
 ENABLE_XWAYLAND     = 1
+ENABLE_BENCH        = 0
 
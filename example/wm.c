@@ -21,6 +21,7 @@
  * SOFTWARE.
  */
 
+#include <signal.h>
 #include <stdlib.h>
 #include <swc.h>
 #include <unistd.h>
@@ -274,6 +275,32 @@ static void spawn(void * data, uint32_t time, uint32_t value, uint32_t state)
     }
 }
 
+static int reset_frame_timing(int signal_number, void * data)
+{
+    const char * path;
+
+    swc_reset_frame_timing();
+
+    /* Let swc-bench know that the statistics have been reset. */
+    if ((path = getenv("SWC_TIMING_FILE")))
+        swc_write_frame_timing(path);
+
+    return 0;
+}
+
+static int print_frame_timing(int signal_number, void * data)
+{
+    const char * path;
+
+    swc_print_frame_timing();
+
+    /* swc-bench -f reads the statistics from this file. */
+    if ((path = getenv("SWC_TIMING_FILE")))
+        swc_write_frame_timing(path);
+
+    return 0;
+}
+
 int main(int argc, char * argv[])
 {
     struct wl_display * display;
@@ -295,6 +322,12 @@ int main(int argc, char * argv[])
                     &spawn, dmenu_command);
 
     event_loop = wl_display_get_event_loop(display);
+
+    /* Dump the frame timing statistics on SIGUSR1, and write them to
+     * $SWC_TIMING_FILE if it is set. SIGUSR2 resets them. */
+    wl_event_loop_add_signal(event_loop, SIGUSR1, &print_frame_timing, NULL);
+    wl_event_loop_add_signal(event_loop, SIGUSR2, &reset_frame_timing, NULL);
+
     wl_display_run(display);
 
     return EXIT_SUCCESS;
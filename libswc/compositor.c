@@ -29,35 +29,93 @@
 
 #include "swc.h"
 #include "compositor.h"
+#include "damage.h"
 #include "data_device_manager.h"
+#include "dmabuf.h"
 #include "drm.h"
+#include "grid.h"
 #include "internal.h"
 #include "launch.h"
 #include "output.h"
 #include "pointer.h"
+#include "presentation.h"
 #include "region.h"
 #include "screen.h"
 #include "seat.h"
 #include "shm.h"
+#include "subsurface.h"
 #include "surface.h"
+#include "timing.h"
+#include "upload.h"
 #include "util.h"
 #include "view.h"
+#include "wayland_buffer.h"
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
+#include <unistd.h>
+#include <libdrm/drm_fourcc.h>
 #include <wld/wld.h>
 #include <wld/drm.h>
 #include <xkbcommon/xkbcommon-keysyms.h>
+#include "protocol/presentation-time-server-protocol.h"
+
+/**
+ * A region that is reset and accumulated into every frame.
+ *
+ * pixman allocates new storage when the destination of an operation is also
+ * one of its sources, and frees it when a region is cleared. An accumulator
+ * alternates between two regions and resets by marking itself empty, so that
+ * it keeps its storage from frame to frame.
+ */
+struct accumulator
+{
+    pixman_region32_t regions[2];
+    unsigned current;
+    bool empty;
+};
 
 struct target
 {
     struct wld_surface * surface;
     struct wld_buffer * next_buffer, * current_buffer;
+
+    /* A frame rendered while a page flip was still pending, which is attached
+     * once the flip completes. Only used with triple buffering. */
+    struct wld_buffer * queued_buffer;
+
+    /* Whether the next and current buffers are client buffers that are being
+     * scanned out directly, rather than buffers taken from the surface. */
+    bool next_is_scanout, current_is_scanout;
+
+    struct screen * screen;
     struct swc_view * view;
     struct wl_listener view_listener;
     uint32_t mask;
 
+    /* Damage accumulated since the last repaint, in global coordinates. */
+    struct accumulator damage;
+
+    /* Whether the screen is scheduled to be repainted when its frame clock
+     * deadline is reached, and whether it has been repainted but is waiting
+     * on a page flip. */
+    bool scheduled, flip_pending;
+
+    /* Frame clock: the time of the last page flip, the refresh interval of
+     * the screen, and how long the last repaint took (in nanoseconds). */
+    uint64_t last_flip, refresh_interval, render_time;
+
+    /* The repaint is started by this timer (or an idle callback if the
+     * deadline has already passed) shortly before the next vblank. */
+    struct wl_event_source * repaint_timer, * repaint_idle;
+    bool repaint_armed;
+
+    /* When the frame waiting for a page flip was submitted, and how long
+     * each phase of the frames on this screen took. */
+    uint64_t flip_submitted;
+    struct swc_timing timing;
+
     struct wl_listener screen_listener;
 };
 
@@ -68,6 +126,13 @@ struct view
     struct swc_surface * surface;
     struct wld_buffer * buffer;
 
+    /* Whether the buffer was imported from the client's SHM buffer rather
+     * than being a proxy that it is copied into. */
+    bool imported;
+
+    /* The overlay plane the view is displayed on, if any. */
+    struct swc_overlay_plane * overlay;
+
     /* Whether or not the view is visible (mapped). */
     bool visible;
 
@@ -78,6 +143,14 @@ struct view
      * surface. */
     pixman_region32_t clip;
 
+    /* Whether the view contributes to the damaged area of the target being
+     * repainted. */
+    bool repaint;
+
+    /* Presentation feedback for the content in the frame waiting to be
+     * displayed, and in the frame queued behind it. */
+    struct wl_list feedbacks, queued_feedbacks;
+
     struct
     {
         uint32_t width;
@@ -85,11 +158,41 @@ struct view
         bool damaged;
     } border;
 
+    /* The entry of the view in the spatial index used for hit-testing. */
+    struct swc_grid_entry grid_entry;
+
     struct wl_list link;
 };
 
+/* The damaged borders with one color, which are filled in one operation. */
+struct border_batch
+{
+    uint32_t color;
+    struct accumulator region;
+};
+
+/* An operation of the renderer, queued while a frame is being composed. */
+struct render_command
+{
+    enum
+    {
+        RENDER_FILL,
+        RENDER_COPY
+    } type;
+
+    uint32_t color;
+    struct wld_buffer * buffer;
+
+    /* The position of the buffer, in global coordinates. */
+    int32_t x, y;
+
+    /* The region to fill or copy to, in global coordinates. */
+    pixman_region32_t region;
+};
+
 static bool handle_motion(struct swc_pointer * pointer, uint32_t time);
-static void perform_update(void * data);
+static void perform_update(struct target * target);
+static void schedule_repaint(struct target * target);
 
 static const struct swc_pointer_handler pointer_handler = {
     .motion = &handle_motion
@@ -98,18 +201,54 @@ static const struct swc_pointer_handler pointer_handler = {
 static struct
 {
     struct wl_list views;
-    pixman_region32_t damage, opaque;
+    struct accumulator opaque;
 
-    /* A mask of screens that have been repainted but are waiting on a page
-     * flip. */
-    uint32_t pending_flips;
-
-    /* A mask of screens that are scheduled to be repainted on the next
-     * idle. */
-    uint32_t scheduled_updates;
+    /* Regions used while calculating damage and repainting, kept between
+     * frames so that their storage is reused. */
+    struct
+    {
+        pixman_region32_t empty, opaque, damage, border, below, base, buffer;
+    } scratch;
+    struct accumulator above;
+
+    /* Border damage grouped by color while repainting (struct border_batch),
+     * kept between frames along with the storage of each region. */
+    struct wl_array borders;
+
+    /* The renderer operations for the frame being composed (struct
+     * render_command). Commands past the number in use keep their regions
+     * initialized, so their storage is reused by later frames. */
+    struct wl_array commands;
+    unsigned num_commands;
+
+#if ENABLE_DEBUG
+    /* The number of times the storage of any of the regions above had to be
+     * (re)allocated during a frame, and in total. Once the frames settle
+     * down, this should stay at zero. */
+    uint32_t frame_allocations;
+    uint64_t allocations;
+#endif
+
+    /* A spatial index of the visible views, and the next stacking order to
+     * assign to a view placed on top. */
+    struct swc_grid grid;
+    uint64_t next_order;
+
+    /* How long before the next vblank a repaint is started, in milliseconds.
+     * Commits arriving before then make it into the next frame. */
+    uint32_t repaint_window;
+
+    /* The number of buffers each screen renders into. With three, a frame can
+     * be rendered while the previous one is still waiting to be flipped. */
+    unsigned render_buffers;
 
     bool active, updating;
 
+    /* Views that are fully occluded or on no screen get their frame events
+     * from this timer instead of from page flips. */
+    struct wl_event_source * throttle_timer;
+    bool throttle_armed;
+
     struct wl_global * global;
 } compositor;
 
@@ -117,6 +256,94 @@ const struct swc_compositor swc_compositor = {
     .pointer_handler = &pointer_handler
 };
 
+/* Regions {{{ */
+
+#if ENABLE_DEBUG
+static inline void track_allocation(pixman_region32_t * region,
+                                    pixman_region32_data_t * data)
+{
+    if (region->data != data && region->data && region->data->size)
+        ++compositor.frame_allocations;
+}
+
+/* Performs an operation on a region, counting any new storage for it. */
+# define TRACK(region, ...)                                                 \
+    do {                                                                    \
+        pixman_region32_data_t * data_ = (region)->data;                    \
+        __VA_ARGS__;                                                        \
+        track_allocation(region, data_);                                    \
+    } while (0)
+#else
+# define TRACK(region, ...) do { __VA_ARGS__; } while (0)
+#endif
+
+static void accumulator_initialize(struct accumulator * accumulator)
+{
+    pixman_region32_init(&accumulator->regions[0]);
+    pixman_region32_init(&accumulator->regions[1]);
+    accumulator->current = 0;
+    accumulator->empty = true;
+}
+
+static void accumulator_finalize(struct accumulator * accumulator)
+{
+    pixman_region32_fini(&accumulator->regions[0]);
+    pixman_region32_fini(&accumulator->regions[1]);
+}
+
+static inline void accumulator_reset(struct accumulator * accumulator)
+{
+    accumulator->empty = true;
+}
+
+static inline pixman_region32_t * accumulator_region
+    (struct accumulator * accumulator)
+{
+    return accumulator->empty ? &compositor.scratch.empty
+                              : &accumulator->regions[accumulator->current];
+}
+
+static void accumulator_add(struct accumulator * accumulator,
+                            pixman_region32_t * region)
+{
+    pixman_region32_t * current = &accumulator->regions[accumulator->current],
+                      * next = &accumulator->regions[!accumulator->current];
+
+    if (accumulator->empty)
+    {
+        TRACK(current, pixman_region32_copy(current, region));
+        accumulator->empty = false;
+    }
+    else
+    {
+        TRACK(next, pixman_region32_union(next, current, region));
+        accumulator->current = !accumulator->current;
+    }
+}
+
+static void accumulator_add_box(struct accumulator * accumulator,
+                                pixman_box32_t * box)
+{
+    pixman_region32_t region;
+
+    /* A single rectangle needs no storage. */
+    pixman_region32_init_with_extents(&region, box);
+    accumulator_add(accumulator, &region);
+    pixman_region32_fini(&region);
+}
+
+/* }}} */
+
+/**
+ * Drops a client buffer that was scanned out directly, once it has left the
+ * screen.
+ */
+static void end_scanout(struct wld_buffer * buffer)
+{
+    swc_wayland_buffer_end_scanout(buffer);
+    wld_buffer_unreference(buffer);
+}
+
 static void handle_screen_event(struct wl_listener * listener, void * data)
 {
     struct swc_event * event = data;
@@ -126,6 +353,19 @@ static void handle_screen_event(struct wl_listener * listener, void * data)
         struct target * target
             = CONTAINER_OF(listener, typeof(*target), screen_listener);
 
+        if (target->current_is_scanout)
+            end_scanout(target->current_buffer);
+        if (target->next_is_scanout
+            && (target->next_buffer != target->current_buffer
+                || target->flip_pending))
+        {
+            end_scanout(target->next_buffer);
+        }
+
+        if (target->repaint_idle)
+            wl_event_source_remove(target->repaint_idle);
+        wl_event_source_remove(target->repaint_timer);
+        accumulator_finalize(&target->damage);
         wld_destroy_surface(target->surface);
         free(target);
     }
@@ -141,6 +381,81 @@ static struct target * target_get(struct screen * screen)
                     : NULL;
 }
 
+static bool target_attach(struct target * target, struct wld_buffer * buffer)
+{
+    target->next_buffer = buffer;
+    target->next_is_scanout = false;
+
+    if (!swc_view_attach(target->view, buffer))
+    {
+        ERROR("Failed to attach next frame to screen\n");
+        return false;
+    }
+
+    target->flip_submitted = swc_time_nsec();
+
+    return true;
+}
+
+/* Frame throttling {{{ */
+
+/* The interval, in milliseconds, at which views that can't be seen are sent
+ * frame events. */
+#define THROTTLED_FRAME_INTERVAL 1000
+
+static bool view_is_occluded(struct view * view)
+{
+    pixman_box32_t box = {
+        view->base.geometry.x, view->base.geometry.y,
+        view->base.geometry.x + view->base.geometry.width,
+        view->base.geometry.y + view->base.geometry.height
+    };
+
+    return pixman_region32_contains_rectangle(&view->clip, &box)
+        == PIXMAN_REGION_IN;
+}
+
+/**
+ * Determines whether a view's frame events are throttled, because it is
+ * covered by opaque views above it or isn't on any screen.
+ */
+static bool view_is_throttled(struct view * view)
+{
+    return view->visible && (!view->base.screens || view_is_occluded(view));
+}
+
+static void schedule_throttled_frames()
+{
+    if (compositor.throttle_armed)
+        return;
+
+    wl_event_source_timer_update(compositor.throttle_timer,
+                                 THROTTLED_FRAME_INTERVAL);
+    compositor.throttle_armed = true;
+}
+
+static int handle_throttle_timer(void * data)
+{
+    struct view * view;
+    struct swc_frame frame = { .presented = false };
+
+    compositor.throttle_armed = false;
+    clock_gettime(CLOCK_MONOTONIC, &frame.time);
+
+    wl_list_for_each(view, &compositor.views, link)
+    {
+        if (view_is_throttled(view))
+        {
+            swc_view_frame(&view->base, &frame);
+            schedule_throttled_frames();
+        }
+    }
+
+    return 0;
+}
+
+/* }}} */
+
 static void handle_screen_view_event(struct wl_listener * listener, void * data)
 {
     struct swc_event * event = data;
@@ -154,27 +469,83 @@ static void handle_screen_view_event(struct wl_listener * listener, void * data)
                 (event_data->view, typeof(*screen), planes.framebuffer.view);
             struct target * target;
             struct view * view;
+            struct swc_frame frame = event_data->frame;
 
             if (!(target = target_get(screen)))
                 return;
 
-            compositor.pending_flips &= ~screen_mask(screen);
+            /* The first frame is displayed by a modeset, which takes much
+             * longer than a page flip. */
+            if (target->last_flip)
+            {
+                swc_timing_add_flip(&target->timing, target->flip_submitted,
+                                    swc_timespec_to_nsec(&frame.time),
+                                    target->refresh_interval);
+            }
+
+            target->flip_pending = false;
+            target->last_flip = swc_timespec_to_nsec(&frame.time);
+            frame.screen = screen;
 
             wl_list_for_each(view, &compositor.views, link)
             {
-                if (view->base.screens & screen_mask(screen))
-                    swc_view_frame(&view->base, event_data->frame.time);
+                if (!(view->base.screens & screen_mask(screen)))
+                    continue;
+
+                if (view_is_throttled(view))
+                {
+                    swc_presentation_discard(&view->feedbacks);
+                    schedule_throttled_frames();
+                    continue;
+                }
+
+                /* Views on a plane of their own are displayed without being
+                 * copied into the framebuffer. */
+                frame.flags = event_data->frame.flags;
+
+                if (view->overlay || (target->next_is_scanout
+                                      && target->next_buffer == view->buffer))
+                {
+                    frame.flags |= WP_PRESENTATION_FEEDBACK_KIND_ZERO_COPY;
+                }
+
+                swc_view_frame(&view->base, &frame);
+                swc_presentation_present(&view->feedbacks, &frame);
             }
 
             if (target->current_buffer)
-                wld_surface_release(target->surface, target->current_buffer);
+            {
+                if (target->current_is_scanout)
+                    end_scanout(target->current_buffer);
+                else
+                    wld_surface_release(target->surface,
+                                        target->current_buffer);
+            }
 
             target->current_buffer = target->next_buffer;
+            target->current_is_scanout = target->next_is_scanout;
+
+            if (target->queued_buffer)
+            {
+                target->flip_pending
+                    = target_attach(target, target->queued_buffer);
+                target->queued_buffer = NULL;
+
+                wl_list_for_each(view, &compositor.views, link)
+                {
+                    if (!(view->base.screens & screen_mask(screen)))
+                        continue;
+
+                    wl_list_insert_list(&view->feedbacks,
+                                        &view->queued_feedbacks);
+                    wl_list_init(&view->queued_feedbacks);
+                }
+            }
 
             /* If we had scheduled updates that couldn't run because we were
-             * waiting on a page flip, run them now. */
-            if (compositor.scheduled_updates && !compositor.updating)
-                perform_update(NULL);
+             * waiting on a page flip, schedule them for the next frame. */
+            if (target->scheduled)
+                schedule_repaint(target);
             break;
         }
     }
@@ -182,20 +553,62 @@ static void handle_screen_view_event(struct wl_listener * listener, void * data)
 
 static bool target_swap_buffers(struct target * target)
 {
-    target->next_buffer = wld_surface_take(target->surface);
+    struct wld_buffer * buffer = wld_surface_take(target->surface);
 
-    if (!swc_view_attach(target->view, target->next_buffer))
+    /* The previous frame is still waiting on its page flip, so this one is
+     * attached once it completes. */
+    if (target->flip_pending)
     {
-        ERROR("Failed to attach next frame to screen\n");
+        target->queued_buffer = buffer;
+        return true;
+    }
+
+    return target_attach(target, buffer);
+}
+
+/**
+ * Determines whether a frame can be rendered while a page flip is still
+ * pending.
+ *
+ * Overlay planes are updated as soon as a frame is rendered, so they would get
+ * ahead of a queued frame. Screens using them wait for the flip instead.
+ */
+static bool target_can_queue(struct target * target)
+{
+    struct swc_overlay_plane * plane;
+
+    if (compositor.render_buffers < 3 || target->queued_buffer)
         return false;
+
+    wl_list_for_each(plane, &target->screen->planes.overlays, link)
+    {
+        if (plane->view.buffer)
+            return false;
     }
 
     return true;
 }
 
+static void handle_repaint(void * data)
+{
+    struct target * target = data;
+
+    target->repaint_idle = NULL;
+    target->repaint_armed = false;
+    perform_update(target);
+}
+
+static int handle_repaint_timer(void * data)
+{
+    handle_repaint(data);
+
+    return 0;
+}
+
 static struct target * target_new(struct screen * screen)
 {
     struct target * target;
+    const struct swc_mode * mode = &screen->planes.framebuffer.mode;
 
     if (!(target = malloc(sizeof *target)))
         goto error0;
@@ -209,69 +622,342 @@ static struct target * target_new(struct screen * screen)
     if (!target->surface)
         goto error1;
 
+    target->repaint_timer = wl_event_loop_add_timer
+        (swc.event_loop, &handle_repaint_timer, target);
+
+    if (!target->repaint_timer)
+        goto error2;
+
+    target->repaint_idle = NULL;
+    target->repaint_armed = false;
+    target->flip_submitted = 0;
+    swc_timing_initialize(&target->timing);
+    target->last_flip = 0;
+    target->render_time = 0;
+    /* The mode refresh rate is in mHz. */
+    target->refresh_interval
+        = mode->refresh ? 1000000000000ull / mode->refresh : 0;
+
+    accumulator_initialize(&target->damage);
+    target->scheduled = false;
+    target->flip_pending = false;
+    target->screen = screen;
     target->view = &screen->planes.framebuffer.view;
     target->view_listener.notify = &handle_screen_view_event;
     wl_signal_add(&target->view->event_signal, &target->view_listener);
     target->current_buffer = NULL;
+    target->current_is_scanout = false;
+    target->queued_buffer = NULL;
     target->mask = screen_mask(screen);
-    target_swap_buffers(target);
+
+    /* The initial modeset completes with a frame event like any other flip. */
+    target->flip_pending = target_swap_buffers(target);
 
     target->screen_listener.notify = &handle_screen_event;
     wl_signal_add(&screen->base.event_signal, &target->screen_listener);
 
     return target;
 
+error2:
+    wld_destroy_surface(target->surface);
 error1:
     free(target);
 error0:
     return NULL;
 }
 
+/**
+ * Determines whether any part of a view, including its border, is on a screen.
+ *
+ * This uses the extents rather than the screen mask, so that borders of views
+ * on other screens are taken into account.
+ */
+static bool view_overlaps_screen(struct view * view, struct screen * screen)
+{
+    const struct swc_rectangle * geometry = &screen->base.geometry;
+
+    return view->extents.x2 > geometry->x
+        && view->extents.y2 > geometry->y
+        && view->extents.x1 < geometry->x + (int32_t) geometry->width
+        && view->extents.y1 < geometry->y + (int32_t) geometry->height;
+}
+
 /* Rendering {{{ */
 
-static void repaint_view(struct target * target, struct view * view,
-                         pixman_region32_t * damage)
+/* How many of the most recent commands are considered for merging. */
+#define COMMAND_MERGE_DISTANCE 16
+
+static bool boxes_overlap(const pixman_box32_t * a, const pixman_box32_t * b)
 {
-    pixman_region32_t view_region, view_damage, border_damage;
-    const struct swc_rectangle * geometry = &view->base.geometry;
+    return a->x1 < b->x2 && b->x1 < a->x2 && a->y1 < b->y2 && b->y1 < a->y2;
+}
+
+/**
+ * Queues an operation on a region (in global coordinates) for the frame.
+ *
+ * Operations are carried out in order, and later ones draw over earlier ones.
+ * An operation with the same source as one queued shortly before it is merged
+ * into that one instead, as long as no operation in between overlaps it, since
+ * the result is then the same.
+ */
+static void queue_command(const struct render_command * template,
+                          pixman_region32_t * region)
+{
+    struct render_command * commands = compositor.commands.data, * command;
+    pixman_box32_t * extents = pixman_region32_extents(region);
+    unsigned index, limit;
+
+    limit = compositor.num_commands > COMMAND_MERGE_DISTANCE
+        ? compositor.num_commands - COMMAND_MERGE_DISTANCE : 0;
+
+    for (index = compositor.num_commands; index-- > limit;)
+    {
+        command = &commands[index];
+
+        if (command->type == template->type
+            && command->color == template->color
+            && command->buffer == template->buffer
+            && command->x == template->x && command->y == template->y)
+        {
+            TRACK(&command->region, pixman_region32_union
+                  (&command->region, &command->region, region));
+            return;
+        }
+
+        if (boxes_overlap(pixman_region32_extents(&command->region), extents))
+            break;
+    }
+
+    if (compositor.num_commands * sizeof *command == compositor.commands.size)
+    {
+        if (!(command = wl_array_add(&compositor.commands, sizeof *command)))
+        {
+            WARNING("Could not queue renderer operation\n");
+            return;
+        }
+
+        pixman_region32_init(&command->region);
+    }
+    else
+        command = &commands[compositor.num_commands];
+
+    command->type = template->type;
+    command->color = template->color;
+    command->buffer = template->buffer;
+    command->x = template->x;
+    command->y = template->y;
+    TRACK(&command->region, pixman_region32_copy(&command->region, region));
+    ++compositor.num_commands;
+}
+
+static void queue_fill(uint32_t color, pixman_region32_t * region)
+{
+    struct render_command template = { .type = RENDER_FILL, .color = color };
+
+    queue_command(&template, region);
+}
+
+static void queue_copy(struct wld_buffer * buffer, int32_t x, int32_t y,
+                       pixman_region32_t * region)
+{
+    struct render_command template = {
+        .type = RENDER_COPY, .buffer = buffer, .x = x, .y = y
+    };
+
+    queue_command(&template, region);
+}
+
+/**
+ * Submits the operations queued for the frame to the renderer, in one pass.
+ */
+static void submit_commands(struct target * target)
+{
+    struct render_command * command = compositor.commands.data;
+    const struct swc_rectangle * geometry = &target->view->geometry;
+    unsigned index;
+
+    DEBUG("\t\tSubmitting %u renderer operations\n", compositor.num_commands);
 
-    if (!view->base.buffer)
+    for (index = 0; index < compositor.num_commands; ++index, ++command)
+    {
+        switch (command->type)
+        {
+            case RENDER_FILL:
+                pixman_region32_translate(&command->region,
+                                          -geometry->x, -geometry->y);
+                wld_fill_region(swc.drm->renderer, command->color,
+                                &command->region);
+                break;
+            case RENDER_COPY:
+                /* The region to copy is relative to the buffer. */
+                pixman_region32_translate(&command->region,
+                                          -command->x, -command->y);
+                wld_copy_region(swc.drm->renderer, command->buffer,
+                                command->x - geometry->x,
+                                command->y - geometry->y, &command->region);
+                break;
+        }
+    }
+
+    compositor.num_commands = 0;
+}
+
+static void repaint_view(struct view * view, pixman_region32_t * damage)
+{
+    pixman_region32_t * visible_damage = &compositor.scratch.buffer,
+                      * view_damage = &compositor.scratch.damage;
+    const struct swc_rectangle * geometry = &view->base.geometry;
+    pixman_box32_t box = {
+        geometry->x, geometry->y,
+        geometry->x + geometry->width, geometry->y + geometry->height
+    };
+
+    /* Views on overlay planes only need their border drawn, which has already
+     * been done. If only borders were damaged (for example, by a change of
+     * focus), there is nothing to copy. */
+    if (view->overlay
+        || pixman_region32_contains_rectangle(damage, &box)
+            == PIXMAN_REGION_OUT)
+    {
         return;
+    }
 
-    pixman_region32_init_rect(&view_region, geometry->x, geometry->y,
-                              geometry->width, geometry->height);
-    pixman_region32_init_with_extents(&view_damage, &view->extents);
-    pixman_region32_init(&border_damage);
+    TRACK(visible_damage, pixman_region32_intersect_rect
+          (visible_damage, damage, geometry->x, geometry->y,
+           geometry->width, geometry->height));
+    TRACK(view_damage, pixman_region32_subtract(view_damage, visible_damage,
+                                                &view->clip));
 
-    pixman_region32_intersect(&view_damage, &view_damage, damage);
-    pixman_region32_subtract(&view_damage, &view_damage, &view->clip);
-    pixman_region32_subtract(&border_damage, &view_damage, &view_region);
-    pixman_region32_intersect(&view_damage, &view_damage, &view_region);
+    if (pixman_region32_not_empty(view_damage))
+        queue_copy(view->buffer, geometry->x, geometry->y, view_damage);
+}
 
-    pixman_region32_fini(&view_region);
+static struct accumulator * border_batch(uint32_t color)
+{
+    struct border_batch * batch;
 
-    if (pixman_region32_not_empty(&view_damage))
+    wl_array_for_each(batch, &compositor.borders)
     {
-        pixman_region32_translate(&view_damage, -geometry->x, -geometry->y);
-        wld_copy_region(swc.drm->renderer, view->buffer,
-                        geometry->x - target->view->geometry.x,
-                        geometry->y - target->view->geometry.y, &view_damage);
+        if (batch->color == color)
+            return &batch->region;
     }
 
-    pixman_region32_fini(&view_damage);
+    if (!(batch = wl_array_add(&compositor.borders, sizeof *batch)))
+        return NULL;
+
+    batch->color = color;
+    accumulator_initialize(&batch->region);
+
+    return &batch->region;
+}
+
+/**
+ * Draws the damaged borders of the views marked for repaint, with one fill for
+ * each color.
+ *
+ * Borders are part of the opaque region that clips the views below them (see
+ * calculate_damage), so the damaged parts of different borders never overlap,
+ * and nothing beneath them is drawn. This way they can be drawn before any of
+ * the views, in any order.
+ */
+static void repaint_borders(pixman_region32_t * damage, struct wl_list * views)
+{
+    struct view * view;
+    struct border_batch * batch;
+    struct accumulator * accumulator;
+    pixman_region32_t view_region,
+                      * visible_damage = &compositor.scratch.damage,
+                      * border_damage = &compositor.scratch.border;
+    const struct swc_rectangle * geometry;
+    size_t index;
+
+    wl_list_for_each(view, views, link)
+    {
+        if (!view->repaint || view->border.width == 0)
+            continue;
+
+        geometry = &view->base.geometry;
+        pixman_region32_init_rect(&view_region, geometry->x, geometry->y,
+                                  geometry->width, geometry->height);
+        TRACK(visible_damage, pixman_region32_intersect_rect
+              (visible_damage, damage, view->extents.x1, view->extents.y1,
+               view->extents.x2 - view->extents.x1,
+               view->extents.y2 - view->extents.y1));
+        TRACK(border_damage, pixman_region32_subtract
+              (border_damage, visible_damage, &view->clip));
+        TRACK(visible_damage, pixman_region32_subtract
+              (visible_damage, border_damage, &view_region));
+        pixman_region32_fini(&view_region);
+
+        if (pixman_region32_not_empty(visible_damage)
+            && (accumulator = border_batch(view->border.color)))
+        {
+            accumulator_add(accumulator, visible_damage);
+        }
+    }
 
-    /* Draw border */
-    if (pixman_region32_not_empty(&border_damage))
+    /* Batches of colors that are no longer used are dropped, so that they
+     * don't accumulate over time. */
+    for (index = 0; index < compositor.borders.size;)
     {
-        DEBUG("\t\tRedrawing border\n");
+        batch = (void *) ((char *) compositor.borders.data + index);
+
+        if (batch->region.empty)
+        {
+            accumulator_finalize(&batch->region);
+            swc_array_remove(&compositor.borders, batch, sizeof *batch);
+            continue;
+        }
+
+        DEBUG("\t\tRedrawing borders with color 0x%08x\n", batch->color);
 
-        pixman_region32_translate(&border_damage,
-                                  -target->view->geometry.x,
-                                  -target->view->geometry.y);
-        wld_fill_region(swc.drm->renderer, view->border.color, &border_damage);
+        queue_fill(batch->color, accumulator_region(&batch->region));
+        accumulator_reset(&batch->region);
+        index += sizeof *batch;
     }
+}
 
-    pixman_region32_fini(&border_damage);
+/**
+ * Marks the views on the target that need to be repainted.
+ *
+ * Views are visited top-down. Views outside the damage or completely covered
+ * by the opaque views above them are skipped, and once the opaque views above
+ * cover all of the damage, so is everything below.
+ */
+static void cull_views(struct target * target, pixman_region32_t * damage,
+                       struct wl_list * views)
+{
+    struct view * view;
+    pixman_box32_t * damage_extents = pixman_region32_extents(damage);
+    bool covered = !pixman_region32_not_empty(damage);
+
+    wl_list_for_each(view, views, link)
+    {
+        view->repaint = false;
+
+        if (covered || !view->base.buffer
+            || !view_overlaps_screen(view, target->screen))
+        {
+            continue;
+        }
+
+        if (pixman_region32_contains_rectangle(&view->clip, damage_extents)
+            == PIXMAN_REGION_IN)
+        {
+            covered = true;
+            continue;
+        }
+
+        if (pixman_region32_contains_rectangle(damage, &view->extents)
+                == PIXMAN_REGION_OUT
+            || pixman_region32_contains_rectangle(&view->clip, &view->extents)
+                == PIXMAN_REGION_IN)
+        {
+            continue;
+        }
+
+        view->repaint = true;
+    }
 }
 
 static void renderer_repaint(struct target * target,
@@ -280,49 +966,69 @@ static void renderer_repaint(struct target * target,
                              struct wl_list * views)
 {
     struct view * view;
+    uint64_t start = swc_time_nsec(), flush;
 
     DEBUG("Rendering to target { x: %d, y: %d, w: %u, h: %u }\n",
           target->view->geometry.x, target->view->geometry.y,
           target->view->geometry.width, target->view->geometry.height);
 
-    wld_set_target_surface(swc.drm->renderer, target->surface);
-
     /* Paint base damage black. */
     if (pixman_region32_not_empty(base_damage))
-    {
-        pixman_region32_translate(base_damage,
-                                  -target->view->geometry.x,
-                                  -target->view->geometry.y);
-        wld_fill_region(swc.drm->renderer, 0xff000000, base_damage);
-    }
+        queue_fill(0xff000000, base_damage);
+
+    cull_views(target, damage, views);
+    repaint_borders(damage, views);
 
     wl_list_for_each_reverse(view, views, link)
     {
-        if (view->base.screens & target->mask)
-            repaint_view(target, view, damage);
+        if (view->repaint)
+            repaint_view(view, damage);
     }
 
+    /* All of the region arithmetic is done by now, so the renderer is driven
+     * without interruption. */
+    wld_set_target_surface(swc.drm->renderer, target->surface);
+    submit_commands(target);
+
+    flush = swc_time_nsec();
     wld_flush(swc.drm->renderer);
+    swc_timing_add(&target->timing, SWC_TIMING_REPAINT, flush - start);
+    swc_timing_add(&target->timing, SWC_TIMING_FLUSH, swc_time_nsec() - flush);
 }
 
 static bool renderer_attach(struct view * view, struct wld_buffer * client_buffer)
 {
     struct wld_buffer * buffer;
+    union wld_object object;
+    bool imported = false;
     bool was_proxy = view->buffer != view->base.buffer;
+    /* SHM buffers in formats that must be converted only stand in for the
+     * client's data; their own pixels are never written. */
+    bool converted = client_buffer
+        && wld_export(client_buffer, SWC_SHM_OBJECT_SOURCE, &object);
     bool needs_proxy = client_buffer
-        && !(wld_capabilities(swc.drm->renderer,
-                              client_buffer) & WLD_CAPABILITY_READ);
+        && (converted || !(wld_capabilities(swc.drm->renderer, client_buffer)
+                           & WLD_CAPABILITY_READ));
     bool resized = view->buffer && client_buffer
         && (view->buffer->width != client_buffer->width
             || view->buffer->height != client_buffer->height);
 
     if (client_buffer)
     {
+        /* SHM buffers backed by a sealed memfd may already have been imported
+         * into the DRM context, in which case no copy is necessary. */
+        if (needs_proxy && wld_export(client_buffer, SWC_SHM_OBJECT_DRM_BUFFER,
+                                      &object))
+        {
+            buffer = object.ptr;
+            wld_buffer_reference(buffer);
+            imported = true;
+        }
         /* Create a proxy buffer if necessary (for example a hardware buffer
          * backing a SHM buffer). */
-        if (needs_proxy)
+        else if (needs_proxy)
         {
-            if (!was_proxy || resized)
+            if (!was_proxy || resized || view->imported)
             {
                 DEBUG("Creating a proxy buffer\n");
                 buffer = wld_create_buffer(swc.drm->context,
@@ -345,23 +1051,44 @@ static bool renderer_attach(struct view * view, struct wld_buffer * client_buffe
     else
         buffer = NULL;
 
-    /* If we no longer need a proxy buffer, or the original buffer is of a
-     * different size, destroy the old proxy image. */
-    if (view->buffer && ((!needs_proxy && was_proxy)
-                         || (needs_proxy && resized)))
-    {
+    /* Release the old proxy or imported buffer if we are not keeping it. */
+    if (view->buffer && was_proxy && view->buffer != buffer)
         wld_buffer_unreference(view->buffer);
-    }
 
     view->buffer = buffer;
+    view->imported = imported;
 
     return true;
 }
 
 static void renderer_flush_view(struct view * view)
 {
-    if (view->buffer == view->base.buffer)
+    union wld_object object;
+
+    /* Imported buffers share memory with the client's buffer. */
+    if (view->buffer == view->base.buffer || view->imported)
+        return;
+
+    /* The copy is done on the upload threads if possible, and waited for in
+     * perform_update. */
+    if (swc_upload_queue(view->buffer, view->base.buffer,
+                         &view->surface->state.damage))
+    {
+        return;
+    }
+
+    /* The renderer would copy the unwritten pixels of a stand-in buffer, so
+     * convert the client's data here instead. */
+    if (wld_export(view->base.buffer, SWC_SHM_OBJECT_SOURCE, &object))
+    {
+        if (!swc_upload_convert(view->buffer, object.ptr,
+                                &view->surface->state.damage))
+        {
+            WARNING("Failed to convert buffer contents\n");
+        }
+
         return;
+    }
 
     wld_set_target_buffer(swc.shm->renderer, view->buffer);
     wld_copy_region(swc.shm->renderer, view->base.buffer,
@@ -369,23 +1096,296 @@ static void renderer_flush_view(struct view * view)
     wld_flush(swc.shm->renderer);
 }
 
+/* Direct scanout {{{ */
+
+/**
+ * Determines whether a view's buffer can be used by the display hardware
+ * directly, without being composited into the target surface first.
+ */
+static bool view_is_scanout_capable(struct view * view)
+{
+    struct wld_buffer * buffer = view->buffer;
+    pixman_box32_t box;
+    union wld_object object;
+
+    /* Buffers that need a proxy can't be used by the display hardware, and
+     * headless screens have none. */
+    if (!buffer || buffer != view->base.buffer || swc.headless)
+        return false;
+
+    /* WLD formats use the same fourcc codes as DRM, though WLD itself has no
+     * names for YUV formats. */
+    switch ((uint32_t) buffer->format)
+    {
+        case WLD_FORMAT_XRGB8888:
+        case DRM_FORMAT_NV12:
+            break;
+        case WLD_FORMAT_ARGB8888:
+            box.x1 = 0;
+            box.y1 = 0;
+            box.x2 = buffer->width;
+            box.y2 = buffer->height;
+
+            if (pixman_region32_contains_rectangle(&view->surface->state.opaque,
+                                                   &box) != PIXMAN_REGION_IN)
+            {
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+
+    return wld_export(buffer, WLD_DRM_OBJECT_HANDLE, &object);
+}
+
+static bool view_can_scanout(struct view * view, struct screen * screen)
+{
+    const struct swc_rectangle * geometry = &view->base.geometry;
+
+    if (geometry->x != screen->base.geometry.x
+        || geometry->y != screen->base.geometry.y
+        || geometry->width != screen->base.geometry.width
+        || geometry->height != screen->base.geometry.height)
+    {
+        return false;
+    }
+
+    /* Most primary planes can't display YUV formats or every modifier, and a
+     * flip that is rejected would be retried every frame. */
+    return view_is_scanout_capable(view)
+        && swc_framebuffer_plane_supports_format
+            (&screen->planes.framebuffer, view->buffer->format,
+             swc_dmabuf_get_modifier(view->buffer));
+}
+
+/**
+ * Finds a view that can be scanned out on the given screen.
+ *
+ * This is only possible if the topmost view on the screen covers it
+ * completely. The cursor lives on its own hardware plane, so it does not
+ * prevent direct scanout.
+ */
+static struct view * find_scanout_view(struct screen * screen)
+{
+    struct view * view;
+
+    wl_list_for_each(view, &compositor.views, link)
+    {
+        if (!view_overlaps_screen(view, screen))
+            continue;
+
+        return view_can_scanout(view, screen) ? view : NULL;
+    }
+
+    return NULL;
+}
+
+static bool target_scanout(struct target * target, struct view * view)
+{
+    if (!swc_view_attach(target->view, view->buffer))
+        return false;
+
+    DEBUG("Scanning out view directly\n");
+
+    /* Hold a reference until the buffer is no longer on screen, since the
+     * framebuffer gets destroyed along with it. The client isn't told it can
+     * reuse the buffer until then either. */
+    wld_buffer_reference(view->buffer);
+    swc_wayland_buffer_begin_scanout(view->buffer);
+    target->next_buffer = view->buffer;
+    target->next_is_scanout = true;
+    target->flip_submitted = swc_time_nsec();
+
+    return true;
+}
+
+static bool view_can_use_overlay(struct view * view, struct screen * screen)
+{
+    const struct swc_rectangle * geometry = &view->base.geometry;
+
+    if (geometry->x < screen->base.geometry.x
+        || geometry->y < screen->base.geometry.y
+        || geometry->x + geometry->width
+            > screen->base.geometry.x + screen->base.geometry.width
+        || geometry->y + geometry->height
+            > screen->base.geometry.y + screen->base.geometry.height)
+    {
+        return false;
+    }
+
+    return view_is_scanout_capable(view);
+}
+
+static struct swc_overlay_plane * find_overlay(struct screen * screen,
+                                               uint32_t format,
+                                               uint64_t modifier,
+                                               uint32_t * used)
+{
+    struct swc_overlay_plane * plane;
+    uint32_t index = 0;
+
+    wl_list_for_each(plane, &screen->planes.overlays, link)
+    {
+        if (!(*used & (1u << index))
+            && swc_overlay_plane_supports_format(plane, format, modifier))
+        {
+            *used |= 1u << index;
+            return plane;
+        }
+
+        if (++index == 32)
+            break;
+    }
+
+    return NULL;
+}
+
+/**
+ * Places views on the overlay planes of a screen.
+ *
+ * A view is only placed on an overlay plane if no other view above it
+ * overlaps it, since overlay planes are always displayed above the
+ * framebuffer plane.
+ */
+static void update_overlays(struct screen * screen, struct target * target,
+                            bool disable)
+{
+    const struct swc_rectangle * geometry = &screen->base.geometry;
+    struct swc_overlay_plane * plane;
+    struct view * view;
+    struct accumulator * above = &compositor.above;
+    pixman_box32_t box;
+    uint32_t used = 0, index = 0;
+
+    if (wl_list_empty(&screen->planes.overlays))
+        return;
+
+    accumulator_reset(above);
+
+    wl_list_for_each(view, &compositor.views, link)
+    {
+        if (!view_overlaps_screen(view, screen))
+            continue;
+
+        box.x1 = view->base.geometry.x;
+        box.y1 = view->base.geometry.y;
+        box.x2 = box.x1 + view->base.geometry.width;
+        box.y2 = box.y1 + view->base.geometry.height;
+        plane = NULL;
+
+        if (!disable && view_can_use_overlay(view, screen)
+            && pixman_region32_contains_rectangle(accumulator_region(above),
+                                                  &box) == PIXMAN_REGION_OUT)
+        {
+            plane = find_overlay(screen, view->buffer->format,
+                                 swc_dmabuf_get_modifier(view->buffer), &used);
+        }
+
+        accumulator_add_box(above, &view->extents);
+
+        if (plane)
+        {
+            swc_view_move(&plane->view, box.x1, box.y1);
+
+            if (plane->view.buffer != view->buffer
+                && !swc_view_attach(&plane->view, view->buffer))
+            {
+                plane = NULL;
+            }
+        }
+
+        /* If the view is leaving its overlay plane, the framebuffer beneath it
+         * is out of date, and needs to be repainted. */
+        if (view->overlay && !plane && !target->next_is_scanout)
+        {
+            pixman_region32_union_rect
+                (&target->next_buffer->damage, &target->next_buffer->damage,
+                 box.x1 - geometry->x, box.y1 - geometry->y,
+                 box.x2 - box.x1, box.y2 - box.y1);
+        }
+
+        view->overlay = plane;
+    }
+
+    /* Disable any planes that are no longer used. */
+    wl_list_for_each(plane, &screen->planes.overlays, link)
+    {
+        if (!(used & (1u << index)) && plane->view.buffer)
+            swc_view_attach(&plane->view, NULL);
+
+        if (++index == 32)
+            break;
+    }
+}
+
+/**
+ * Records which views are scanned out directly by a screen, once its planes
+ * have been assigned.
+ */
+static void update_scanout(struct screen * screen, struct view * scanout_view)
+{
+    struct view * view;
+    uint32_t scanout;
+
+    wl_list_for_each(view, &compositor.views, link)
+    {
+        scanout = view->base.scanout & ~screen_mask(screen);
+
+        if (view == scanout_view
+            || (view->overlay && view_overlaps_screen(view, screen)))
+        {
+            scanout |= screen_mask(screen);
+        }
+
+        swc_view_set_scanout(&view->base, scanout);
+    }
+}
+
 /* }}} */
 
 /* Surface Views {{{ */
 
+/**
+ * Adds damage, in global coordinates, to the damage accumulated by each screen
+ * it intersects.
+ */
+static void add_damage(pixman_region32_t * damage)
+{
+    struct screen * screen;
+    struct target * target;
+    const struct swc_rectangle * geometry;
+    pixman_region32_t * screen_damage = &compositor.scratch.damage;
+
+    wl_list_for_each(screen, &swc.screens, link)
+    {
+        if (!(target = target_get(screen)))
+            continue;
+
+        geometry = &screen->base.geometry;
+        TRACK(screen_damage, pixman_region32_intersect_rect
+              (screen_damage, damage, geometry->x, geometry->y,
+               geometry->width, geometry->height));
+
+        if (pixman_region32_not_empty(screen_damage))
+            accumulator_add(&target->damage, screen_damage);
+    }
+}
+
 /**
  * Adds damage from the region below a view, taking into account it's clip
- * region, to the region specified by `damage'.
+ * region.
  */
 static void damage_below_view(struct view * view)
 {
-    pixman_region32_t damage_below;
-
-    pixman_region32_init_with_extents(&damage_below, &view->extents);
-    pixman_region32_subtract(&damage_below, &damage_below, &view->clip);
-    pixman_region32_union(&compositor.damage, &compositor.damage,
-                          &damage_below);
-    pixman_region32_fini(&damage_below);
+    pixman_region32_t extents,
+                      * damage_below = &compositor.scratch.below;
+
+    pixman_region32_init_with_extents(&extents, &view->extents);
+    TRACK(damage_below, pixman_region32_subtract(damage_below, &extents,
+                                                 &view->clip));
+    add_damage(damage_below);
+    pixman_region32_fini(&extents);
 }
 
 /**
@@ -397,86 +1397,294 @@ static void damage_view(struct view * view)
     view->border.damaged = true;
 }
 
-static void update_extents(struct view * view)
+static void update_extents(struct view * view)
+{
+    view->extents.x1 = view->base.geometry.x - view->border.width;
+    view->extents.y1 = view->base.geometry.y - view->border.width;
+    view->extents.x2 = view->base.geometry.x + view->base.geometry.width
+        + view->border.width;
+    view->extents.y2 = view->base.geometry.y + view->base.geometry.height
+        + view->border.width;
+
+    /* Damage border. */
+    view->border.damaged = true;
+}
+
+/* Frame scheduling {{{ */
+
+/* Used if SWC_REPAINT_WINDOW is not set, but at most half the refresh
+ * interval. In nanoseconds. */
+#define DEFAULT_REPAINT_WINDOW 7000000
+
+/* Returns the number of milliseconds until the repaint for the next vblank of
+ * the target's screen should start. */
+static uint32_t repaint_delay(struct target * target)
+{
+    uint64_t window, next, elapsed;
+
+    if (!target->last_flip || !target->refresh_interval)
+        return 0;
+
+    if (compositor.repaint_window)
+        window = compositor.repaint_window * 1000000ull;
+    else
+        window = MIN(DEFAULT_REPAINT_WINDOW, target->refresh_interval / 2);
+
+    /* Leave at least as much time as the last repaint took. */
+    window = MAX(window, target->render_time + 1000000);
+
+    if (window >= target->refresh_interval)
+        return 0;
+
+    elapsed = swc_time_nsec() - target->last_flip;
+    next = target->refresh_interval - elapsed % target->refresh_interval;
+
+    /* If we are already past the deadline, start right away; the frame may
+     * still make it in time. */
+    return next > window ? swc_nsec_to_msec(next - window) : 0;
+}
+
+static void schedule_repaint(struct target * target)
+{
+    uint32_t delay;
+
+    if (target->repaint_armed)
+        return;
+
+    if ((delay = repaint_delay(target)) > 0)
+    {
+        wl_event_source_timer_update(target->repaint_timer, delay);
+        target->repaint_armed = true;
+    }
+    else
+    {
+        target->repaint_idle = wl_event_loop_add_idle
+            (swc.event_loop, &handle_repaint, target);
+        target->repaint_armed = target->repaint_idle != NULL;
+    }
+}
+
+static void schedule_updates(uint32_t screens)
+{
+    struct screen * screen;
+    struct target * target;
+
+    wl_list_for_each(screen, &swc.screens, link)
+    {
+        if (!(screens & screen_mask(screen)) || !(target = target_get(screen)))
+            continue;
+
+        target->scheduled = true;
+
+        /* Screens waiting for a page flip are scheduled once it completes,
+         * unless the next frame can be queued behind it. */
+        if (!target->flip_pending || target_can_queue(target))
+            schedule_repaint(target);
+    }
+}
+
+/* }}} */
+
+static bool update(struct swc_view * base)
+{
+    struct view * view = (void *) base;
+
+    if (!compositor.active || !view->visible)
+        return false;
+
+    schedule_updates(view->base.screens);
+
+    return true;
+}
+
+static bool attach(struct swc_view * base, struct wld_buffer * buffer)
+{
+    struct view * view = (void *) base;
+
+    if (!renderer_attach(view, buffer))
+        return false;
+
+    if (view->visible && view->base.buffer)
+    {
+        damage_below_view(view);
+        update(&view->base);
+    }
+
+    swc_view_set_size_from_buffer(&view->base, buffer);
+
+    return true;
+}
+
+static bool move(struct swc_view * base, int32_t x, int32_t y)
+{
+    struct view * view = (void *) base;
+
+    if (view->visible)
+    {
+        damage_below_view(view);
+        update(&view->base);
+    }
+
+    swc_view_set_position(&view->base, x, y);
+
+    return true;
+}
+
+const static struct swc_view_impl view_impl = {
+    .update = &update,
+    .attach = &attach,
+    .move = &move
+};
+
+/* Subsurfaces {{{ */
+
+static struct view * surface_view(struct swc_surface * surface)
+{
+    return surface->view && surface->view->impl == &view_impl
+        ? (void *) surface->view : NULL;
+}
+
+/**
+ * Calls a function for the views of a surface and its subsurfaces, from bottom
+ * to top.
+ */
+static void for_each_view(struct swc_surface * surface,
+                          void (* func)(struct view * view, void * data),
+                          void * data)
+{
+    struct swc_subsurface * subsurface;
+    struct wl_list * link;
+    struct view * view;
+
+    for (link = surface->stack.current.next;
+         link != &surface->stack.current; link = link->next)
+    {
+        if (link == &surface->stack.link)
+        {
+            if ((view = surface_view(surface)))
+                func(view, data);
+        }
+        else
+        {
+            subsurface = CONTAINER_OF(link, typeof(*subsurface), link);
+            for_each_view(subsurface->surface, func, data);
+        }
+    }
+}
+
+static void show_view(struct view * view)
 {
-    view->extents.x1 = view->base.geometry.x - view->border.width;
-    view->extents.y1 = view->base.geometry.y - view->border.width;
-    view->extents.x2 = view->base.geometry.x + view->base.geometry.width
-        + view->border.width;
-    view->extents.y2 = view->base.geometry.y + view->base.geometry.height
-        + view->border.width;
+    /* Assume worst-case no clipping until we draw the next frame (in case the
+     * surface gets moved before that. */
+    pixman_region32_clear(&view->clip);
 
-    /* Damage border. */
-    view->border.damaged = true;
+    view->visible = true;
+    swc_view_update_screens(&view->base);
+
+    if (!view->base.screens)
+        schedule_throttled_frames();
+
+    damage_view(view);
+    update(&view->base);
 }
 
-static void schedule_updates(uint32_t screens)
+static void hide_view(struct view * view, void * data)
 {
-    if (compositor.scheduled_updates == 0)
-        wl_event_loop_add_idle(swc.event_loop, &perform_update, NULL);
+    if (!view->visible)
+        return;
 
-    if (screens == -1)
-    {
-        struct screen * screen;
+    /* Update all the screens the view was on. */
+    update(&view->base);
+    damage_below_view(view);
 
-        screens = 0;
-        wl_list_for_each(screen, &swc.screens, link)
-            screens |= screen_mask(screen);
-    }
+    wl_list_remove(&view->link);
+    swc_grid_remove(&compositor.grid, &view->grid_entry);
+    swc_view_set_screens(&view->base, 0);
+    view->visible = false;
+    swc_presentation_discard(&view->feedbacks);
+    swc_presentation_discard(&view->queued_feedbacks);
 
-    compositor.scheduled_updates |= screens;
+    /* The overlay plane keeps its own reference to the buffer, and will be
+     * disabled on the next update of its screen. */
+    view->overlay = NULL;
+    swc_view_set_scanout(&view->base, 0);
 }
 
-static bool update(struct swc_view * base)
+/**
+ * Inserts a view into the stack below the given link, above the views inserted
+ * before it, and shows it if necessary.
+ */
+static void insert_view(struct view * view, void * data)
 {
-    struct view * view = (void *) base;
-
-    if (!compositor.active || !view->visible)
-        return false;
+    struct wl_list * above = data;
 
-    schedule_updates(view->base.screens);
+    if (!view->visible)
+        show_view(view);
 
-    return true;
+    view->grid_entry.order = compositor.next_order++;
+    swc_grid_insert(&compositor.grid, &view->grid_entry, &view->base.geometry);
+    wl_list_insert(above, &view->link);
 }
 
-static bool attach(struct swc_view * base, struct wld_buffer * buffer)
+static void unlink_view(struct view * view, void * data)
 {
-    struct view * view = (void *) base;
+    damage_below_view(view);
+    update(&view->base);
+    wl_list_remove(&view->link);
+}
 
-    if (!renderer_attach(view, buffer))
-        return false;
+static void move_subsurfaces(struct view * view)
+{
+    struct swc_surface * surface = view->surface;
+    struct wl_list * link;
 
-    if (view->visible && view->base.buffer)
+    for (link = surface->stack.current.next;
+         link != &surface->stack.current; link = link->next)
     {
-        damage_below_view(view);
-        update(&view->base);
+        if (link != &surface->stack.link)
+        {
+            swc_subsurface_update_position
+                (CONTAINER_OF(link, struct swc_subsurface, link));
+        }
     }
-
-    swc_view_set_size_from_buffer(&view->base, buffer);
-
-    return true;
 }
 
-static bool move(struct swc_view * base, int32_t x, int32_t y)
+void swc_compositor_surface_restack(struct swc_surface * surface)
 {
-    struct view * view = (void *) base;
+    struct view * view;
+    struct wl_list * above = &compositor.views;
 
-    if (view->visible)
+    surface = swc_subsurface_get_root(surface);
+
+    if (!(view = surface_view(surface)) || !view->visible)
+        return;
+
+    /* The views of a tree of subsurfaces are adjacent in the stack, so they
+     * are put back where the topmost one was. */
+    wl_list_for_each(view, &compositor.views, link)
     {
-        damage_below_view(view);
-        update(&view->base);
+        if (swc_subsurface_get_root(view->surface) == surface)
+        {
+            above = view->link.prev;
+            break;
+        }
     }
 
-    swc_view_set_position(&view->base, x, y);
+    for_each_view(surface, &unlink_view, NULL);
+    for_each_view(surface, &insert_view, above);
 
-    return true;
+    /* The tree was given the newest orders, so the views stacked above it
+     * need newer ones still for the grid to rank them correctly. */
+    for (; above != &compositor.views; above = above->prev)
+    {
+        view = CONTAINER_OF(above, typeof(*view), link);
+        view->grid_entry.order = compositor.next_order++;
+        swc_grid_insert(&compositor.grid, &view->grid_entry,
+                        &view->base.geometry);
+    }
 }
 
-const static struct swc_view_impl view_impl = {
-    .update = &update,
-    .attach = &attach,
-    .move = &move
-};
+/* }}} */
 
 static void handle_view_event(struct wl_listener * listener, void * data)
 {
@@ -492,12 +1700,16 @@ static void handle_view_event(struct wl_listener * listener, void * data)
             {
                 /* Assume worst-case no clipping until we draw the next frame (in case
                  * the surface gets moved again before that). */
-                pixman_region32_init(&view->clip);
+                pixman_region32_clear(&view->clip);
 
                 damage_below_view(view);
+                swc_grid_insert(&compositor.grid, &view->grid_entry,
+                                &view->base.geometry);
                 swc_view_update_screens(&view->base);
                 update(&view->base);
             }
+
+            move_subsurfaces(view);
             break;
         case SWC_VIEW_EVENT_RESIZED:
             update_extents(view);
@@ -505,10 +1717,16 @@ static void handle_view_event(struct wl_listener * listener, void * data)
             if (view->visible)
             {
                 damage_below_view(view);
+                swc_grid_insert(&compositor.grid, &view->grid_entry,
+                                &view->base.geometry);
                 swc_view_update_screens(&view->base);
                 update(&view->base);
             }
             break;
+        case SWC_VIEW_EVENT_SCREENS_CHANGED:
+            if (view_is_throttled(view))
+                schedule_throttled_frames();
+            break;
     }
 }
 
@@ -526,6 +1744,8 @@ bool swc_compositor_add_surface(struct swc_surface * surface)
     wl_signal_add(&view->base.event_signal, &view->event_listener);
     view->surface = surface;
     view->buffer = NULL;
+    view->imported = false;
+    view->overlay = NULL;
     view->visible = false;
     view->extents.x1 = 0;
     view->extents.y1 = 0;
@@ -534,6 +1754,10 @@ bool swc_compositor_add_surface(struct swc_surface * surface)
     view->border.width = 0;
     view->border.color = 0x000000;
     view->border.damaged = false;
+    view->grid_entry.inserted = false;
+    view->repaint = false;
+    wl_list_init(&view->feedbacks);
+    wl_list_init(&view->queued_feedbacks);
     pixman_region32_init(&view->clip);
     swc_surface_set_view(surface, &view->base);
 
@@ -564,16 +1788,8 @@ void swc_compositor_surface_show(struct swc_surface * surface)
     if (view->visible)
         return;
 
-    /* Assume worst-case no clipping until we draw the next frame (in case the
-     * surface gets moved before that. */
-    pixman_region32_clear(&view->clip);
-
-    view->visible = true;
-    swc_view_update_screens(&view->base);
-
-    damage_view(view);
-    update(&view->base);
-    wl_list_insert(&compositor.views, &view->link);
+    /* Subsurfaces are shown along with their parent. */
+    for_each_view(surface, &insert_view, &compositor.views);
 }
 
 void swc_compositor_surface_hide(struct swc_surface * surface)
@@ -585,13 +1801,7 @@ void swc_compositor_surface_hide(struct swc_surface * surface)
     if (!view->visible)
         return;
 
-    /* Update all the screens the view was on. */
-    update(&view->base);
-    damage_below_view(view);
-
-    wl_list_remove(&view->link);
-    swc_view_set_screens(&view->base, 0);
-    view->visible = false;
+    for_each_view(surface, &hide_view, NULL);
 }
 
 void swc_compositor_surface_set_border_width(struct swc_surface * surface,
@@ -633,155 +1843,415 @@ void swc_compositor_surface_set_border_color(struct swc_surface * surface,
 
 /* }}} */
 
-static void calculate_damage()
+/**
+ * Calculates the clip regions of the views and the damage of each screen, and
+ * starts copying SHM buffers into their proxies.
+ *
+ * Returns the time spent copying, in nanoseconds.
+ */
+static uint64_t calculate_damage()
 {
     struct view * view;
-    pixman_region32_t surface_opaque, * surface_damage;
+    uint64_t start, upload_time = 0;
+    pixman_region32_t * surface_opaque = &compositor.scratch.opaque,
+                      * surface_damage;
 
-    pixman_region32_clear(&compositor.opaque);
-    pixman_region32_init(&surface_opaque);
+    accumulator_reset(&compositor.opaque);
 
     /* Go through views top-down to calculate clipping regions. */
     wl_list_for_each(view, &compositor.views, link)
     {
         /* Clip the surface by the opaque region covering it. */
-        pixman_region32_copy(&view->clip, &compositor.opaque);
-
-        /* Translate the opaque region to global coordinates. */
-        pixman_region32_copy(&surface_opaque, &view->surface->state.opaque);
-        pixman_region32_translate(&surface_opaque,
-                                  view->base.geometry.x, view->base.geometry.y);
+        TRACK(&view->clip, pixman_region32_copy
+              (&view->clip, accumulator_region(&compositor.opaque)));
+
+        /* Buffers without an alpha channel are opaque, whatever the opaque
+         * region of the surface. This way, a subsurface showing video hides
+         * the part of its parent below it. */
+        if (view->base.buffer
+            && (view->base.buffer->format == WLD_FORMAT_XRGB8888
+                || view->base.buffer->format == DRM_FORMAT_NV12))
+        {
+            pixman_box32_t box = {
+                view->base.geometry.x, view->base.geometry.y,
+                view->base.geometry.x + view->base.geometry.width,
+                view->base.geometry.y + view->base.geometry.height
+            };
 
-        /* Add the surface's opaque region to the accumulated opaque
-         * region. */
-        pixman_region32_union(&compositor.opaque, &compositor.opaque,
-                              &surface_opaque);
+            accumulator_add_box(&compositor.opaque, &box);
+        }
+        else if (pixman_region32_not_empty(&view->surface->state.opaque))
+        {
+            /* Translate the opaque region to global coordinates. */
+            TRACK(surface_opaque, pixman_region32_copy
+                  (surface_opaque, &view->surface->state.opaque));
+            pixman_region32_translate(surface_opaque, view->base.geometry.x,
+                                      view->base.geometry.y);
+
+            /* Add the surface's opaque region to the accumulated opaque
+             * region. */
+            accumulator_add(&compositor.opaque, surface_opaque);
+        }
 
         surface_damage = &view->surface->state.damage;
 
         if (pixman_region32_not_empty(surface_damage))
         {
+            start = swc_time_nsec();
             renderer_flush_view(view);
+            upload_time += swc_time_nsec() - start;
 
             /* Translate surface damage to global coordinates. */
             pixman_region32_translate
                 (surface_damage, view->base.geometry.x, view->base.geometry.y);
 
-            /* Add the surface damage to the compositor damage. */
-            pixman_region32_union(&compositor.damage, &compositor.damage,
-                                  surface_damage);
+            /* Add the surface damage to the damage of each screen. */
+            add_damage(surface_damage);
             pixman_region32_clear(surface_damage);
         }
 
-        if (view->border.damaged)
+        if (view->border.width > 0)
         {
-            pixman_region32_t border_region, view_region;
+            pixman_region32_t extents, view_region,
+                              * border_region = &compositor.scratch.border;
 
-            pixman_region32_init_with_extents(&border_region, &view->extents);
+            pixman_region32_init_with_extents(&extents, &view->extents);
             pixman_region32_init_rect
                 (&view_region, view->base.geometry.x, view->base.geometry.y,
                  view->base.geometry.width, view->base.geometry.height);
 
-            pixman_region32_subtract(&border_region, &border_region,
-                                     &view_region);
+            TRACK(border_region, pixman_region32_subtract
+                  (border_region, &extents, &view_region));
 
-            pixman_region32_union(&compositor.damage, &compositor.damage,
-                                  &border_region);
+            /* Borders are filled with a solid color, so they hide what is
+             * below them just like opaque content. Only views with a buffer
+             * are drawn, along with their border. */
+            if (view->base.buffer)
+                accumulator_add(&compositor.opaque, border_region);
 
-            pixman_region32_fini(&border_region);
-            pixman_region32_fini(&view_region);
+            if (view->border.damaged)
+                add_damage(border_region);
 
-            view->border.damaged = false;
+            pixman_region32_fini(&extents);
+            pixman_region32_fini(&view_region);
         }
+
+        view->border.damaged = false;
     }
 
-    pixman_region32_fini(&surface_opaque);
+    return upload_time;
 }
 
-static void update_screen(struct screen * screen)
+/**
+ * Produces the next frame for a screen.
+ *
+ * Returns whether a buffer was attached (or queued) to the screen, in which
+ * case a frame event will follow.
+ */
+static bool update_screen(struct target * target)
 {
-    struct target * target;
+    struct screen * screen = target->screen;
+    struct view * view;
     const struct swc_rectangle * geometry = &screen->base.geometry;
     pixman_region32_t damage;
+    uint64_t start = swc_time_nsec();
+    bool queue = target->flip_pending, attached;
 
-    if (!(compositor.scheduled_updates & screen_mask(screen)))
-        return;
+    /* A queued frame is always composited, and leaves the overlay planes
+     * alone (see target_can_queue). */
+    if (!queue && (view = find_scanout_view(screen))
+        && target_scanout(target, view))
+    {
+        /* Client buffers don't track damage for us. Once we return to
+         * compositing, the whole screen is repainted instead. */
+        accumulator_reset(&target->damage);
+        update_overlays(screen, target, true);
+        update_scanout(screen, view);
+        target->render_time = swc_time_nsec() - start;
+        return true;
+    }
 
-    if (!(target = target_get(screen)))
-        return;
+    if (!queue)
+    {
+        update_overlays(screen, target, false);
+        update_scanout(screen, NULL);
+    }
 
-    pixman_region32_init(&damage);
-    pixman_region32_intersect_rect(&damage, &compositor.damage,
-                                   geometry->x, geometry->y,
-                                   geometry->width, geometry->height);
-    pixman_region32_translate(&damage, -geometry->x, -geometry->y);
-    pixman_region32_union(&target->next_buffer->damage,
-                          &target->next_buffer->damage, &damage);
-    pixman_region32_fini(&damage);
-
-    /* Don't repaint the screen if it is waiting for a page flip. */
-    if (compositor.pending_flips & screen_mask(screen))
-        return;
+    pixman_region32_t * total_damage,
+                      * base_damage = &compositor.scratch.base,
+                      * buffer_damage = &compositor.scratch.buffer;
+
+    if (target->next_is_scanout)
+    {
+        pixman_region32_init_rect(&damage, 0, 0,
+                                  geometry->width, geometry->height);
+        total_damage = wld_surface_damage(target->surface, &damage);
+        pixman_region32_fini(&damage);
+    }
+    else
+    {
+        if (!target->damage.empty)
+        {
+            swc_damage_simplify(accumulator_region(&target->damage));
+            pixman_region32_translate(accumulator_region(&target->damage),
+                                      -geometry->x, -geometry->y);
+            TRACK(buffer_damage, pixman_region32_union
+                  (buffer_damage, &target->next_buffer->damage,
+                   accumulator_region(&target->damage)));
+            pixman_region32_copy(&target->next_buffer->damage, buffer_damage);
+        }
 
-    pixman_region32_t * total_damage, base_damage;
+        total_damage = wld_surface_damage(target->surface,
+                                          &target->next_buffer->damage);
+    }
 
-    total_damage = wld_surface_damage(target->surface,
-                                      &target->next_buffer->damage);
+    accumulator_reset(&target->damage);
     pixman_region32_translate(total_damage, geometry->x, geometry->y);
-    pixman_region32_init(&base_damage);
-    pixman_region32_subtract(&base_damage, total_damage, &compositor.opaque);
-    renderer_repaint(target, total_damage, &base_damage, &compositor.views);
-    pixman_region32_fini(&base_damage);
-    target_swap_buffers(target);
+    TRACK(base_damage, pixman_region32_subtract
+          (base_damage, total_damage, accumulator_region(&compositor.opaque)));
+    renderer_repaint(target, total_damage, base_damage, &compositor.views);
+    attached = target_swap_buffers(target);
+    target->render_time = swc_time_nsec() - start;
+
+    return attached;
 }
 
-static void perform_update(void * data)
+/**
+ * Associates the presentation feedback of the views on a screen with the frame
+ * that was just produced for it.
+ */
+static void latch_feedback(struct target * target)
 {
-    struct screen * screen;
-    uint32_t updates = compositor.scheduled_updates
-                     & ~compositor.pending_flips;
+    struct view * view;
+    struct wl_list * feedbacks;
+
+    wl_list_for_each(view, &compositor.views, link)
+    {
+        if (!(view->base.screens & target->mask))
+            continue;
+
+        feedbacks = target->queued_buffer ? &view->queued_feedbacks
+                                          : &view->feedbacks;
+        wl_list_insert_list(feedbacks, &view->surface->state.feedbacks);
+        wl_list_init(&view->surface->state.feedbacks);
+    }
+}
 
-    if (!compositor.active || !updates)
+/**
+ * Repaints a screen once its frame clock deadline is reached.
+ *
+ * Each screen repaints on its own schedule. The damage collected from the
+ * views is distributed to every screen it touches, so screens that aren't due
+ * yet pick it up on their own repaint.
+ */
+static void perform_update(struct target * target)
+{
+    uint64_t start, upload_time;
+
+    if (!compositor.active || compositor.updating || !target->scheduled
+        || (target->flip_pending && !target_can_queue(target)))
+    {
         return;
+    }
 
-    DEBUG("Performing update\n");
+    DEBUG("Performing update of screen %u\n", target->screen->id);
 
     compositor.updating = true;
-    calculate_damage();
-
-    wl_list_for_each(screen, &swc.screens, link)
-        update_screen(screen);
+#if ENABLE_DEBUG
+    compositor.frame_allocations = 0;
+#endif
+    start = swc_time_nsec();
+    upload_time = calculate_damage();
+    swc_timing_add(&target->timing, SWC_TIMING_DAMAGE,
+                   swc_time_nsec() - start - upload_time);
+    start = swc_time_nsec();
+    swc_upload_wait();
+    upload_time += swc_time_nsec() - start;
+    swc_timing_add(&target->timing, SWC_TIMING_UPLOAD, upload_time);
+    /* If the attach failed, no frame event will arrive for this screen, so
+     * don't wait for one. */
+    target->flip_pending = update_screen(target);
+    latch_feedback(target);
+
+#if ENABLE_DEBUG
+    if (compositor.frame_allocations)
+    {
+        compositor.allocations += compositor.frame_allocations;
+        DEBUG("Region storage allocated %u times this frame (%llu total)\n",
+              compositor.frame_allocations,
+              (unsigned long long) compositor.allocations);
+    }
+#endif
 
-    /* XXX: Should assert that all damage was covered by some output */
-    pixman_region32_clear(&compositor.damage);
-    compositor.pending_flips |= updates;
-    compositor.scheduled_updates &= ~updates;
+    target->scheduled = false;
     compositor.updating = false;
 }
 
+static bool view_contains_point(struct view * view, int32_t x, int32_t y)
+{
+    return swc_rectangle_contains_point(&view->base.geometry, x, y)
+        && pixman_region32_contains_point(&view->surface->state.input,
+                                          x - view->base.geometry.x,
+                                          y - view->base.geometry.y, NULL);
+}
+
 bool handle_motion(struct swc_pointer * pointer, uint32_t time)
 {
-    struct view * view;
-    struct swc_surface * surface = NULL;
+    struct view * view = NULL;
+    struct swc_grid_cell * cell;
+    struct swc_grid_entry ** entry;
     int32_t x, y;
 
-    wl_list_for_each(view, &compositor.views, link)
+    x = wl_fixed_to_int(pointer->x);
+    y = wl_fixed_to_int(pointer->y);
+    cell = swc_grid_get_cell(&compositor.grid, x, y);
+
+    /* Only the views overlapping the pointer's cell need to be considered.
+     * They are sorted from top to bottom, so the first hit is the one. */
+    wl_array_for_each(entry, &cell->entries)
     {
-        x = wl_fixed_to_int(pointer->x);
-        y = wl_fixed_to_int(pointer->y);
+        struct view * candidate
+            = CONTAINER_OF(*entry, typeof(*candidate), grid_entry);
 
-        if (swc_rectangle_contains_point(&view->base.geometry, x, y)
-            && pixman_region32_contains_point(&view->surface->state.input,
-                                              x - view->base.geometry.x,
-                                              y - view->base.geometry.y, NULL))
+        if (view_contains_point(candidate, x, y))
         {
-            surface = view->surface;
+            view = candidate;
             break;
         }
     }
 
-    swc_pointer_set_focus(pointer, surface);
+    swc_pointer_set_focus(pointer, view ? view->surface : NULL);
+
+    return false;
+}
+
+/* Benchmarking {{{ */
+
+void swc_compositor_calculate_damage()
+{
+    calculate_damage();
+}
+
+void swc_compositor_reset_damage()
+{
+    struct screen * screen;
+    struct target * target;
+
+    wl_list_for_each(screen, &swc.screens, link)
+    {
+        if ((target = target_get(screen)))
+            accumulator_reset(&target->damage);
+    }
+}
+
+void swc_compositor_repaint(struct screen * screen, pixman_region32_t * damage,
+                            pixman_region32_t * base_damage)
+{
+    struct target * target;
+
+    if ((target = target_get(screen)))
+        renderer_repaint(target, damage, base_damage, &compositor.views);
+}
+
+unsigned swc_compositor_count_clip_rects()
+{
+    struct view * view;
+    unsigned count = 0;
+
+    wl_list_for_each(view, &compositor.views, link)
+        count += pixman_region32_n_rects(&view->clip);
+
+    return count;
+}
+
+#if ENABLE_DEBUG
+uint32_t swc_compositor_take_allocations()
+{
+    uint32_t allocations = compositor.frame_allocations;
+
+    compositor.frame_allocations = 0;
+
+    return allocations;
+}
+#endif
+
+/* }}} */
+
+EXPORT
+void swc_print_frame_timing()
+{
+    struct screen * screen;
+    struct target * target;
+
+    wl_list_for_each(screen, &swc.screens, link)
+    {
+        if (!(target = target_get(screen)))
+            continue;
+
+        fprintf(stderr, "Frame timing for screen %u:\n", screen->id);
+        swc_timing_print(&target->timing, stderr);
+    }
+}
+
+EXPORT
+void swc_reset_frame_timing()
+{
+    struct screen * screen;
+    struct target * target;
+
+    wl_list_for_each(screen, &swc.screens, link)
+    {
+        if ((target = target_get(screen)))
+            swc_timing_initialize(&target->timing);
+    }
+}
+
+EXPORT
+bool swc_write_frame_timing(const char * path)
+{
+    struct screen * screen;
+    struct target * target;
+    char * temporary;
+    FILE * file;
+    bool first = true;
+
+    /* The file is written under another name and then moved into place, so
+     * that readers never see it partially written. */
+    if (asprintf(&temporary, "%s.tmp", path) == -1)
+        goto error0;
+
+    if (!(file = fopen(temporary, "w")))
+        goto error1;
+
+    fputs("{ \"screens\": [", file);
+
+    wl_list_for_each(screen, &swc.screens, link)
+    {
+        if (!(target = target_get(screen)))
+            continue;
+
+        fprintf(file, "%s\n\t{ \"id\": %u, \"timing\": ",
+                first ? "" : ",", screen->id);
+        swc_timing_print_json(&target->timing, file);
+        fputs(" }", file);
+        first = false;
+    }
+
+    fputs("\n] }\n", file);
+
+    if (fclose(file) != 0 || rename(temporary, path) != 0)
+        goto error2;
 
+    free(temporary);
+
+    return true;
+
+  error2:
+    unlink(temporary);
+  error1:
+    free(temporary);
+  error0:
+    WARNING("Could not write frame timing to %s\n", path);
     return false;
 }
 
@@ -805,6 +2275,7 @@ static void handle_launch_event(struct wl_listener * listener, void * data)
 {
     struct swc_event * event = data;
     struct screen * screen;
+    struct target * target;
 
     switch (event->type)
     {
@@ -816,7 +2287,11 @@ static void handle_launch_event(struct wl_listener * listener, void * data)
             break;
         case SWC_LAUNCH_EVENT_DEACTIVATED:
             compositor.active = false;
-            compositor.scheduled_updates = 0;
+            wl_list_for_each(screen, &swc.screens, link)
+            {
+                if ((target = target_get(screen)))
+                    target->scheduled = false;
+            }
             break;
     }
 }
@@ -875,20 +2350,59 @@ bool swc_compositor_initialize()
 {
     struct screen * screen;
     uint32_t keysym;
+    const char * repaint_window, * render_buffers;
 
     compositor.global = wl_global_create
         (swc.display, &wl_compositor_interface, 3, NULL, &bind_compositor);
 
     if (!compositor.global)
-        return false;
+        goto error0;
+
+    if (!swc_upload_initialize())
+        goto error1;
+
+    compositor.throttle_timer = wl_event_loop_add_timer
+        (swc.event_loop, &handle_throttle_timer, NULL);
 
-    compositor.scheduled_updates = 0;
-    compositor.pending_flips = 0;
+    if (!compositor.throttle_timer)
+        goto error2;
+
+    compositor.throttle_armed = false;
     compositor.active = true;
+
+    if ((repaint_window = getenv("SWC_REPAINT_WINDOW")))
+        compositor.repaint_window = strtoul(repaint_window, NULL, 10);
+    else
+        compositor.repaint_window = 0;
+
+    if ((render_buffers = getenv("SWC_RENDER_BUFFERS")))
+    {
+        compositor.render_buffers
+            = strtoul(render_buffers, NULL, 10) >= 3 ? 3 : 2;
+    }
+    else
+        compositor.render_buffers = 2;
+
     compositor.updating = false;
-    pixman_region32_init(&compositor.damage);
-    pixman_region32_init(&compositor.opaque);
+    accumulator_initialize(&compositor.opaque);
+    accumulator_initialize(&compositor.above);
+    wl_array_init(&compositor.borders);
+    wl_array_init(&compositor.commands);
+    compositor.num_commands = 0;
+    pixman_region32_init(&compositor.scratch.empty);
+    pixman_region32_init(&compositor.scratch.opaque);
+    pixman_region32_init(&compositor.scratch.damage);
+    pixman_region32_init(&compositor.scratch.border);
+    pixman_region32_init(&compositor.scratch.below);
+    pixman_region32_init(&compositor.scratch.base);
+    pixman_region32_init(&compositor.scratch.buffer);
+#if ENABLE_DEBUG
+    compositor.frame_allocations = 0;
+    compositor.allocations = 0;
+#endif
     wl_list_init(&compositor.views);
+    swc_grid_initialize(&compositor.grid);
+    compositor.next_order = 0;
     wl_signal_add(&swc.launch->event_signal, &launch_listener);
 
     wl_list_for_each(screen, &swc.screens, link)
@@ -905,14 +2419,39 @@ bool swc_compositor_initialize()
                         &handle_switch_vt, NULL);
     }
 
-
     return true;
+
+  error2:
+    swc_upload_finalize();
+  error1:
+    wl_global_destroy(compositor.global);
+  error0:
+    return false;
 }
 
 void swc_compositor_finalize()
 {
-    pixman_region32_fini(&compositor.damage);
-    pixman_region32_fini(&compositor.opaque);
+    struct border_batch * batch;
+    struct render_command * command;
+
+    accumulator_finalize(&compositor.opaque);
+    accumulator_finalize(&compositor.above);
+    wl_array_for_each(batch, &compositor.borders)
+        accumulator_finalize(&batch->region);
+    wl_array_release(&compositor.borders);
+    wl_array_for_each(command, &compositor.commands)
+        pixman_region32_fini(&command->region);
+    wl_array_release(&compositor.commands);
+    pixman_region32_fini(&compositor.scratch.empty);
+    pixman_region32_fini(&compositor.scratch.opaque);
+    pixman_region32_fini(&compositor.scratch.damage);
+    pixman_region32_fini(&compositor.scratch.border);
+    pixman_region32_fini(&compositor.scratch.below);
+    pixman_region32_fini(&compositor.scratch.base);
+    pixman_region32_fini(&compositor.scratch.buffer);
+    swc_grid_finalize(&compositor.grid);
+    wl_event_source_remove(compositor.throttle_timer);
+    swc_upload_finalize();
     wl_global_destroy(compositor.global);
 }
 
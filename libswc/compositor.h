@@ -25,7 +25,9 @@
 #define SWC_COMPOSITOR_H
 
 #include <stdbool.h>
+#include <pixman.h>
 
+struct screen;
 struct swc_surface;
 
 struct swc_compositor
@@ -41,10 +43,44 @@ bool swc_compositor_remove_surface(struct swc_surface * surface);
 
 void swc_compositor_surface_show(struct swc_surface * surface);
 void swc_compositor_surface_hide(struct swc_surface * surface);
+
+/**
+ * Restack the views of the tree of subsurfaces containing a surface, after its
+ * stacking order changed or a subsurface was added to it.
+ */
+void swc_compositor_surface_restack(struct swc_surface * surface);
 void swc_compositor_surface_set_border_color(struct swc_surface * surface,
                                              uint32_t color);
 void swc_compositor_surface_set_border_width(struct swc_surface * surface,
                                              uint32_t width);
 
+/* These let bench/swc-damage-bench drive the compositor without a display
+ * device or renderer. They are not part of the library's interface. */
+
+void swc_compositor_calculate_damage();
+
+/**
+ * Discard the damage accumulated for every screen.
+ */
+void swc_compositor_reset_damage();
+
+/**
+ * Render the views into a screen's current buffer, without flipping it.
+ */
+void swc_compositor_repaint(struct screen * screen, pixman_region32_t * damage,
+                            pixman_region32_t * base_damage);
+
+/**
+ * Returns the total number of rectangles in the clip regions of the views.
+ */
+unsigned swc_compositor_count_clip_rects();
+
+#if ENABLE_DEBUG
+/**
+ * Returns the number of region allocations since the last call.
+ */
+uint32_t swc_compositor_take_allocations();
+#endif
+
 #endif
 
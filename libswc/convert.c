@@ -0,0 +1,639 @@
+/* swc: libswc/convert.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "convert.h"
+#include "util.h"
+
+#include <wayland-server.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+# define HAVE_X86 1
+# include <immintrin.h>
+#endif
+
+#ifdef __ARM_NEON
+# include <arm_neon.h>
+#endif
+
+/* The conversion kernels for each source format. Each converts a span of
+ * width pixels, starting at pixel x for those that need it. */
+struct kernels
+{
+    const char * name;
+
+    void (* swap_rb)(uint32_t * dst, const uint32_t * src, uint32_t width,
+                     uint32_t alpha);
+    void (* rgb565)(uint32_t * dst, const uint16_t * src, uint32_t width);
+    void (* xrgb2101010)(uint32_t * dst, const uint32_t * src,
+                         uint32_t width);
+    void (* yuyv)(uint32_t * dst, const uint8_t * src, uint32_t x,
+                  uint32_t width);
+    void (* nv12)(uint32_t * dst, const uint8_t * luma, const uint8_t * chroma,
+                  uint32_t x, uint32_t width);
+};
+
+static struct kernels kernels;
+
+/* Generic kernels {{{ */
+
+static inline uint32_t swap_rb_pixel(uint32_t pixel, uint32_t alpha)
+{
+    return (pixel & 0xff00ff00) | (pixel >> 16 & 0xff) | (pixel & 0xff) << 16
+        | alpha;
+}
+
+static inline uint32_t rgb565_pixel(uint16_t pixel)
+{
+    uint32_t r = pixel >> 11, g = pixel >> 5 & 0x3f, b = pixel & 0x1f;
+
+    r = r << 3 | r >> 2;
+    g = g << 2 | g >> 4;
+    b = b << 3 | b >> 2;
+
+    return 0xff000000 | r << 16 | g << 8 | b;
+}
+
+static inline uint32_t xrgb2101010_pixel(uint32_t pixel)
+{
+    return 0xff000000 | (pixel >> 6 & 0xff0000) | (pixel >> 4 & 0xff00)
+        | (pixel >> 2 & 0xff);
+}
+
+static inline uint8_t clamp(int32_t value)
+{
+    return value < 0 ? 0 : value > 255 ? 255 : value;
+}
+
+/* ITU-R BT.601, limited range. */
+static inline uint32_t yuv_pixel(int32_t y, int32_t u, int32_t v)
+{
+    int32_t c = y - 16, d = u - 128, e = v - 128;
+
+    return 0xff000000
+        | clamp((298 * c + 409 * e + 128) >> 8) << 16
+        | clamp((298 * c - 100 * d - 208 * e + 128) >> 8) << 8
+        | clamp((298 * c + 516 * d + 128) >> 8);
+}
+
+static void swap_rb_generic(uint32_t * dst, const uint32_t * src,
+                            uint32_t width, uint32_t alpha)
+{
+    while (width--)
+        *dst++ = swap_rb_pixel(*src++, alpha);
+}
+
+static void rgb565_generic(uint32_t * dst, const uint16_t * src,
+                           uint32_t width)
+{
+    while (width--)
+        *dst++ = rgb565_pixel(*src++);
+}
+
+static void xrgb2101010_generic(uint32_t * dst, const uint32_t * src,
+                                uint32_t width)
+{
+    while (width--)
+        *dst++ = xrgb2101010_pixel(*src++);
+}
+
+static void yuyv_generic(uint32_t * dst, const uint8_t * src,
+                         uint32_t x, uint32_t width)
+{
+    const uint8_t * pair;
+
+    for (; width > 0; --width, ++x)
+    {
+        pair = src + (x & ~1) * 2;
+        *dst++ = yuv_pixel(pair[(x & 1) * 2], pair[1], pair[3]);
+    }
+}
+
+static void nv12_generic(uint32_t * dst, const uint8_t * luma,
+                         const uint8_t * chroma, uint32_t x, uint32_t width)
+{
+    for (; width > 0; --width, ++x)
+        *dst++ = yuv_pixel(luma[x], chroma[x & ~1], chroma[x | 1]);
+}
+
+static const struct kernels generic_kernels = {
+    .name = "generic",
+    .swap_rb = &swap_rb_generic,
+    .rgb565 = &rgb565_generic,
+    .xrgb2101010 = &xrgb2101010_generic,
+    .yuyv = &yuyv_generic,
+    .nv12 = &nv12_generic
+};
+
+/* }}} */
+
+#ifdef HAVE_X86
+
+/* SSE2 kernels {{{ */
+
+#define SSE2 __attribute__((target("sse2")))
+
+/* Packs two 16-bit values into each 32-bit lane, for use with madd. */
+#define PAIR(a, b) _mm_set1_epi32((int32_t) ((uint32_t) (uint16_t) (b) << 16 \
+                                             | (uint16_t) (a)))
+
+static inline SSE2 __m128i swap_rb_sse2_4(__m128i pixels, __m128i alpha)
+{
+    const __m128i ag = _mm_set1_epi32(0xff00ff00), b = _mm_set1_epi32(0xff);
+
+    return _mm_or_si128
+        (_mm_or_si128(_mm_and_si128(pixels, ag), alpha),
+         _mm_or_si128(_mm_and_si128(_mm_srli_epi32(pixels, 16), b),
+                      _mm_slli_epi32(_mm_and_si128(pixels, b), 16)));
+}
+
+static SSE2 void swap_rb_sse2(uint32_t * dst, const uint32_t * src,
+                              uint32_t width, uint32_t alpha)
+{
+    const __m128i alpha_mask = _mm_set1_epi32(alpha);
+    __m128i pixels;
+
+    for (; width >= 4; width -= 4, src += 4, dst += 4)
+    {
+        pixels = _mm_loadu_si128((const __m128i *) src);
+        _mm_storeu_si128((__m128i *) dst, swap_rb_sse2_4(pixels, alpha_mask));
+    }
+
+    swap_rb_generic(dst, src, width, alpha);
+}
+
+/* Expands 4 RGB565 pixels, one in each 32-bit lane. */
+static inline SSE2 __m128i rgb565_sse2_4(__m128i pixels)
+{
+    const __m128i mask5 = _mm_set1_epi32(0x1f), mask6 = _mm_set1_epi32(0x3f);
+    __m128i r, g, b;
+
+    r = _mm_srli_epi32(pixels, 11);
+    g = _mm_and_si128(_mm_srli_epi32(pixels, 5), mask6);
+    b = _mm_and_si128(pixels, mask5);
+    r = _mm_or_si128(_mm_slli_epi32(r, 3), _mm_srli_epi32(r, 2));
+    g = _mm_or_si128(_mm_slli_epi32(g, 2), _mm_srli_epi32(g, 4));
+    b = _mm_or_si128(_mm_slli_epi32(b, 3), _mm_srli_epi32(b, 2));
+
+    return _mm_or_si128(_mm_or_si128(_mm_set1_epi32(0xff000000),
+                                     _mm_slli_epi32(r, 16)),
+                        _mm_or_si128(_mm_slli_epi32(g, 8), b));
+}
+
+static SSE2 void rgb565_sse2(uint32_t * dst, const uint16_t * src,
+                             uint32_t width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i pixels;
+
+    for (; width >= 8; width -= 8, src += 8, dst += 8)
+    {
+        pixels = _mm_loadu_si128((const __m128i *) src);
+        _mm_storeu_si128((__m128i *) dst,
+                         rgb565_sse2_4(_mm_unpacklo_epi16(pixels, zero)));
+        _mm_storeu_si128((__m128i *) dst + 1,
+                         rgb565_sse2_4(_mm_unpackhi_epi16(pixels, zero)));
+    }
+
+    rgb565_generic(dst, src, width);
+}
+
+static inline SSE2 __m128i xrgb2101010_sse2_4(__m128i pixels)
+{
+    return _mm_or_si128
+        (_mm_or_si128(_mm_set1_epi32(0xff000000),
+                      _mm_and_si128(_mm_srli_epi32(pixels, 6),
+                                    _mm_set1_epi32(0xff0000))),
+         _mm_or_si128(_mm_and_si128(_mm_srli_epi32(pixels, 4),
+                                    _mm_set1_epi32(0xff00)),
+                      _mm_and_si128(_mm_srli_epi32(pixels, 2),
+                                    _mm_set1_epi32(0xff))));
+}
+
+static SSE2 void xrgb2101010_sse2(uint32_t * dst, const uint32_t * src,
+                                  uint32_t width)
+{
+    __m128i pixels;
+
+    for (; width >= 4; width -= 4, src += 4, dst += 4)
+    {
+        pixels = _mm_loadu_si128((const __m128i *) src);
+        _mm_storeu_si128((__m128i *) dst, xrgb2101010_sse2_4(pixels));
+    }
+
+    xrgb2101010_generic(dst, src, width);
+}
+
+/* Computes one 8-bit channel of 8 pixels from (c, x) and (y, 1) pairs. */
+static inline SSE2 __m128i yuv_channel_sse2(__m128i cx_lo, __m128i cx_hi,
+                                            __m128i coefficients,
+                                            __m128i y1_lo, __m128i y1_hi,
+                                            __m128i extra)
+{
+    __m128i lo, hi;
+
+    lo = _mm_add_epi32(_mm_madd_epi16(cx_lo, coefficients),
+                       _mm_madd_epi16(y1_lo, extra));
+    hi = _mm_add_epi32(_mm_madd_epi16(cx_hi, coefficients),
+                       _mm_madd_epi16(y1_hi, extra));
+    lo = _mm_srai_epi32(lo, 8);
+    hi = _mm_srai_epi32(hi, 8);
+
+    return _mm_packus_epi16(_mm_packs_epi32(lo, hi), _mm_setzero_si128());
+}
+
+/**
+ * Converts 8 pixels given their luma as 16-bit values, and the chroma of the
+ * 4 pixel pairs as alternating 16-bit U and V values.
+ */
+static inline SSE2 void yuv_sse2_8(uint32_t * dst, __m128i y, __m128i uv)
+{
+    const __m128i low = _mm_set1_epi32(0xffff), one = _mm_set1_epi16(1);
+    __m128i u, v, c, d, e, cd_lo, cd_hi, ce_lo, ce_hi, e1_lo, e1_hi,
+            one_lo, one_hi, r, g, b, bg, ra;
+
+    /* Duplicate the chroma of each pair to both of its pixels. */
+    u = _mm_or_si128(_mm_and_si128(uv, low), _mm_slli_epi32(uv, 16));
+    v = _mm_or_si128(_mm_srli_epi32(uv, 16), _mm_andnot_si128(low, uv));
+
+    c = _mm_sub_epi16(y, _mm_set1_epi16(16));
+    d = _mm_sub_epi16(u, _mm_set1_epi16(128));
+    e = _mm_sub_epi16(v, _mm_set1_epi16(128));
+
+    cd_lo = _mm_unpacklo_epi16(c, d);
+    cd_hi = _mm_unpackhi_epi16(c, d);
+    ce_lo = _mm_unpacklo_epi16(c, e);
+    ce_hi = _mm_unpackhi_epi16(c, e);
+    e1_lo = _mm_unpacklo_epi16(e, one);
+    e1_hi = _mm_unpackhi_epi16(e, one);
+    one_lo = _mm_unpacklo_epi16(one, one);
+    one_hi = one_lo;
+
+    r = yuv_channel_sse2(ce_lo, ce_hi, PAIR(298, 409),
+                         one_lo, one_hi, PAIR(64, 64));
+    g = yuv_channel_sse2(cd_lo, cd_hi, PAIR(298, -100),
+                         e1_lo, e1_hi, PAIR(-208, 128));
+    b = yuv_channel_sse2(cd_lo, cd_hi, PAIR(298, 516),
+                         one_lo, one_hi, PAIR(64, 64));
+
+    bg = _mm_unpacklo_epi8(b, g);
+    ra = _mm_unpacklo_epi8(r, _mm_set1_epi8(0xff));
+    _mm_storeu_si128((__m128i *) dst, _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128((__m128i *) dst + 1, _mm_unpackhi_epi16(bg, ra));
+}
+
+static SSE2 void yuyv_sse2(uint32_t * dst, const uint8_t * src,
+                           uint32_t x, uint32_t width)
+{
+    const __m128i zero = _mm_setzero_si128(), low = _mm_set1_epi32(0xffff);
+    __m128i pixels, lo, hi, y, uv;
+
+    /* Start on a pixel pair. */
+    if (x & 1 && width > 0)
+    {
+        yuyv_generic(dst++, src, x++, 1);
+        --width;
+    }
+
+    for (; width >= 8; width -= 8, x += 8, dst += 8)
+    {
+        pixels = _mm_loadu_si128((const __m128i *) (src + x * 2));
+        lo = _mm_unpacklo_epi8(pixels, zero);
+        hi = _mm_unpackhi_epi8(pixels, zero);
+        y = _mm_packs_epi32(_mm_and_si128(lo, low), _mm_and_si128(hi, low));
+        uv = _mm_packs_epi32(_mm_srli_epi32(lo, 16), _mm_srli_epi32(hi, 16));
+        yuv_sse2_8(dst, y, uv);
+    }
+
+    yuyv_generic(dst, src, x, width);
+}
+
+static SSE2 void nv12_sse2(uint32_t * dst, const uint8_t * luma,
+                           const uint8_t * chroma, uint32_t x, uint32_t width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i y, uv;
+
+    if (x & 1 && width > 0)
+    {
+        nv12_generic(dst++, luma, chroma, x++, 1);
+        --width;
+    }
+
+    for (; width >= 8; width -= 8, x += 8, dst += 8)
+    {
+        y = _mm_unpacklo_epi8
+            (_mm_loadl_epi64((const __m128i *) (luma + x)), zero);
+        uv = _mm_unpacklo_epi8
+            (_mm_loadl_epi64((const __m128i *) (chroma + x)), zero);
+        yuv_sse2_8(dst, y, uv);
+    }
+
+    nv12_generic(dst, luma, chroma, x, width);
+}
+
+static const struct kernels sse2_kernels = {
+    .name = "SSE2",
+    .swap_rb = &swap_rb_sse2,
+    .rgb565 = &rgb565_sse2,
+    .xrgb2101010 = &xrgb2101010_sse2,
+    .yuyv = &yuyv_sse2,
+    .nv12 = &nv12_sse2
+};
+
+/* }}} */
+
+/* AVX2 kernels {{{ */
+
+#define AVX2 __attribute__((target("avx2")))
+
+static AVX2 void swap_rb_avx2(uint32_t * dst, const uint32_t * src,
+                              uint32_t width, uint32_t alpha)
+{
+    const __m256i ag = _mm256_set1_epi32(0xff00ff00),
+                  b = _mm256_set1_epi32(0xff),
+                  alpha_mask = _mm256_set1_epi32(alpha);
+    __m256i pixels;
+
+    for (; width >= 8; width -= 8, src += 8, dst += 8)
+    {
+        pixels = _mm256_loadu_si256((const __m256i *) src);
+        pixels = _mm256_or_si256
+            (_mm256_or_si256(_mm256_and_si256(pixels, ag), alpha_mask),
+             _mm256_or_si256
+                (_mm256_and_si256(_mm256_srli_epi32(pixels, 16), b),
+                 _mm256_slli_epi32(_mm256_and_si256(pixels, b), 16)));
+        _mm256_storeu_si256((__m256i *) dst, pixels);
+    }
+
+    swap_rb_sse2(dst, src, width, alpha);
+}
+
+static AVX2 void rgb565_avx2(uint32_t * dst, const uint16_t * src,
+                             uint32_t width)
+{
+    const __m256i mask5 = _mm256_set1_epi32(0x1f),
+                  mask6 = _mm256_set1_epi32(0x3f),
+                  alpha = _mm256_set1_epi32(0xff000000);
+    __m256i pixels, r, g, b;
+
+    for (; width >= 8; width -= 8, src += 8, dst += 8)
+    {
+        pixels = _mm256_cvtepu16_epi32
+            (_mm_loadu_si128((const __m128i *) src));
+        r = _mm256_srli_epi32(pixels, 11);
+        g = _mm256_and_si256(_mm256_srli_epi32(pixels, 5), mask6);
+        b = _mm256_and_si256(pixels, mask5);
+        r = _mm256_or_si256(_mm256_slli_epi32(r, 3), _mm256_srli_epi32(r, 2));
+        g = _mm256_or_si256(_mm256_slli_epi32(g, 2), _mm256_srli_epi32(g, 4));
+        b = _mm256_or_si256(_mm256_slli_epi32(b, 3), _mm256_srli_epi32(b, 2));
+        pixels = _mm256_or_si256
+            (_mm256_or_si256(alpha, _mm256_slli_epi32(r, 16)),
+             _mm256_or_si256(_mm256_slli_epi32(g, 8), b));
+        _mm256_storeu_si256((__m256i *) dst, pixels);
+    }
+
+    rgb565_sse2(dst, src, width);
+}
+
+static AVX2 void xrgb2101010_avx2(uint32_t * dst, const uint32_t * src,
+                                  uint32_t width)
+{
+    const __m256i alpha = _mm256_set1_epi32(0xff000000),
+                  r = _mm256_set1_epi32(0xff0000),
+                  g = _mm256_set1_epi32(0xff00),
+                  b = _mm256_set1_epi32(0xff);
+    __m256i pixels;
+
+    for (; width >= 8; width -= 8, src += 8, dst += 8)
+    {
+        pixels = _mm256_loadu_si256((const __m256i *) src);
+        pixels = _mm256_or_si256
+            (_mm256_or_si256(alpha, _mm256_and_si256
+                                (_mm256_srli_epi32(pixels, 6), r)),
+             _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(pixels, 4), g),
+                             _mm256_and_si256(_mm256_srli_epi32(pixels, 2), b)));
+        _mm256_storeu_si256((__m256i *) dst, pixels);
+    }
+
+    xrgb2101010_sse2(dst, src, width);
+}
+
+static const struct kernels avx2_kernels = {
+    .name = "AVX2",
+    .swap_rb = &swap_rb_avx2,
+    .rgb565 = &rgb565_avx2,
+    .xrgb2101010 = &xrgb2101010_avx2,
+    /* The YUV kernels are bound by the chroma shuffles rather than the vector
+     * width, so they use SSE2. */
+    .yuyv = &yuyv_sse2,
+    .nv12 = &nv12_sse2
+};
+
+/* }}} */
+
+#endif
+
+#ifdef __ARM_NEON
+
+/* NEON kernels {{{ */
+
+static void swap_rb_neon(uint32_t * dst, const uint32_t * src,
+                         uint32_t width, uint32_t alpha)
+{
+    uint8x16x4_t pixels;
+    uint8x16_t r;
+
+    for (; width >= 16; width -= 16, src += 16, dst += 16)
+    {
+        pixels = vld4q_u8((const uint8_t *) src);
+        r = pixels.val[0];
+        pixels.val[0] = pixels.val[2];
+        pixels.val[2] = r;
+
+        if (alpha)
+            pixels.val[3] = vdupq_n_u8(0xff);
+
+        vst4q_u8((uint8_t *) dst, pixels);
+    }
+
+    swap_rb_generic(dst, src, width, alpha);
+}
+
+static void rgb565_neon(uint32_t * dst, const uint16_t * src, uint32_t width)
+{
+    uint16x8_t pixels, r, g, b;
+    uint8x8x4_t result;
+
+    result.val[3] = vdup_n_u8(0xff);
+
+    for (; width >= 8; width -= 8, src += 8, dst += 8)
+    {
+        pixels = vld1q_u16(src);
+        r = vshrq_n_u16(pixels, 11);
+        g = vandq_u16(vshrq_n_u16(pixels, 5), vdupq_n_u16(0x3f));
+        b = vandq_u16(pixels, vdupq_n_u16(0x1f));
+        result.val[2] = vmovn_u16(vorrq_u16(vshlq_n_u16(r, 3),
+                                            vshrq_n_u16(r, 2)));
+        result.val[1] = vmovn_u16(vorrq_u16(vshlq_n_u16(g, 2),
+                                            vshrq_n_u16(g, 4)));
+        result.val[0] = vmovn_u16(vorrq_u16(vshlq_n_u16(b, 3),
+                                            vshrq_n_u16(b, 2)));
+        vst4_u8((uint8_t *) dst, result);
+    }
+
+    rgb565_generic(dst, src, width);
+}
+
+static void xrgb2101010_neon(uint32_t * dst, const uint32_t * src,
+                             uint32_t width)
+{
+    uint32x4_t pixels;
+
+    for (; width >= 4; width -= 4, src += 4, dst += 4)
+    {
+        pixels = vld1q_u32(src);
+        pixels = vorrq_u32
+            (vorrq_u32(vdupq_n_u32(0xff000000),
+                       vandq_u32(vshrq_n_u32(pixels, 6),
+                                 vdupq_n_u32(0xff0000))),
+             vorrq_u32(vandq_u32(vshrq_n_u32(pixels, 4), vdupq_n_u32(0xff00)),
+                       vandq_u32(vshrq_n_u32(pixels, 2), vdupq_n_u32(0xff))));
+        vst1q_u32(dst, pixels);
+    }
+
+    xrgb2101010_generic(dst, src, width);
+}
+
+static const struct kernels neon_kernels = {
+    .name = "NEON",
+    .swap_rb = &swap_rb_neon,
+    .rgb565 = &rgb565_neon,
+    .xrgb2101010 = &xrgb2101010_neon,
+    .yuyv = &yuyv_generic,
+    .nv12 = &nv12_generic
+};
+
+/* }}} */
+
+#endif
+
+void swc_convert_initialize()
+{
+    kernels = generic_kernels;
+
+#ifdef HAVE_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        kernels = avx2_kernels;
+    else if (__builtin_cpu_supports("sse2"))
+        kernels = sse2_kernels;
+#endif
+
+#ifdef __ARM_NEON
+    kernels = neon_kernels;
+#endif
+
+    DEBUG("Using %s pixel conversion kernels\n", kernels.name);
+}
+
+bool swc_convert_is_supported(uint32_t format)
+{
+    switch (format)
+    {
+        case WL_SHM_FORMAT_XBGR8888:
+        case WL_SHM_FORMAT_ABGR8888:
+        case WL_SHM_FORMAT_RGB565:
+        case WL_SHM_FORMAT_XRGB2101010:
+        case WL_SHM_FORMAT_YUYV:
+        case WL_SHM_FORMAT_NV12:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint32_t swc_convert_target_format(uint32_t format)
+{
+    return format == WL_SHM_FORMAT_ABGR8888 ? WL_SHM_FORMAT_ARGB8888
+                                            : WL_SHM_FORMAT_XRGB8888;
+}
+
+uint64_t swc_convert_size(uint32_t format, uint32_t pitch, uint32_t height)
+{
+    uint64_t size = (uint64_t) pitch * height;
+
+    /* The chroma plane has half the rows of the luma plane. */
+    if (format == WL_SHM_FORMAT_NV12)
+        size += (uint64_t) pitch * ((height + 1) / 2);
+
+    return size;
+}
+
+uint64_t swc_convert_min_pitch(uint32_t format, uint32_t width)
+{
+    switch (format)
+    {
+        case WL_SHM_FORMAT_RGB565:
+        case WL_SHM_FORMAT_YUYV:
+            return (uint64_t) (width + (width & 1)) * 2;
+        case WL_SHM_FORMAT_NV12:
+            return width + (width & 1);
+        default:
+            return (uint64_t) width * 4;
+    }
+}
+
+void swc_convert_row(const struct swc_convert_source * source, uint32_t * dst,
+                     uint32_t x, uint32_t y, uint32_t width)
+{
+    const uint8_t * row
+        = (const uint8_t *) source->data + (size_t) y * source->pitch,
+                  * chroma;
+
+    switch (source->format)
+    {
+        case WL_SHM_FORMAT_XBGR8888:
+            kernels.swap_rb(dst, (const uint32_t *) row + x, width,
+                            0xff000000);
+            break;
+        case WL_SHM_FORMAT_ABGR8888:
+            kernels.swap_rb(dst, (const uint32_t *) row + x, width, 0);
+            break;
+        case WL_SHM_FORMAT_RGB565:
+            kernels.rgb565(dst, (const uint16_t *) row + x, width);
+            break;
+        case WL_SHM_FORMAT_XRGB2101010:
+            kernels.xrgb2101010(dst, (const uint32_t *) row + x, width);
+            break;
+        case WL_SHM_FORMAT_YUYV:
+            kernels.yuyv(dst, row, x, width);
+            break;
+        case WL_SHM_FORMAT_NV12:
+            chroma = (const uint8_t *) source->data
+                + (size_t) source->pitch * (source->height + y / 2);
+            kernels.nv12(dst, row, chroma, x, width);
+            break;
+    }
+}
+
@@ -0,0 +1,75 @@
+/* swc: libswc/convert.h
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SWC_CONVERT_H
+#define SWC_CONVERT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Pixel data in a format that the renderers can't use directly, which must be
+ * converted to XRGB8888 or ARGB8888 first.
+ *
+ * Formats are given as wl_shm formats. The chroma plane of NV12 data
+ * immediately follows the luma plane, with the same pitch.
+ */
+struct swc_convert_source
+{
+    const void * data;
+    uint32_t format, pitch;
+    uint32_t width, height;
+};
+
+void swc_convert_initialize();
+
+/**
+ * Whether data in the given wl_shm format can be converted.
+ */
+bool swc_convert_is_supported(uint32_t format);
+
+/**
+ * The format (XRGB8888 or ARGB8888) that data in the given wl_shm format is
+ * converted to.
+ */
+uint32_t swc_convert_target_format(uint32_t format);
+
+/**
+ * The number of bytes needed for an image of the given format, height and
+ * pitch.
+ */
+uint64_t swc_convert_size(uint32_t format, uint32_t pitch, uint32_t height);
+
+/**
+ * The minimum pitch of an image of the given format and width.
+ */
+uint64_t swc_convert_min_pitch(uint32_t format, uint32_t width);
+
+/**
+ * Convert a span of width pixels starting at (x, y) in the source.
+ */
+void swc_convert_row(const struct swc_convert_source * source, uint32_t * dst,
+                     uint32_t x, uint32_t y, uint32_t width);
+
+#endif
+
@@ -23,6 +23,7 @@
 
 #include "cursor_plane.h"
 #include "drm.h"
+#include "framebuffer_plane.h"
 #include "internal.h"
 #include "launch.h"
 #include "screen.h"
@@ -42,7 +43,21 @@ static bool attach(struct swc_view * view, struct wld_buffer * buffer)
 {
     struct swc_cursor_plane * plane = CONTAINER_OF(view, typeof(*plane), view);
 
-    if (buffer)
+    /* Headless screens don't display a cursor. */
+    if (plane->framebuffer->headless)
+    {
+        swc_view_set_size_from_buffer(view, buffer);
+        return true;
+    }
+
+    if (plane->atomic)
+    {
+        swc_drm_plane_set(&plane->drm_plane, buffer,
+                          view->geometry.x - plane->origin->x,
+                          view->geometry.y - plane->origin->y);
+        swc_framebuffer_plane_schedule_commit(plane->framebuffer);
+    }
+    else if (buffer)
     {
         union wld_object object;
 
@@ -77,8 +92,20 @@ static bool move(struct swc_view * view, int32_t x, int32_t y)
 {
     struct swc_cursor_plane * plane = CONTAINER_OF(view, typeof(*plane), view);
 
-    if (drmModeMoveCursor(swc.drm->fd, plane->crtc,
-                          x - plane->origin->x, y - plane->origin->y) != 0)
+    if (plane->framebuffer->headless)
+    {
+        swc_view_set_position(view, x, y);
+        return true;
+    }
+
+    if (plane->atomic)
+    {
+        swc_drm_plane_set(&plane->drm_plane, plane->drm_plane.buffer,
+                          x - plane->origin->x, y - plane->origin->y);
+        swc_framebuffer_plane_schedule_commit(plane->framebuffer);
+    }
+    else if (drmModeMoveCursor(swc.drm->fd, plane->crtc,
+                               x - plane->origin->x, y - plane->origin->y) != 0)
     {
         ERROR("Could not move cursor: %s\n", strerror(errno));
         return false;
@@ -110,12 +137,26 @@ static void handle_launch_event(struct wl_listener * listener, void * data)
     }
 }
 
-bool swc_cursor_plane_initialize(struct swc_cursor_plane * plane, uint32_t crtc,
+bool swc_cursor_plane_initialize(struct swc_cursor_plane * plane,
+                                 struct swc_framebuffer_plane * framebuffer,
                                  const struct swc_rectangle * origin)
 {
-    if (drmModeSetCursor(swc.drm->fd, crtc, 0, 0, 0) != 0)
+    uint32_t crtc = framebuffer->crtc, id;
+
+    if (!framebuffer->headless
+        && drmModeSetCursor(swc.drm->fd, crtc, 0, 0, 0) != 0)
+    {
         return false;
+    }
 
+    plane->atomic = framebuffer->atomic
+        && swc_drm_find_plane(crtc, DRM_PLANE_TYPE_CURSOR, &id)
+        && swc_drm_plane_initialize(&plane->drm_plane, id);
+
+    if (plane->atomic)
+        swc_framebuffer_plane_add_plane(framebuffer, &plane->drm_plane);
+
+    plane->framebuffer = framebuffer;
     plane->origin = origin;
     plane->crtc = crtc;
     plane->launch_listener.notify = &handle_launch_event;
@@ -127,6 +168,12 @@ bool swc_cursor_plane_initialize(struct swc_cursor_plane * plane, uint32_t crtc,
 
 void swc_cursor_plane_finalize(struct swc_cursor_plane * plane)
 {
+    if (plane->framebuffer->headless)
+        return;
+
+    if (plane->atomic)
+        swc_drm_plane_finalize(&plane->drm_plane);
+
     drmModeSetCursor(swc.drm->fd, plane->crtc, 0, 0, 0);
 }
 
@@ -24,17 +24,27 @@
 #ifndef SWC_CURSOR_PLANE_H
 #define SWC_CURSOR_PLANE_H
 
+#include "drm.h"
 #include "view.h"
 
+struct swc_framebuffer_plane;
+
 struct swc_cursor_plane
 {
     struct swc_view view;
     const struct swc_rectangle * origin;
     uint32_t crtc;
     struct wl_listener launch_listener;
+
+    /* The framebuffer plane of the CRTC, which commits this plane's state if
+     * atomic is true. */
+    struct swc_framebuffer_plane * framebuffer;
+    bool atomic;
+    struct swc_drm_plane drm_plane;
 };
 
-bool swc_cursor_plane_initialize(struct swc_cursor_plane * plane, uint32_t crtc,
+bool swc_cursor_plane_initialize(struct swc_cursor_plane * plane,
+                                 struct swc_framebuffer_plane * framebuffer,
                                  const struct swc_rectangle * origin);
 
 void swc_cursor_plane_finalize(struct swc_cursor_plane * plane);
@@ -0,0 +1,112 @@
+/* swc: libswc/damage.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "damage.h"
+#include "util.h"
+
+#include <stdlib.h>
+
+#define DEFAULT_MAX_RECTS 64
+#define DEFAULT_COVERAGE 50
+
+/* The number of boxes a region that covers little of its bounding box is
+ * reduced to. */
+#define NUM_BOXES 8
+
+static struct
+{
+    uint32_t max_rects;
+
+    /* In percent of the bounding box. */
+    uint32_t coverage;
+} policy = { DEFAULT_MAX_RECTS, DEFAULT_COVERAGE };
+
+void swc_damage_initialize()
+{
+    const char * string;
+
+    if ((string = getenv("SWC_DAMAGE_MAX_RECTS")))
+        policy.max_rects = strtoul(string, NULL, 10);
+
+    if ((string = getenv("SWC_DAMAGE_COVERAGE")))
+        policy.coverage = strtoul(string, NULL, 10);
+}
+
+static inline uint64_t box_area(const pixman_box32_t * box)
+{
+    return (uint64_t) (box->x2 - box->x1) * (box->y2 - box->y1);
+}
+
+void swc_damage_simplify(pixman_region32_t * region)
+{
+    pixman_box32_t * rects, extents, boxes[NUM_BOXES];
+    unsigned num_boxes = 0;
+    int index, num_rects, group_size, count = 0;
+    uint64_t area = 0;
+
+    rects = pixman_region32_rectangles(region, &num_rects);
+
+    if (policy.max_rects == 0 || num_rects <= (int) policy.max_rects)
+        return;
+
+    extents = *pixman_region32_extents(region);
+
+    for (index = 0; index < num_rects; ++index)
+        area += box_area(&rects[index]);
+
+    if (area * 100 >= box_area(&extents) * policy.coverage)
+    {
+        pixman_region32_fini(region);
+        pixman_region32_init_with_extents(region, &extents);
+        return;
+    }
+
+    /* The rectangles are sorted into bands from top to bottom. Group them so
+     * that no band is split between two boxes, since those would overlap. */
+    group_size = (num_rects + NUM_BOXES - 1) / NUM_BOXES;
+
+    for (index = 0; index < num_rects; ++index)
+    {
+        if (count == 0)
+            boxes[num_boxes++] = rects[index];
+        else
+        {
+            boxes[num_boxes - 1].x1 = MIN(boxes[num_boxes - 1].x1,
+                                          rects[index].x1);
+            boxes[num_boxes - 1].x2 = MAX(boxes[num_boxes - 1].x2,
+                                          rects[index].x2);
+            boxes[num_boxes - 1].y2 = rects[index].y2;
+        }
+
+        if (++count >= group_size && num_boxes < NUM_BOXES
+            && (index + 1 == num_rects
+                || rects[index + 1].y1 != rects[index].y1))
+        {
+            count = 0;
+        }
+    }
+
+    pixman_region32_fini(region);
+    pixman_region32_init_rects(region, boxes, num_boxes);
+}
+
@@ -0,0 +1,47 @@
+/* swc: libswc/damage.h
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SWC_DAMAGE_H
+#define SWC_DAMAGE_H
+
+#include <pixman.h>
+
+/**
+ * Read the damage simplification policy from the environment.
+ *
+ * A region is simplified once it has more than SWC_DAMAGE_MAX_RECTS
+ * rectangles (64 by default, 0 disables simplification). If it covers at
+ * least SWC_DAMAGE_COVERAGE percent of its bounding box (50 by default), it is
+ * replaced by the bounding box. Otherwise, it is replaced by a few boxes, each
+ * bounding a group of adjacent bands of the region.
+ */
+void swc_damage_initialize();
+
+/**
+ * Simplify a damage region according to the policy, so that it covers at
+ * least the same area with a bounded number of rectangles.
+ */
+void swc_damage_simplify(pixman_region32_t * region);
+
+#endif
+
@@ -0,0 +1,887 @@
+/* swc: libswc/dmabuf.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "dmabuf.h"
+#include "drm.h"
+#include "internal.h"
+#include "overlay_plane.h"
+#include "screen.h"
+#include "surface.h"
+#include "util.h"
+#include "view.h"
+#include "wayland_buffer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <libdrm/drm_fourcc.h>
+#include <xf86drm.h>
+#include <wld/wld.h>
+#include <wld/drm.h>
+#include <wayland-server.h>
+#include "protocol/linux-dmabuf-unstable-v1-server-protocol.h"
+
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof(array[0]))
+
+struct buffer_layout
+{
+    struct swc_dmabuf_layout base;
+    struct wld_exporter exporter;
+    struct wld_destructor destructor;
+};
+
+struct params
+{
+    struct wl_resource * resource;
+
+    struct
+    {
+        int fd;
+        uint32_t offset, stride;
+        uint64_t modifier;
+    } planes[4];
+
+    bool used;
+};
+
+/* An entry of the format table shared with clients. */
+struct format_table_entry
+{
+    uint32_t format, padding;
+    uint64_t modifier;
+};
+
+static const struct
+{
+    uint32_t format, num_planes;
+} supported_formats[] = {
+    { DRM_FORMAT_XRGB8888, 1 },
+    { DRM_FORMAT_ARGB8888, 1 },
+    { DRM_FORMAT_NV12, 2 }
+};
+
+/* The formats the renderer can read, which make up the format table. Any
+ * buffer may have to be composited (for example when it is overlapped), so
+ * no others are accepted, even if a plane could scan them out. */
+static const struct format_table_entry renderer_formats[] = {
+    { DRM_FORMAT_XRGB8888, 0, DRM_FORMAT_MOD_INVALID },
+    { DRM_FORMAT_XRGB8888, 0, DRM_FORMAT_MOD_LINEAR },
+    { DRM_FORMAT_ARGB8888, 0, DRM_FORMAT_MOD_INVALID },
+    { DRM_FORMAT_ARGB8888, 0, DRM_FORMAT_MOD_LINEAR }
+};
+
+static struct
+{
+    struct wl_global * global;
+    dev_t device;
+
+    /* The format table is created when the first client binds. */
+    struct
+    {
+        struct wl_array entries;
+        int fd;
+    } table;
+} dmabuf;
+
+/* Buffers {{{ */
+
+static void close_handles(const struct swc_dmabuf_layout * layout,
+                          uint32_t num_handles)
+{
+    uint32_t index, other;
+
+    for (index = 1; index < num_handles; ++index)
+    {
+        /* Planes in the same buffer object share a handle. */
+        for (other = 0; other < index; ++other)
+        {
+            if (layout->handles[other] == layout->handles[index])
+                break;
+        }
+
+        if (other == index)
+            drmCloseBufferHandle(swc.drm->fd, layout->handles[index]);
+    }
+}
+
+static bool layout_export(struct wld_exporter * exporter,
+                          struct wld_buffer * buffer,
+                          uint32_t type, union wld_object * object)
+{
+    struct buffer_layout * layout
+        = CONTAINER_OF(exporter, typeof(*layout), exporter);
+
+    switch (type)
+    {
+        case SWC_DMABUF_OBJECT_LAYOUT:
+            object->ptr = &layout->base;
+            break;
+        default: return false;
+    }
+
+    return true;
+}
+
+static void layout_destroy(struct wld_destructor * destructor)
+{
+    struct buffer_layout * layout
+        = CONTAINER_OF(destructor, typeof(*layout), destructor);
+
+    close_handles(&layout->base, layout->base.num_planes);
+    free(layout);
+}
+
+uint32_t swc_dmabuf_format_planes(uint32_t format)
+{
+    uint32_t index;
+
+    for (index = 0; index < ARRAY_SIZE(supported_formats); ++index)
+    {
+        if (supported_formats[index].format == format)
+            return supported_formats[index].num_planes;
+    }
+
+    return 0;
+}
+
+struct wld_buffer * swc_dmabuf_import
+    (const struct swc_dmabuf_attributes * attributes)
+{
+    struct wld_buffer * buffer;
+    struct swc_dmabuf_layout layout;
+    union wld_object object = { .i = attributes->fds[0] };
+    uint32_t index;
+
+    if (!swc_dmabuf_is_renderable(attributes->format, attributes->num_planes,
+                                  attributes->offsets[0],
+                                  attributes->modifier))
+    {
+        goto error0;
+    }
+
+    /* WLD only knows about the first plane. The layout of the others is kept
+     * alongside the buffer for when it is scanned out. */
+    buffer = wld_import_buffer(swc.drm->context, WLD_DRM_OBJECT_PRIME_FD,
+                               object, attributes->width, attributes->height,
+                               attributes->format, attributes->strides[0]);
+
+    if (!buffer)
+        goto error0;
+
+    if (!wld_export(buffer, WLD_DRM_OBJECT_HANDLE, &object))
+        goto error1;
+
+    layout.num_planes = attributes->num_planes;
+    layout.modifier = attributes->modifier;
+    layout.handles[0] = object.u32;
+
+    for (index = 0; index < attributes->num_planes; ++index)
+    {
+        if (index > 0 && drmPrimeFDToHandle(swc.drm->fd, attributes->fds[index],
+                                            &layout.handles[index]) != 0)
+        {
+            ERROR("Could not import plane %u: %s\n", index, strerror(errno));
+            goto error2;
+        }
+
+        layout.offsets[index] = attributes->offsets[index];
+        layout.strides[index] = attributes->strides[index];
+    }
+
+    if (!swc_dmabuf_set_layout(buffer, &layout))
+        goto error2;
+
+    return buffer;
+
+  error2:
+    close_handles(&layout, index);
+  error1:
+    wld_buffer_unreference(buffer);
+  error0:
+    return NULL;
+}
+
+bool swc_dmabuf_set_layout(struct wld_buffer * buffer,
+                           const struct swc_dmabuf_layout * layout)
+{
+    struct buffer_layout * buffer_layout;
+
+    if (!(buffer_layout = malloc(sizeof *buffer_layout)))
+        return false;
+
+    buffer_layout->base = *layout;
+    buffer_layout->exporter.export = &layout_export;
+    wld_buffer_add_exporter(buffer, &buffer_layout->exporter);
+    buffer_layout->destructor.destroy = &layout_destroy;
+    wld_buffer_add_destructor(buffer, &buffer_layout->destructor);
+
+    return true;
+}
+
+const struct swc_dmabuf_layout * swc_dmabuf_get_layout
+    (struct wld_buffer * buffer)
+{
+    union wld_object object;
+
+    return wld_export(buffer, SWC_DMABUF_OBJECT_LAYOUT, &object)
+        ? object.ptr : NULL;
+}
+
+uint64_t swc_dmabuf_get_modifier(struct wld_buffer * buffer)
+{
+    const struct swc_dmabuf_layout * layout = swc_dmabuf_get_layout(buffer);
+
+    return layout ? layout->modifier : DRM_FORMAT_MOD_INVALID;
+}
+
+bool swc_dmabuf_is_renderable(uint32_t format, uint32_t num_planes,
+                              uint32_t offset, uint64_t modifier)
+{
+    return num_planes == 1 && offset == 0
+        && (modifier == DRM_FORMAT_MOD_INVALID
+            || modifier == DRM_FORMAT_MOD_LINEAR)
+        && (format == WLD_FORMAT_XRGB8888 || format == WLD_FORMAT_ARGB8888);
+}
+
+/* }}} */
+
+/* Format table {{{ */
+
+static int find_entry(uint32_t format, uint64_t modifier)
+{
+    struct format_table_entry * entry;
+    int index = 0;
+
+    wl_array_for_each(entry, &dmabuf.table.entries)
+    {
+        if (entry->format == format && entry->modifier == modifier)
+            return index;
+
+        ++index;
+    }
+
+    return -1;
+}
+
+static bool add_entry(uint32_t format, uint64_t modifier)
+{
+    struct format_table_entry * entry;
+
+    if (find_entry(format, modifier) != -1)
+        return true;
+
+    /* Clients refer to entries with 16-bit indices. */
+    if (dmabuf.table.entries.size / sizeof *entry > UINT16_MAX)
+        return false;
+
+    if (!(entry = wl_array_add(&dmabuf.table.entries, sizeof *entry)))
+        return false;
+
+    entry->format = format;
+    entry->padding = 0;
+    entry->modifier = modifier;
+
+    return true;
+}
+
+static bool create_table()
+{
+    uint32_t index;
+    int fd;
+
+    if (dmabuf.table.fd != -1)
+        return true;
+
+    for (index = 0; index < ARRAY_SIZE(renderer_formats); ++index)
+    {
+        if (!add_entry(renderer_formats[index].format,
+                       renderer_formats[index].modifier))
+        {
+            goto error0;
+        }
+    }
+
+    fd = memfd_create("swc-dmabuf-formats", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+    if (fd == -1)
+    {
+        ERROR("Could not create format table: %s\n", strerror(errno));
+        goto error0;
+    }
+
+    if (write(fd, dmabuf.table.entries.data, dmabuf.table.entries.size)
+        != dmabuf.table.entries.size)
+    {
+        ERROR("Could not write format table: %s\n", strerror(errno));
+        goto error1;
+    }
+
+    /* Clients map the table themselves, so it must never change. */
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW
+                               | F_SEAL_WRITE | F_SEAL_SEAL) != 0)
+    {
+        ERROR("Could not seal format table: %s\n", strerror(errno));
+        goto error1;
+    }
+
+    dmabuf.table.fd = fd;
+
+    return true;
+
+  error1:
+    close(fd);
+  error0:
+    dmabuf.table.entries.size = 0;
+    return false;
+}
+
+/* }}} */
+
+/* Feedback {{{ */
+
+static void destroy(struct wl_client * client, struct wl_resource * resource)
+{
+    wl_resource_destroy(resource);
+}
+
+static const struct zwp_linux_dmabuf_feedback_v1_interface
+    feedback_implementation = {
+    .destroy = &destroy
+};
+
+static void remove_feedback(struct wl_resource * resource)
+{
+    wl_list_remove(wl_resource_get_link(resource));
+}
+
+static void add_index(struct wl_array * indices, int entry)
+{
+    uint16_t * index;
+
+    if (entry == -1)
+        return;
+
+    wl_array_for_each(index, indices)
+    {
+        if (*index == entry)
+            return;
+    }
+
+    if ((index = wl_array_add(indices, sizeof *index)))
+        *index = entry;
+}
+
+static void send_tranche(struct wl_resource * resource,
+                         struct wl_array * indices, uint32_t flags)
+{
+    struct wl_array device = {
+        .size = sizeof dmabuf.device,
+        .alloc = sizeof dmabuf.device,
+        .data = &dmabuf.device
+    };
+
+    zwp_linux_dmabuf_feedback_v1_send_tranche_target_device(resource, &device);
+    zwp_linux_dmabuf_feedback_v1_send_tranche_flags(resource, flags);
+    zwp_linux_dmabuf_feedback_v1_send_tranche_formats(resource, indices);
+    zwp_linux_dmabuf_feedback_v1_send_tranche_done(resource);
+}
+
+/**
+ * Sends the dmabuf parameters for buffers that are scanned out by the given
+ * screens, or just composited if there are none.
+ *
+ * The formats of the overlay planes are preferred while a surface is on one.
+ * Only those the renderer can also read are offered, since the surface may
+ * have to be composited at any time (for example when it is overlapped).
+ *
+ * The renderer only reads linear or implicitly laid out XRGB8888 and
+ * ARGB8888, so the scanout tranche is at most those. Tiled and compressed
+ * modifiers are never offered, even if a plane supports them, so a surface
+ * is only ever scanned out with a buffer the renderer could also draw.
+ */
+static void send_feedback(struct wl_resource * resource, uint32_t screens)
+{
+    struct wl_array device = {
+        .size = sizeof dmabuf.device,
+        .alloc = sizeof dmabuf.device,
+        .data = &dmabuf.device
+    };
+    struct wl_array indices;
+    struct screen * screen;
+    struct swc_overlay_plane * plane;
+    struct swc_drm_format * format;
+    uint32_t index;
+    int entry;
+
+    zwp_linux_dmabuf_feedback_v1_send_format_table
+        (resource, dmabuf.table.fd, dmabuf.table.entries.size);
+    zwp_linux_dmabuf_feedback_v1_send_main_device(resource, &device);
+    wl_array_init(&indices);
+
+    wl_list_for_each(screen, &swc.screens, link)
+    {
+        if (!(screens & screen_mask(screen)))
+            continue;
+
+        wl_list_for_each(plane, &screen->planes.overlays, link)
+        {
+            wl_array_for_each(format, &plane->formats)
+            {
+                entry = find_entry(format->format, format->modifier);
+
+                if (entry != -1)
+                    add_index(&indices, entry);
+            }
+        }
+    }
+
+    if (indices.size > 0)
+    {
+        send_tranche(resource, &indices,
+                     ZWP_LINUX_DMABUF_FEEDBACK_V1_TRANCHE_FLAGS_SCANOUT);
+        indices.size = 0;
+    }
+
+    for (index = 0; index < ARRAY_SIZE(renderer_formats); ++index)
+        add_index(&indices, index);
+
+    send_tranche(resource, &indices, 0);
+    wl_array_release(&indices);
+    zwp_linux_dmabuf_feedback_v1_send_done(resource);
+}
+
+static struct wl_resource * create_feedback(struct wl_client * client,
+                                            struct wl_resource * resource,
+                                            uint32_t id)
+{
+    struct wl_resource * feedback;
+
+    feedback = wl_resource_create(client, &zwp_linux_dmabuf_feedback_v1_interface,
+                                  wl_resource_get_version(resource), id);
+
+    if (!feedback)
+    {
+        wl_resource_post_no_memory(resource);
+        return NULL;
+    }
+
+    wl_resource_set_implementation(feedback, &feedback_implementation,
+                                   NULL, &remove_feedback);
+    wl_list_init(wl_resource_get_link(feedback));
+
+    return feedback;
+}
+
+static uint32_t surface_scanout(struct swc_surface * surface)
+{
+    return surface->view ? surface->view->scanout : 0;
+}
+
+void swc_dmabuf_surface_feedback_changed(struct swc_surface * surface)
+{
+    struct wl_resource * resource;
+
+    wl_list_for_each(resource, &surface->dmabuf_feedbacks, link)
+        send_feedback(resource, surface_scanout(surface));
+}
+
+void swc_dmabuf_surface_destroyed(struct swc_surface * surface)
+{
+    struct wl_resource * resource, * tmp;
+
+    wl_list_for_each_safe(resource, tmp, &surface->dmabuf_feedbacks, link)
+        wl_list_init(wl_resource_get_link(resource));
+}
+
+/* }}} */
+
+/* Buffer parameters {{{ */
+
+static void add(struct wl_client * client, struct wl_resource * resource,
+                int32_t fd, uint32_t plane_index, uint32_t offset,
+                uint32_t stride, uint32_t modifier_hi, uint32_t modifier_lo)
+{
+    struct params * params = wl_resource_get_user_data(resource);
+
+    if (params->used)
+    {
+        wl_resource_post_error(resource,
+                               ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_ALREADY_USED,
+                               "params were already used");
+        goto error0;
+    }
+
+    if (plane_index >= ARRAY_SIZE(params->planes))
+    {
+        wl_resource_post_error(resource,
+                               ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_PLANE_IDX,
+                               "plane index %u is too large", plane_index);
+        goto error0;
+    }
+
+    if (params->planes[plane_index].fd != -1)
+    {
+        wl_resource_post_error(resource,
+                               ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_PLANE_SET,
+                               "plane %u was already set", plane_index);
+        goto error0;
+    }
+
+    params->planes[plane_index].fd = fd;
+    params->planes[plane_index].offset = offset;
+    params->planes[plane_index].stride = stride;
+    params->planes[plane_index].modifier
+        = (uint64_t) modifier_hi << 32 | modifier_lo;
+
+    return;
+
+  error0:
+    close(fd);
+}
+
+/**
+ * Checks the parameters of a new buffer, posting a protocol error if they are
+ * invalid.
+ */
+static bool get_attributes(struct params * params,
+                           int32_t width, int32_t height, uint32_t format,
+                           struct swc_dmabuf_attributes * attributes)
+{
+    struct wl_resource * resource = params->resource;
+    uint32_t index, num_planes;
+    uint64_t modifier = params->planes[0].modifier;
+    off_t size;
+
+    if (params->used)
+    {
+        wl_resource_post_error(resource,
+                               ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_ALREADY_USED,
+                               "params were already used");
+        return false;
+    }
+
+    params->used = true;
+
+    if (!(num_planes = swc_dmabuf_format_planes(format)))
+    {
+        wl_resource_post_error(resource,
+                               ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_INVALID_FORMAT,
+                               "format 0x%08x is not supported", format);
+        return false;
+    }
+
+    for (index = 0; index < ARRAY_SIZE(params->planes); ++index)
+    {
+        if ((params->planes[index].fd != -1) != (index < num_planes))
+        {
+            wl_resource_post_error(resource,
+                                   ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_INCOMPLETE,
+                                   "format 0x%08x needs %u planes",
+                                   format, num_planes);
+            return false;
+        }
+
+        if (index < num_planes && params->planes[index].modifier != modifier)
+        {
+            wl_resource_post_error
+                (resource, ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_INVALID_FORMAT,
+                 "planes have different modifiers");
+            return false;
+        }
+    }
+
+    if (find_entry(format, modifier) == -1)
+    {
+        wl_resource_post_error(resource,
+                               ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_INVALID_FORMAT,
+                               "modifier 0x%016llx is not supported "
+                               "with format 0x%08x",
+                               (unsigned long long) modifier, format);
+        return false;
+    }
+
+    if (width < 1 || height < 1)
+    {
+        wl_resource_post_error
+            (resource, ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_INVALID_DIMENSIONS,
+             "invalid dimensions %dx%d", width, height);
+        return false;
+    }
+
+    for (index = 0; index < num_planes; ++index)
+    {
+        attributes->fds[index] = params->planes[index].fd;
+        attributes->offsets[index] = params->planes[index].offset;
+        attributes->strides[index] = params->planes[index].stride;
+
+        /* Not every kind of DMA-BUF can tell its size. */
+        if ((size = lseek(params->planes[index].fd, 0, SEEK_END)) == -1)
+            continue;
+
+        /* Planes other than the first may be subsampled, so only check that
+         * their first row fits. */
+        if ((uint64_t) params->planes[index].offset
+                + (uint64_t) params->planes[index].stride
+                    * (index == 0 ? height : 1) > (uint64_t) size)
+        {
+            wl_resource_post_error
+                (resource, ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_OUT_OF_BOUNDS,
+                 "plane %u is out of bounds", index);
+            return false;
+        }
+    }
+
+    attributes->width = width;
+    attributes->height = height;
+    attributes->format = format;
+    attributes->num_planes = num_planes;
+    attributes->modifier = modifier;
+
+    return true;
+}
+
+static void create(struct wl_client * client, struct wl_resource * resource,
+                   int32_t width, int32_t height, uint32_t format,
+                   uint32_t flags)
+{
+    struct params * params = wl_resource_get_user_data(resource);
+    struct swc_dmabuf_attributes attributes;
+    struct wld_buffer * buffer;
+    struct wl_resource * buffer_resource;
+
+    if (!get_attributes(params, width, height, format, &attributes))
+        return;
+
+    /* Inverted and interlaced buffers are not supported. */
+    if (flags != 0 || !(buffer = swc_dmabuf_import(&attributes)))
+        goto error0;
+
+    buffer_resource = swc_wayland_buffer_create_resource(client, 0, buffer);
+
+    if (!buffer_resource)
+        goto error1;
+
+    zwp_linux_buffer_params_v1_send_created(resource, buffer_resource);
+
+    return;
+
+  error1:
+    wld_buffer_unreference(buffer);
+  error0:
+    zwp_linux_buffer_params_v1_send_failed(resource);
+}
+
+static void create_immed(struct wl_client * client,
+                         struct wl_resource * resource, uint32_t id,
+                         int32_t width, int32_t height, uint32_t format,
+                         uint32_t flags)
+{
+    struct params * params = wl_resource_get_user_data(resource);
+    struct swc_dmabuf_attributes attributes;
+    struct wld_buffer * buffer;
+
+    if (!get_attributes(params, width, height, format, &attributes))
+        return;
+
+    if (flags != 0 || !(buffer = swc_dmabuf_import(&attributes)))
+    {
+        wl_resource_post_error
+            (resource, ZWP_LINUX_BUFFER_PARAMS_V1_ERROR_INVALID_WL_BUFFER,
+             "could not import buffer");
+        return;
+    }
+
+    if (!swc_wayland_buffer_create_resource(client, id, buffer))
+        wld_buffer_unreference(buffer);
+}
+
+static const struct zwp_linux_buffer_params_v1_interface params_implementation = {
+    .destroy = &destroy,
+    .add = &add,
+    .create = &create,
+    .create_immed = &create_immed
+};
+
+static void destroy_params(struct wl_resource * resource)
+{
+    struct params * params = wl_resource_get_user_data(resource);
+    uint32_t index;
+
+    for (index = 0; index < ARRAY_SIZE(params->planes); ++index)
+    {
+        if (params->planes[index].fd != -1)
+            close(params->planes[index].fd);
+    }
+
+    free(params);
+}
+
+/* }}} */
+
+static void create_params(struct wl_client * client,
+                          struct wl_resource * resource, uint32_t id)
+{
+    struct params * params;
+    uint32_t index;
+
+    if (!(params = malloc(sizeof *params)))
+        goto error0;
+
+    params->resource = wl_resource_create
+        (client, &zwp_linux_buffer_params_v1_interface,
+         wl_resource_get_version(resource), id);
+
+    if (!params->resource)
+        goto error1;
+
+    for (index = 0; index < ARRAY_SIZE(params->planes); ++index)
+        params->planes[index].fd = -1;
+
+    params->used = false;
+    wl_resource_set_implementation(params->resource, &params_implementation,
+                                   params, &destroy_params);
+
+    return;
+
+  error1:
+    free(params);
+  error0:
+    wl_resource_post_no_memory(resource);
+}
+
+static void get_default_feedback(struct wl_client * client,
+                                 struct wl_resource * resource, uint32_t id)
+{
+    struct wl_resource * feedback;
+
+    if ((feedback = create_feedback(client, resource, id)))
+        send_feedback(feedback, 0);
+}
+
+static void get_surface_feedback(struct wl_client * client,
+                                 struct wl_resource * resource, uint32_t id,
+                                 struct wl_resource * surface_resource)
+{
+    struct swc_surface * surface = wl_resource_get_user_data(surface_resource);
+    struct wl_resource * feedback;
+
+    if (!(feedback = create_feedback(client, resource, id)))
+        return;
+
+    wl_list_insert(&surface->dmabuf_feedbacks, wl_resource_get_link(feedback));
+    send_feedback(feedback, surface_scanout(surface));
+}
+
+static const struct zwp_linux_dmabuf_v1_interface dmabuf_implementation = {
+    .destroy = &destroy,
+    .create_params = &create_params,
+    .get_default_feedback = &get_default_feedback,
+    .get_surface_feedback = &get_surface_feedback
+};
+
+static void bind_dmabuf(struct wl_client * client, void * data,
+                        uint32_t version, uint32_t id)
+{
+    struct wl_resource * resource;
+    const struct format_table_entry * entry;
+    uint32_t index;
+
+    if (version > 4)
+        version = 4;
+
+    if (!create_table())
+    {
+        wl_client_post_no_memory(client);
+        return;
+    }
+
+    resource = wl_resource_create(client, &zwp_linux_dmabuf_v1_interface,
+                                  version, id);
+
+    if (!resource)
+    {
+        wl_client_post_no_memory(client);
+        return;
+    }
+
+    wl_resource_set_implementation(resource, &dmabuf_implementation,
+                                   NULL, NULL);
+
+    /* Newer clients get the formats from feedback objects instead. Older ones
+     * get no hint about scanout, so they are only offered formats that the
+     * renderer can read. */
+    if (version >= 4)
+        return;
+
+    for (index = 0; index < ARRAY_SIZE(renderer_formats); ++index)
+    {
+        entry = &renderer_formats[index];
+
+        /* Clients that don't know about modifiers can only use formats that
+         * are supported with an implicit layout. */
+        if (entry->modifier == DRM_FORMAT_MOD_INVALID)
+            zwp_linux_dmabuf_v1_send_format(resource, entry->format);
+
+        if (version >= 3)
+        {
+            zwp_linux_dmabuf_v1_send_modifier(resource, entry->format,
+                                              entry->modifier >> 32,
+                                              entry->modifier & 0xffffffff);
+        }
+    }
+}
+
+bool swc_dmabuf_initialize()
+{
+    struct stat info;
+
+    if (fstat(swc.drm->fd, &info) != 0)
+    {
+        ERROR("Could not stat DRM device: %s\n", strerror(errno));
+        return false;
+    }
+
+    dmabuf.device = info.st_rdev;
+    dmabuf.table.fd = -1;
+    wl_array_init(&dmabuf.table.entries);
+    dmabuf.global = wl_global_create(swc.display,
+                                     &zwp_linux_dmabuf_v1_interface, 4,
+                                     NULL, &bind_dmabuf);
+
+    return dmabuf.global != NULL;
+}
+
+void swc_dmabuf_finalize()
+{
+    wl_global_destroy(dmabuf.global);
+
+    if (dmabuf.table.fd != -1)
+        close(dmabuf.table.fd);
+
+    wl_array_release(&dmabuf.table.entries);
+}
+
@@ -0,0 +1,119 @@
+/* swc: libswc/dmabuf.h
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SWC_DMABUF_H
+#define SWC_DMABUF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <wld/wld.h>
+
+struct swc_surface;
+
+/**
+ * The layout of the planes of a buffer, as needed to create a DRM
+ * framebuffer for it.
+ *
+ * The handles are GEM handles in the DRM context. The handle of the first
+ * plane belongs to the WLD buffer, the others are closed along with it.
+ */
+struct swc_dmabuf_layout
+{
+    uint32_t num_planes;
+    uint32_t handles[4], offsets[4], strides[4];
+    uint64_t modifier;
+};
+
+/**
+ * The attributes of a buffer shared through DMA-BUF file descriptors, one for
+ * each plane.
+ */
+struct swc_dmabuf_attributes
+{
+    int32_t width, height;
+    uint32_t format;
+    uint32_t num_planes;
+    int fds[4];
+    uint32_t offsets[4], strides[4];
+    uint64_t modifier;
+};
+
+bool swc_dmabuf_initialize();
+void swc_dmabuf_finalize();
+
+/**
+ * Get the number of planes of a format supported for DMA-BUF import, or 0 if
+ * the format is not supported.
+ */
+uint32_t swc_dmabuf_format_planes(uint32_t format);
+
+/**
+ * Import a buffer from DMA-BUF file descriptors, or return NULL if it can't be
+ * imported or the renderer can't read it.
+ *
+ * The file descriptors are not closed.
+ */
+struct wld_buffer * swc_dmabuf_import
+    (const struct swc_dmabuf_attributes * attributes);
+
+/**
+ * Describe the planes of a buffer that was imported by some other means.
+ *
+ * The handles other than the first are owned by the buffer afterwards.
+ */
+bool swc_dmabuf_set_layout(struct wld_buffer * buffer,
+                           const struct swc_dmabuf_layout * layout);
+
+const struct swc_dmabuf_layout * swc_dmabuf_get_layout
+    (struct wld_buffer * buffer);
+
+/**
+ * Get the format modifier of a buffer, or DRM_FORMAT_MOD_INVALID if its layout
+ * is implicit.
+ */
+uint64_t swc_dmabuf_get_modifier(struct wld_buffer * buffer);
+
+/**
+ * Determines whether the renderer can read a buffer with the given format and
+ * layout.
+ *
+ * The renderer only understands buffers consisting of a single RGB plane with
+ * a linear layout, or the one the driver picks implicitly. Since any buffer may
+ * have to be composited, no others are imported.
+ */
+bool swc_dmabuf_is_renderable(uint32_t format, uint32_t num_planes,
+                              uint32_t offset, uint64_t modifier);
+
+/**
+ * Send new feedback to the clients of a surface, for example after the
+ * planes its buffers can be scanned out on have changed.
+ */
+void swc_dmabuf_surface_feedback_changed(struct swc_surface * surface);
+
+/**
+ * Make the feedback objects of a surface inert, before it is destroyed.
+ */
+void swc_dmabuf_surface_destroyed(struct swc_surface * surface);
+
+#endif
+
@@ -22,6 +22,7 @@
  */
 
 #include "drm.h"
+#include "dmabuf.h"
 #include "event.h"
 #include "internal.h"
 #include "launch.h"
@@ -37,12 +38,21 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <libdrm/drm.h>
+#include <libdrm/drm_fourcc.h>
 #include <xf86drm.h>
+#include <xf86drmMode.h>
 #include <wld/wld.h>
 #include <wld/drm.h>
 #include <wayland-server.h>
 #include "protocol/wayland-drm-server-protocol.h"
 
+struct framebuffer
+{
+    struct wld_exporter exporter;
+    struct wld_destructor destructor;
+    uint32_t id;
+};
+
 struct swc_drm swc_drm;
 
 static struct
@@ -105,8 +115,52 @@ static void create_planar_buffer(struct wl_client * client,
                                  int32_t offset1, int32_t stride1,
                                  int32_t offset2, int32_t stride2)
 {
-    wl_resource_post_error(resource, WL_DRM_ERROR_INVALID_FORMAT,
-                           "planar buffers are not supported\n");
+    struct wld_buffer * buffer;
+    struct wl_resource * buffer_resource;
+    union wld_object object = { .u32 = name };
+    struct swc_dmabuf_layout layout = {
+        .offsets = { offset0, offset1, offset2 },
+        .strides = { stride0, stride1, stride2 },
+        .modifier = DRM_FORMAT_MOD_INVALID
+    };
+    uint32_t index;
+
+    if (!(layout.num_planes = swc_dmabuf_format_planes(format))
+        || !swc_dmabuf_is_renderable(format, layout.num_planes, offset0,
+                                     layout.modifier))
+    {
+        wl_resource_post_error(resource, WL_DRM_ERROR_INVALID_FORMAT,
+                               "format 0x%08x is not supported\n", format);
+        return;
+    }
+
+    buffer = wld_import_buffer(swc.drm->context, WLD_DRM_OBJECT_GEM_NAME,
+                               object, width, height, format, stride0);
+
+    if (!buffer)
+        goto error0;
+
+    /* All the planes are in the same buffer object. */
+    if (!wld_export(buffer, WLD_DRM_OBJECT_HANDLE, &object))
+        goto error1;
+
+    for (index = 0; index < layout.num_planes; ++index)
+        layout.handles[index] = object.u32;
+
+    if (!swc_dmabuf_set_layout(buffer, &layout))
+        goto error1;
+
+    buffer_resource = swc_wayland_buffer_create_resource(client, id, buffer);
+
+    if (!buffer_resource)
+        goto error1;
+
+    return;
+
+  error1:
+    wld_buffer_unreference(buffer);
+  error0:
+    wl_resource_post_no_memory(resource);
 }
 
 static void create_prime_buffer(struct wl_client * client,
@@ -119,10 +173,25 @@ static void create_prime_buffer(struct wl_client * client,
 {
     struct wld_buffer * buffer;
     struct wl_resource * buffer_resource;
-    union wld_object object = { .i = fd };
+    struct swc_dmabuf_attributes attributes = {
+        .width = width, .height = height, .format = format,
+        .fds = { fd, fd, fd },
+        .offsets = { offset0, offset1, offset2 },
+        .strides = { stride0, stride1, stride2 },
+        .modifier = DRM_FORMAT_MOD_INVALID
+    };
+
+    if (!(attributes.num_planes = swc_dmabuf_format_planes(format))
+        || !swc_dmabuf_is_renderable(format, attributes.num_planes, offset0,
+                                     attributes.modifier))
+    {
+        wl_resource_post_error(resource, WL_DRM_ERROR_INVALID_FORMAT,
+                               "format 0x%08x is not supported\n", format);
+        close(fd);
+        return;
+    }
 
-    buffer = wld_import_buffer(swc.drm->context, WLD_DRM_OBJECT_PRIME_FD,
-                               object, width, height, format, stride0);
+    buffer = swc_dmabuf_import(&attributes);
     close(fd);
 
     if (!buffer)
@@ -261,8 +330,12 @@ static void handle_page_flip(int fd, unsigned int sequence, unsigned int sec,
                              unsigned int usec, void * data)
 {
     struct swc_drm_handler * handler = data;
+    struct timespec time = { .tv_sec = sec, .tv_nsec = usec * 1000 };
+
+    if (!swc.drm->monotonic)
+        clock_gettime(CLOCK_MONOTONIC, &time);
 
-    handler->page_flip(handler, sec * 1000 + usec / 1000);
+    handler->page_flip(handler, &time, sequence);
 }
 
 static drmEventContext event_context = {
@@ -278,6 +351,218 @@ static int handle_data(int fd, uint32_t mask, void * data)
     return 1;
 }
 
+static bool framebuffer_export(struct wld_exporter * exporter,
+                               struct wld_buffer * buffer,
+                               uint32_t type, union wld_object * object)
+{
+    struct framebuffer * framebuffer
+        = CONTAINER_OF(exporter, typeof(*framebuffer), exporter);
+
+    switch (type)
+    {
+        case WLD_USER_OBJECT_FRAMEBUFFER:
+            object->u32 = framebuffer->id;
+            break;
+        default: return false;
+    }
+
+    return true;
+}
+
+static void framebuffer_destroy(struct wld_destructor * destructor)
+{
+    struct framebuffer * framebuffer
+        = CONTAINER_OF(destructor, typeof(*framebuffer), destructor);
+
+    drmModeRmFB(swc.drm->fd, framebuffer->id);
+    free(framebuffer);
+}
+
+static bool find_property(uint32_t object, uint32_t type, const char * name,
+                          uint32_t * id, uint64_t * value)
+{
+    drmModeObjectPropertiesPtr properties;
+    drmModePropertyPtr property;
+    uint32_t index;
+    bool found = false;
+
+    properties = drmModeObjectGetProperties(swc.drm->fd, object, type);
+
+    if (!properties)
+        return false;
+
+    for (index = 0; index < properties->count_props && !found; ++index)
+    {
+        if (!(property = drmModeGetProperty(swc.drm->fd,
+                                            properties->props[index])))
+        {
+            continue;
+        }
+
+        if (strcmp(property->name, name) == 0)
+        {
+            if (id)
+                *id = property->prop_id;
+            if (value)
+                *value = properties->prop_values[index];
+            found = true;
+        }
+
+        drmModeFreeProperty(property);
+    }
+
+    drmModeFreeObjectProperties(properties);
+
+    return found;
+}
+
+static bool get_plane_type(uint32_t id, uint64_t * type)
+{
+    return find_property(id, DRM_MODE_OBJECT_PLANE, "type", NULL, type);
+}
+
+static bool add_format(struct wl_array * formats,
+                       uint32_t format, uint64_t modifier)
+{
+    struct swc_drm_format * entry;
+
+    if (!(entry = wl_array_add(formats, sizeof *entry)))
+        return false;
+
+    entry->format = format;
+    entry->modifier = modifier;
+
+    return true;
+}
+
+bool swc_drm_get_plane_formats(drmModePlane * plane, struct wl_array * formats)
+{
+    drmModePropertyBlobPtr blob;
+    struct drm_format_modifier_blob * header;
+    struct drm_format_modifier * modifiers;
+    uint32_t * blob_formats;
+    uint32_t index, bit;
+    uint64_t value;
+    bool success = true;
+
+    /* Every format can be used with the layout the driver picks
+     * implicitly. */
+    for (index = 0; index < plane->count_formats && success; ++index)
+    {
+        success = add_format(formats, plane->formats[index],
+                             DRM_FORMAT_MOD_INVALID);
+    }
+
+    /* The explicit layouts are listed by the IN_FORMATS property, but are
+     * only of use if framebuffers can be created with them. */
+    if (!success || !swc.drm->modifiers
+        || !find_property(plane->plane_id, DRM_MODE_OBJECT_PLANE,
+                          "IN_FORMATS", NULL, &value)
+        || !(blob = drmModeGetPropertyBlob(swc.drm->fd, value)))
+    {
+        return success;
+    }
+
+    header = blob->data;
+    blob_formats = (void *) ((char *) header + header->formats_offset);
+    modifiers = (void *) ((char *) header + header->modifiers_offset);
+
+    /* Each modifier has a mask of the formats it supports, starting at its
+     * offset into the list of formats. */
+    for (index = 0; index < header->count_modifiers && success; ++index)
+    {
+        for (bit = 0; bit < 64 && success; ++bit)
+        {
+            if (!(modifiers[index].formats & (1ull << bit))
+                || modifiers[index].offset + bit >= header->count_formats)
+            {
+                continue;
+            }
+
+            success = add_format(formats,
+                                 blob_formats[modifiers[index].offset + bit],
+                                 modifiers[index].modifier);
+        }
+    }
+
+    drmModeFreePropertyBlob(blob);
+
+    return success;
+}
+
+static bool get_plane_zpos(uint32_t id, uint64_t * zpos)
+{
+    return find_property(id, DRM_MODE_OBJECT_PLANE, "zpos", NULL, zpos);
+}
+
+/**
+ * Determines whether a plane is stacked above the primary plane. Without
+ * zpos properties, overlay planes are assumed to be.
+ */
+static bool plane_is_above_primary(uint32_t id, uint32_t primary)
+{
+    uint64_t zpos, primary_zpos;
+
+    if (!get_plane_zpos(id, &zpos) || !get_plane_zpos(primary, &primary_zpos))
+        return true;
+
+    return zpos > primary_zpos;
+}
+
+static void add_overlay_planes(struct screen * screen, uint32_t crtc_index,
+                               drmModePlaneRes * plane_resources,
+                               bool * taken_planes)
+{
+    drmModePlane * plane;
+    struct swc_overlay_plane * overlay;
+    struct wl_array formats;
+    uint64_t type;
+    uint32_t index, primary;
+
+    if (!swc_drm_find_plane(screen->planes.framebuffer.crtc,
+                            DRM_PLANE_TYPE_PRIMARY, &primary))
+    {
+        primary = 0;
+    }
+
+    for (index = 0; index < plane_resources->count_planes; ++index)
+    {
+        if (taken_planes[index])
+            continue;
+
+        plane = drmModeGetPlane(swc.drm->fd, plane_resources->planes[index]);
+
+        if (!plane)
+            continue;
+
+        wl_array_init(&formats);
+
+        /* Views are only put on overlay planes if nothing overlaps them, so
+         * the planes must be displayed above the framebuffer. */
+        if ((plane->possible_crtcs & (1 << crtc_index))
+            && get_plane_type(plane->plane_id, &type)
+            && type == DRM_PLANE_TYPE_OVERLAY
+            && (!primary || plane_is_above_primary(plane->plane_id, primary))
+            && swc_drm_get_plane_formats(plane, &formats))
+        {
+            overlay = swc_overlay_plane_new
+                (plane->plane_id, &screen->planes.framebuffer, formats.data,
+                 formats.size / sizeof(struct swc_drm_format),
+                 &screen->base.geometry);
+
+            if (overlay)
+            {
+                DEBUG("Using plane %u as an overlay\n", plane->plane_id);
+                wl_list_insert(screen->planes.overlays.prev, &overlay->link);
+                taken_planes[index] = true;
+            }
+        }
+
+        wl_array_release(&formats);
+        drmModeFreePlane(plane);
+    }
+}
+
 static void bind_drm(struct wl_client * client, void * data, uint32_t version,
                      uint32_t id)
 {
@@ -299,6 +584,8 @@ static void bind_drm(struct wl_client * client, void * data, uint32_t version,
 
 bool swc_drm_initialize()
 {
+    uint64_t value;
+
     if (!find_primary_drm_device(&drm.path))
     {
         ERROR("Could not find DRM device\n");
@@ -314,6 +601,33 @@ bool swc_drm_initialize()
         goto error1;
     }
 
+    /* Expose primary and cursor planes as well, so that we can tell them
+     * apart from the overlay planes. */
+    if (drmSetClientCap(swc.drm->fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) != 0)
+    {
+        WARNING("Universal planes are not supported, disabling overlays\n");
+        swc.drm->atomic = false;
+    }
+    else
+    {
+        swc.drm->atomic
+            = drmSetClientCap(swc.drm->fd, DRM_CLIENT_CAP_ATOMIC, 1) == 0;
+    }
+
+    if (!swc.drm->atomic)
+        DEBUG("Atomic modesetting is not supported, using legacy interface\n");
+
+    if (drmGetCap(swc.drm->fd, DRM_CAP_TIMESTAMP_MONOTONIC, &value) != 0)
+        value = 0;
+
+    if (!(swc.drm->monotonic = value))
+        WARNING("Page flip timestamps are not monotonic, using arrival time\n");
+
+    if (drmGetCap(swc.drm->fd, DRM_CAP_ADDFB2_MODIFIERS, &value) != 0)
+        value = 0;
+
+    swc.drm->modifiers = value;
+
     if (!(swc.drm->context = wld_drm_create_context(swc.drm->fd)))
     {
         ERROR("Could not create WLD DRM context\n");
@@ -345,10 +659,18 @@ bool swc_drm_initialize()
             ERROR("Could not create wl_drm global\n");
             goto error5;
         }
+
+        if (!swc_dmabuf_initialize())
+        {
+            ERROR("Could not initialize linux-dmabuf\n");
+            goto error6;
+        }
     }
 
     return true;
 
+  error6:
+    wl_global_destroy(drm.global);
   error5:
     wl_event_source_remove(drm.event_source);
   error4:
@@ -366,7 +688,10 @@ bool swc_drm_initialize()
 void swc_drm_finalize()
 {
     if (drm.global)
+    {
+        swc_dmabuf_finalize();
         wl_global_destroy(drm.global);
+    }
     wl_event_source_remove(drm.event_source);
     wld_destroy_renderer(swc.drm->renderer);
     wld_destroy_context(swc.drm->context);
@@ -374,13 +699,291 @@ void swc_drm_finalize()
     close(swc.drm->fd);
 }
 
+bool swc_drm_get_framebuffer(struct wld_buffer * buffer, uint32_t * id)
+{
+    union wld_object object;
+    struct framebuffer * framebuffer;
+    const struct swc_dmabuf_layout * layout;
+    uint32_t handles[4] = { 0 }, pitches[4] = { 0 }, offsets[4] = { 0 };
+    uint64_t modifiers[4] = { 0 }, modifier = DRM_FORMAT_MOD_INVALID;
+    uint32_t index;
+    int ret;
+
+    if (wld_export(buffer, WLD_USER_OBJECT_FRAMEBUFFER, &object))
+    {
+        *id = object.u32;
+        return true;
+    }
+
+    if ((layout = swc_dmabuf_get_layout(buffer)))
+    {
+        for (index = 0; index < layout->num_planes; ++index)
+        {
+            handles[index] = layout->handles[index];
+            pitches[index] = layout->strides[index];
+            offsets[index] = layout->offsets[index];
+            modifiers[index] = layout->modifier;
+        }
+
+        modifier = layout->modifier;
+    }
+    else if (wld_export(buffer, WLD_DRM_OBJECT_HANDLE, &object))
+    {
+        handles[0] = object.u32;
+        pitches[0] = buffer->pitch;
+    }
+    else
+    {
+        ERROR("Could not get buffer handle\n");
+        return false;
+    }
+
+    /* Without support for modifiers, the kernel can only use the layout it
+     * picks implicitly, which is linear for linear buffers. */
+    if (modifier != DRM_FORMAT_MOD_INVALID && !swc.drm->modifiers
+        && modifier != DRM_FORMAT_MOD_LINEAR)
+    {
+        return false;
+    }
+
+    if (!(framebuffer = malloc(sizeof *framebuffer)))
+        return false;
+
+    /* WLD formats use the same fourcc codes as DRM. */
+    if (modifier != DRM_FORMAT_MOD_INVALID && swc.drm->modifiers)
+    {
+        ret = drmModeAddFB2WithModifiers
+            (swc.drm->fd, buffer->width, buffer->height, buffer->format,
+             handles, pitches, offsets, modifiers, &framebuffer->id,
+             DRM_MODE_FB_MODIFIERS);
+    }
+    else
+    {
+        ret = drmModeAddFB2(swc.drm->fd, buffer->width, buffer->height,
+                            buffer->format, handles, pitches, offsets,
+                            &framebuffer->id, 0);
+    }
+
+    if (ret != 0)
+    {
+        free(framebuffer);
+        return false;
+    }
+
+    framebuffer->exporter.export = &framebuffer_export;
+    wld_buffer_add_exporter(buffer, &framebuffer->exporter);
+    framebuffer->destructor.destroy = &framebuffer_destroy;
+    wld_buffer_add_destructor(buffer, &framebuffer->destructor);
+
+    *id = framebuffer->id;
+
+    return true;
+}
+
+uint32_t swc_drm_get_property(uint32_t object, uint32_t type,
+                              const char * name)
+{
+    uint32_t id;
+
+    return find_property(object, type, name, &id, NULL) ? id : 0;
+}
+
+bool swc_drm_find_plane(uint32_t crtc, uint64_t type, uint32_t * id)
+{
+    drmModeRes * resources;
+    drmModePlaneRes * plane_resources;
+    drmModePlane * plane;
+    uint32_t crtc_index, index;
+    uint64_t plane_type;
+    bool found = false;
+
+    if (!(resources = drmModeGetResources(swc.drm->fd)))
+        goto error0;
+
+    for (crtc_index = 0; crtc_index < resources->count_crtcs; ++crtc_index)
+    {
+        if (resources->crtcs[crtc_index] == crtc)
+            break;
+    }
+
+    if (crtc_index == resources->count_crtcs)
+        goto error1;
+
+    if (!(plane_resources = drmModeGetPlaneResources(swc.drm->fd)))
+        goto error1;
+
+    for (index = 0; index < plane_resources->count_planes && !found; ++index)
+    {
+        plane = drmModeGetPlane(swc.drm->fd, plane_resources->planes[index]);
+
+        if (!plane)
+            continue;
+
+        if ((plane->possible_crtcs & (1 << crtc_index))
+            && get_plane_type(plane->plane_id, &plane_type)
+            && plane_type == type)
+        {
+            *id = plane->plane_id;
+            found = true;
+        }
+
+        drmModeFreePlane(plane);
+    }
+
+    drmModeFreePlaneResources(plane_resources);
+  error1:
+    drmModeFreeResources(resources);
+  error0:
+    return found;
+}
+
+/* Planes keep their buffers referenced while they may be scanned out, and
+ * clients aren't told they can reuse them until then. */
+static void hold_buffer(struct wld_buffer * buffer)
+{
+    wld_buffer_reference(buffer);
+    swc_wayland_buffer_begin_scanout(buffer);
+}
+
+static void drop_buffer(struct wld_buffer * buffer)
+{
+    swc_wayland_buffer_end_scanout(buffer);
+    wld_buffer_unreference(buffer);
+}
+
+bool swc_drm_plane_initialize(struct swc_drm_plane * plane, uint32_t id)
+{
+    const uint32_t type = DRM_MODE_OBJECT_PLANE;
+
+    plane->id = id;
+    plane->property.fb_id = swc_drm_get_property(id, type, "FB_ID");
+    plane->property.crtc_id = swc_drm_get_property(id, type, "CRTC_ID");
+    plane->property.src_x = swc_drm_get_property(id, type, "SRC_X");
+    plane->property.src_y = swc_drm_get_property(id, type, "SRC_Y");
+    plane->property.src_w = swc_drm_get_property(id, type, "SRC_W");
+    plane->property.src_h = swc_drm_get_property(id, type, "SRC_H");
+    plane->property.crtc_x = swc_drm_get_property(id, type, "CRTC_X");
+    plane->property.crtc_y = swc_drm_get_property(id, type, "CRTC_Y");
+    plane->property.crtc_w = swc_drm_get_property(id, type, "CRTC_W");
+    plane->property.crtc_h = swc_drm_get_property(id, type, "CRTC_H");
+
+    if (!plane->property.fb_id || !plane->property.crtc_id
+        || !plane->property.src_x || !plane->property.src_y
+        || !plane->property.src_w || !plane->property.src_h
+        || !plane->property.crtc_x || !plane->property.crtc_y
+        || !plane->property.crtc_w || !plane->property.crtc_h)
+    {
+        ERROR("Plane %u is missing atomic properties\n", id);
+        return false;
+    }
+
+    plane->buffer = NULL;
+    plane->committed = NULL;
+    plane->retired = NULL;
+    plane->x = 0;
+    plane->y = 0;
+    plane->dirty = false;
+    wl_list_init(&plane->link);
+
+    return true;
+}
+
+void swc_drm_plane_finalize(struct swc_drm_plane * plane)
+{
+    if (plane->buffer)
+        drop_buffer(plane->buffer);
+    if (plane->committed)
+        drop_buffer(plane->committed);
+    if (plane->retired)
+        drop_buffer(plane->retired);
+    wl_list_remove(&plane->link);
+}
+
+void swc_drm_plane_set(struct swc_drm_plane * plane, struct wld_buffer * buffer,
+                       int32_t x, int32_t y)
+{
+    if (buffer)
+        hold_buffer(buffer);
+    if (plane->buffer)
+        drop_buffer(plane->buffer);
+
+    plane->buffer = buffer;
+    plane->x = x;
+    plane->y = y;
+    plane->dirty = true;
+}
+
+static bool add_property(drmModeAtomicReq * request, uint32_t object,
+                         uint32_t property, uint64_t value)
+{
+    return drmModeAtomicAddProperty(request, object, property, value) >= 0;
+}
+
+bool swc_drm_plane_add(struct swc_drm_plane * plane, drmModeAtomicReq * request,
+                       uint32_t crtc)
+{
+    struct wld_buffer * buffer = plane->buffer;
+    uint32_t framebuffer;
+
+    if (!buffer)
+    {
+        return add_property(request, plane->id, plane->property.fb_id, 0)
+            && add_property(request, plane->id, plane->property.crtc_id, 0);
+    }
+
+    if (!swc_drm_get_framebuffer(buffer, &framebuffer))
+        return false;
+
+    /* Source coordinates are in 16.16 fixed point. */
+    return add_property(request, plane->id, plane->property.fb_id, framebuffer)
+        && add_property(request, plane->id, plane->property.crtc_id, crtc)
+        && add_property(request, plane->id, plane->property.src_x, 0)
+        && add_property(request, plane->id, plane->property.src_y, 0)
+        && add_property(request, plane->id, plane->property.src_w,
+                        (uint64_t) buffer->width << 16)
+        && add_property(request, plane->id, plane->property.src_h,
+                        (uint64_t) buffer->height << 16)
+        && add_property(request, plane->id, plane->property.crtc_x,
+                        (uint64_t) plane->x)
+        && add_property(request, plane->id, plane->property.crtc_y,
+                        (uint64_t) plane->y)
+        && add_property(request, plane->id, plane->property.crtc_w,
+                        buffer->width)
+        && add_property(request, plane->id, plane->property.crtc_h,
+                        buffer->height);
+}
+
+void swc_drm_plane_commit(struct swc_drm_plane * plane)
+{
+    if (plane->retired)
+        drop_buffer(plane->retired);
+
+    plane->retired = plane->committed;
+
+    if ((plane->committed = plane->buffer))
+        hold_buffer(plane->committed);
+
+    plane->dirty = false;
+}
+
+void swc_drm_plane_retire(struct swc_drm_plane * plane)
+{
+    if (plane->retired)
+    {
+        drop_buffer(plane->retired);
+        plane->retired = NULL;
+    }
+}
+
 bool swc_drm_create_screens(struct wl_list * screens)
 {
     drmModeRes * resources;
+    drmModePlaneRes * plane_resources;
     drmModeConnector * connector;
     uint32_t index;
     struct swc_output * output;
     uint32_t taken_crtcs = 0;
+    bool * taken_planes = NULL;
 
     if (!(resources = drmModeGetResources(swc.drm->fd)))
     {
@@ -388,6 +991,12 @@ bool swc_drm_create_screens(struct wl_list * screens)
         return false;
     }
 
+    if ((plane_resources = drmModeGetPlaneResources(swc.drm->fd)))
+    {
+        taken_planes = calloc(plane_resources->count_planes,
+                              sizeof *taken_planes);
+    }
+
     for (index = 0; index < resources->count_connectors;
          ++index, drmModeFreeConnector(connector))
     {
@@ -419,6 +1028,12 @@ bool swc_drm_create_screens(struct wl_list * screens)
             output->screen = screen_new(resources->crtcs[crtc_index], output);
             output->screen->id = id;
 
+            if (plane_resources && taken_planes)
+            {
+                add_overlay_planes(output->screen, crtc_index,
+                                   plane_resources, taken_planes);
+            }
+
             taken_crtcs |= 1 << crtc_index;
             drm.taken_ids |= 1 << id;
 
@@ -426,6 +1041,11 @@ bool swc_drm_create_screens(struct wl_list * screens)
         }
     }
 
+    free(taken_planes);
+
+    if (plane_resources)
+        drmModeFreePlaneResources(plane_resources);
+
     drmModeFreeResources(resources);
 
     return true;
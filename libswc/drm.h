@@ -3,11 +3,16 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <time.h>
 #include <wayland-server.h>
+#include <xf86drmMode.h>
+
+struct wld_buffer;
 
 struct swc_drm_handler
 {
-    void (* page_flip)(struct swc_drm_handler * handler, uint32_t time);
+    void (* page_flip)(struct swc_drm_handler * handler,
+                       const struct timespec * time, uint32_t sequence);
 };
 
 struct swc_drm
@@ -15,6 +20,52 @@ struct swc_drm
     int fd;
     struct wld_context * context;
     struct wld_renderer * renderer;
+
+    /* Whether plane updates are submitted with atomic commits. */
+    bool atomic;
+
+    /* Whether page flip events are timestamped by the kernel with the
+     * monotonic clock. If not, they are timestamped on arrival instead. */
+    bool monotonic;
+
+    /* Whether framebuffers can be created with explicit format modifiers. */
+    bool modifiers;
+};
+
+/**
+ * A format supported by a plane, along with a modifier describing a layout
+ * it supports it with. DRM_FORMAT_MOD_INVALID stands for whichever layout the
+ * driver picks implicitly.
+ */
+struct swc_drm_format
+{
+    uint32_t format;
+    uint64_t modifier;
+};
+
+/**
+ * The state of a plane managed through the atomic modesetting interface.
+ *
+ * Changes are staged with swc_drm_plane_set and only take effect once the
+ * plane is added to an atomic request which is then committed.
+ */
+struct swc_drm_plane
+{
+    uint32_t id;
+
+    struct
+    {
+        uint32_t fb_id, crtc_id;
+        uint32_t src_x, src_y, src_w, src_h;
+        uint32_t crtc_x, crtc_y, crtc_w, crtc_h;
+    } property;
+
+    /* The staged state, and the buffers in the two most recent commits. */
+    struct wld_buffer * buffer, * committed, * retired;
+    int32_t x, y;
+    bool dirty;
+
+    struct wl_list link;
 };
 
 bool swc_drm_initialize();
@@ -22,5 +73,57 @@ void swc_drm_finalize();
 
 bool swc_drm_create_screens(struct wl_list * screens);
 
+/**
+ * Get the ID of a DRM framebuffer that can be used to scan out the buffer.
+ *
+ * The framebuffer is created on first use and destroyed along with the
+ * buffer.
+ */
+bool swc_drm_get_framebuffer(struct wld_buffer * buffer, uint32_t * id);
+
+/**
+ * Look up the ID of the property of a DRM object with the given name.
+ *
+ * Returns 0 if the object has no such property.
+ */
+uint32_t swc_drm_get_property(uint32_t object, uint32_t type,
+                              const char * name);
+
+/**
+ * Get the formats supported by a plane, as struct swc_drm_format.
+ */
+bool swc_drm_get_plane_formats(drmModePlane * plane, struct wl_array * formats);
+
+/**
+ * Find a plane of the given type (DRM_PLANE_TYPE_*) usable with a CRTC.
+ */
+bool swc_drm_find_plane(uint32_t crtc, uint64_t type, uint32_t * id);
+
+bool swc_drm_plane_initialize(struct swc_drm_plane * plane, uint32_t id);
+void swc_drm_plane_finalize(struct swc_drm_plane * plane);
+
+/**
+ * Stage a new buffer and position (relative to the CRTC) for the plane.
+ *
+ * A NULL buffer disables the plane.
+ */
+void swc_drm_plane_set(struct swc_drm_plane * plane, struct wld_buffer * buffer,
+                       int32_t x, int32_t y);
+
+/**
+ * Add the staged state of the plane to an atomic request.
+ */
+bool swc_drm_plane_add(struct swc_drm_plane * plane, drmModeAtomicReq * request,
+                       uint32_t crtc);
+
+/**
+ * Mark the staged state of the plane as committed.
+ *
+ * The buffer it replaced stays referenced until swc_drm_plane_retire is
+ * called once the commit has completed.
+ */
+void swc_drm_plane_commit(struct swc_drm_plane * plane);
+void swc_drm_plane_retire(struct swc_drm_plane * plane);
+
 #endif
 
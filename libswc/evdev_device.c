@@ -43,15 +43,10 @@
 #define AXIS_STEP_DISTANCE 10
 #define ARRAY_SIZE(array) (sizeof(array) / sizeof(array[0]))
 
-static inline uint32_t timeval_to_msec(struct timeval * time)
-{
-    return time->tv_sec * 1000 + time->tv_usec / 1000;
-}
-
 static void handle_key_event(struct swc_evdev_device * device,
                              struct input_event * input_event)
 {
-    uint32_t time = timeval_to_msec(&input_event->time);
+    uint32_t time = swc_timeval_to_msec(&input_event->time);
     uint32_t state;
 
     if ((input_event->code >= BTN_MISC && input_event->code <= BTN_GEAR_UP)
@@ -72,7 +67,7 @@ static void handle_key_event(struct swc_evdev_device * device,
 static void handle_rel_event(struct swc_evdev_device * device,
                              struct input_event * input_event)
 {
-    uint32_t time = timeval_to_msec(&input_event->time);
+    uint32_t time = swc_timeval_to_msec(&input_event->time);
     uint32_t axis, amount;
 
     switch (input_event->code)
@@ -137,7 +132,7 @@ static void handle_event(struct swc_evdev_device * device,
                          struct input_event * event)
 {
     if (!is_motion_event(event))
-        handle_motion_events(device, timeval_to_msec(&event->time));
+        handle_motion_events(device, swc_timeval_to_msec(&event->time));
 
     if (event->type < ARRAY_SIZE(event_handlers)
         && event_handlers[event->type])
@@ -191,7 +186,7 @@ static int handle_data(int fd, uint32_t mask, void * data)
     if (ret == -ENODEV)
         close_device(device);
 
-    handle_motion_events(device, timeval_to_msec(&event.time));
+    handle_motion_events(device, swc_timeval_to_msec(&event.time));
 
     return 1;
 }
@@ -221,6 +216,11 @@ struct swc_evdev_device * swc_evdev_device_new
         goto error3;
     }
 
+    /* Use the same clock as page flip events so that input latency can be
+     * measured. The kernel defaults to the realtime clock. */
+    if (libevdev_set_clock_id(device->dev, CLOCK_MONOTONIC) != 0)
+        WARNING("Could not use monotonic clock for %s\n", path);
+
     device->source = wl_event_loop_add_fd
         (swc.event_loop, device->fd, WL_EVENT_READABLE, handle_data, device);
 
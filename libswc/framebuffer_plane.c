@@ -27,99 +27,226 @@
 #include "util.h"
 
 #include <errno.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
 #include <wld/wld.h>
 #include <wld/drm.h>
+#include <libdrm/drm_fourcc.h>
 #include <xf86drm.h>
 #include <xf86drmMode.h>
+#include "protocol/presentation-time-server-protocol.h"
 
-enum
+static bool update(struct swc_view * view)
 {
-    WLD_USER_OBJECT_FRAMEBUFFER = WLD_USER_ID
-};
+    return true;
+}
 
-struct framebuffer
+static uint32_t refresh_interval(struct swc_framebuffer_plane * plane)
 {
-    struct wld_exporter exporter;
-    struct wld_destructor destructor;
-    uint32_t id;
-};
+    /* The mode refresh rate is in mHz. */
+    return plane->mode.refresh ? 1000000000000ull / plane->mode.refresh : 0;
+}
 
-static bool framebuffer_export(struct wld_exporter * exporter,
-                               struct wld_buffer * buffer,
-                               uint32_t type, union wld_object * object)
+static void send_frame(void * data)
+{
+    struct swc_framebuffer_plane * plane = data;
+    struct swc_frame frame = {
+        .refresh = refresh_interval(plane),
+        .presented = true
+    };
+
+    /* Modesets don't report when they complete. */
+    clock_gettime(CLOCK_MONOTONIC, &frame.time);
+    swc_view_frame(&plane->view, &frame);
+}
+
+static bool add_modeset(struct swc_framebuffer_plane * plane,
+                        drmModeAtomicReq * request)
 {
-    struct framebuffer * framebuffer
-        = CONTAINER_OF(exporter, typeof(*framebuffer), exporter);
+    uint32_t * connector, property;
+
+    property = swc_drm_get_property(plane->crtc, DRM_MODE_OBJECT_CRTC,
+                                    "MODE_ID");
 
-    switch (type)
+    if (!property
+        || drmModeAtomicAddProperty(request, plane->crtc, property,
+                                    plane->mode_blob) < 0)
     {
-        case WLD_USER_OBJECT_FRAMEBUFFER:
-            object->u32 = framebuffer->id;
-            break;
-        default: return false;
+        return false;
+    }
+
+    property = swc_drm_get_property(plane->crtc, DRM_MODE_OBJECT_CRTC,
+                                    "ACTIVE");
+
+    if (!property
+        || drmModeAtomicAddProperty(request, plane->crtc, property, 1) < 0)
+    {
+        return false;
+    }
+
+    wl_array_for_each(connector, &plane->connectors)
+    {
+        property = swc_drm_get_property(*connector, DRM_MODE_OBJECT_CONNECTOR,
+                                        "CRTC_ID");
+
+        if (!property
+            || drmModeAtomicAddProperty(request, *connector, property,
+                                        plane->crtc) < 0)
+        {
+            return false;
+        }
     }
 
     return true;
 }
 
-static void framebuffer_destroy(struct wld_destructor * destructor)
+static drmModeAtomicReq * build_request(struct swc_framebuffer_plane * plane)
 {
-    struct framebuffer * framebuffer
-        = CONTAINER_OF(destructor, typeof(*framebuffer), destructor);
+    drmModeAtomicReq * request;
+    struct swc_drm_plane * other;
+
+    if (!(request = drmModeAtomicAlloc()))
+        goto error0;
 
-    drmModeRmFB(swc.drm->fd, framebuffer->id);
-    free(framebuffer);
+    if (plane->need_modeset && !add_modeset(plane, request))
+        goto error1;
+
+    if (plane->primary.dirty
+        && !swc_drm_plane_add(&plane->primary, request, plane->crtc))
+    {
+        goto error1;
+    }
+
+    wl_list_for_each(other, &plane->planes, link)
+    {
+        if (other->dirty && !swc_drm_plane_add(other, request, plane->crtc))
+            goto error1;
+    }
+
+    return request;
+
+  error1:
+    drmModeAtomicFree(request);
+  error0:
+    return NULL;
 }
 
-static bool update(struct swc_view * view)
+bool swc_framebuffer_plane_test(struct swc_framebuffer_plane * plane)
 {
-    return true;
+    drmModeAtomicReq * request;
+    uint32_t flags = DRM_MODE_ATOMIC_TEST_ONLY;
+    bool success;
+
+    if (!(request = build_request(plane)))
+        return false;
+
+    if (plane->need_modeset)
+        flags |= DRM_MODE_ATOMIC_ALLOW_MODESET;
+
+    success = drmModeAtomicCommit(swc.drm->fd, request, flags, NULL) == 0;
+    drmModeAtomicFree(request);
+
+    return success;
 }
 
-static void send_frame(void * data)
+static bool is_dirty(struct swc_framebuffer_plane * plane)
 {
-    struct swc_framebuffer_plane * plane = data;
+    struct swc_drm_plane * other;
+
+    if (plane->primary.dirty)
+        return true;
+
+    wl_list_for_each(other, &plane->planes, link)
+    {
+        if (other->dirty)
+            return true;
+    }
 
-    swc_view_frame(&plane->view, swc_time());
+    return false;
 }
 
-static bool attach(struct swc_view * view, struct wld_buffer * buffer)
+bool swc_framebuffer_plane_commit(struct swc_framebuffer_plane * plane)
 {
-    struct swc_framebuffer_plane * plane
-        = CONTAINER_OF(view, typeof(*plane), view);
-    union wld_object object;
+    drmModeAtomicReq * request;
+    struct swc_drm_plane * other;
+    uint32_t flags = DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_ATOMIC_NONBLOCK;
 
-    if (!wld_export(buffer, WLD_USER_OBJECT_FRAMEBUFFER, &object))
+    /* The staged state will be picked up when the pending commit completes. */
+    if (plane->commit_pending)
+        return true;
+
+    /* A modeset needs a framebuffer, so hold back changes to the other planes
+     * until the compositor attaches one. */
+    if (plane->need_modeset && !plane->primary.dirty)
+        return true;
+
+    if (!(request = build_request(plane)))
     {
-        struct framebuffer * framebuffer;
+        ERROR("Could not build atomic request for CRTC %u\n", plane->crtc);
+        goto error0;
+    }
 
-        if (!wld_export(buffer, WLD_DRM_OBJECT_HANDLE, &object))
-        {
-            ERROR("Could not get buffer handle\n");
-            return false;
-        }
+    if (plane->need_modeset)
+        flags |= DRM_MODE_ATOMIC_ALLOW_MODESET;
 
-        if (!(framebuffer = malloc(sizeof *framebuffer)))
-            return false;
+    if (drmModeAtomicCommit(swc.drm->fd, request, flags,
+                            &plane->drm_handler) != 0)
+    {
+        ERROR("Atomic commit failed: %s\n", strerror(errno));
+        goto error1;
+    }
 
-        if (drmModeAddFB(swc.drm->fd, buffer->width, buffer->height, 24, 32,
-                         buffer->pitch, object.u32, &framebuffer->id) != 0)
-        {
-            free(framebuffer);
-            return false;
-        }
+    drmModeAtomicFree(request);
+
+    plane->commit_pending = true;
+    plane->need_modeset = false;
+
+    if (plane->primary.dirty)
+    {
+        plane->frame_pending = true;
+        swc_drm_plane_commit(&plane->primary);
+    }
+
+    wl_list_for_each(other, &plane->planes, link)
+    {
+        if (other->dirty)
+            swc_drm_plane_commit(other);
+    }
 
-        framebuffer->exporter.export = &framebuffer_export;
-        wld_buffer_add_exporter(buffer, &framebuffer->exporter);
-        framebuffer->destructor.destroy = &framebuffer_destroy;
-        wld_buffer_add_destructor(buffer, &framebuffer->destructor);
+    return true;
 
-        object.u32 = framebuffer->id;
+  error1:
+    drmModeAtomicFree(request);
+  error0:
+    /* Drop the rejected state so that it does not hold back later commits. */
+    swc_drm_plane_set(&plane->primary, plane->primary.committed, 0, 0);
+    plane->primary.dirty = false;
+
+    wl_list_for_each(other, &plane->planes, link)
+        other->dirty = false;
+
+    return false;
+}
+
+static bool attach(struct swc_view * view, struct wld_buffer * buffer)
+{
+    struct swc_framebuffer_plane * plane
+        = CONTAINER_OF(view, typeof(*plane), view);
+    uint32_t framebuffer;
+
+    if (plane->atomic)
+    {
+        swc_drm_plane_set(&plane->primary, buffer, 0, 0);
+
+        return swc_framebuffer_plane_commit(plane);
     }
 
+    if (!swc_drm_get_framebuffer(buffer, &framebuffer))
+        return false;
+
     if (plane->need_modeset)
     {
-        if (drmModeSetCrtc(swc.drm->fd, plane->crtc, object.u32, 0, 0,
+        if (drmModeSetCrtc(swc.drm->fd, plane->crtc, framebuffer, 0, 0,
                            plane->connectors.data, plane->connectors.size / 4,
                            &plane->mode.info) == 0)
         {
@@ -135,7 +262,7 @@ static bool attach(struct swc_view * view, struct wld_buffer * buffer)
     }
     else
     {
-        if (drmModePageFlip(swc.drm->fd, plane->crtc, object.u32,
+        if (drmModePageFlip(swc.drm->fd, plane->crtc, framebuffer,
                             DRM_MODE_PAGE_FLIP_EVENT, &plane->drm_handler) != 0)
         {
             ERROR("Page flip failed: %s\n", strerror(errno));
@@ -159,12 +286,149 @@ const static struct swc_view_impl view_impl = {
     .move = &move
 };
 
-static void handle_page_flip(struct swc_drm_handler * handler, uint32_t time)
+static void handle_page_flip(struct swc_drm_handler * handler,
+                             const struct timespec * time, uint32_t sequence)
 {
     struct swc_framebuffer_plane * plane
         = CONTAINER_OF(handler, typeof(*plane), drm_handler);
+    struct swc_drm_plane * other;
+    struct swc_frame frame = {
+        .time = *time,
+        .sequence = sequence,
+        .refresh = refresh_interval(plane),
+        .flags = WP_PRESENTATION_FEEDBACK_KIND_VSYNC
+               | WP_PRESENTATION_FEEDBACK_KIND_HW_COMPLETION,
+        .presented = true
+    };
+
+    if (swc.drm->monotonic)
+        frame.flags |= WP_PRESENTATION_FEEDBACK_KIND_HW_CLOCK;
+
+    if (!plane->atomic)
+    {
+        swc_view_frame(&plane->view, &frame);
+        return;
+    }
+
+    plane->commit_pending = false;
+    swc_drm_plane_retire(&plane->primary);
+
+    wl_list_for_each(other, &plane->planes, link)
+        swc_drm_plane_retire(other);
+
+    if (plane->frame_pending)
+    {
+        plane->frame_pending = false;
+        swc_view_frame(&plane->view, &frame);
+    }
+
+    /* Submit any changes that were staged while the commit was in flight
+     * and not already picked up by the frame handlers. */
+    if (!plane->commit_pending && is_dirty(plane))
+        swc_framebuffer_plane_commit(plane);
+}
+
+static void handle_commit_idle(void * data)
+{
+    struct swc_framebuffer_plane * plane = data;
+
+    plane->commit_source = NULL;
+
+    if (is_dirty(plane))
+        swc_framebuffer_plane_commit(plane);
+}
+
+void swc_framebuffer_plane_schedule_commit(struct swc_framebuffer_plane * plane)
+{
+    if (plane->commit_source)
+        return;
+
+    plane->commit_source = wl_event_loop_add_idle
+        (swc.event_loop, &handle_commit_idle, plane);
+}
+
+static void initialize_atomic(struct swc_framebuffer_plane * plane)
+{
+    uint32_t id;
+
+    plane->atomic = false;
+    plane->commit_pending = false;
+    plane->frame_pending = false;
+    plane->commit_source = NULL;
+    wl_list_init(&plane->planes);
+
+    if (!swc.drm->atomic)
+        return;
+
+    if (!swc_drm_find_plane(plane->crtc, DRM_PLANE_TYPE_PRIMARY, &id))
+    {
+        WARNING("Could not find primary plane for CRTC %u\n", plane->crtc);
+        return;
+    }
+
+    if (!swc_drm_plane_initialize(&plane->primary, id))
+        return;
 
-    swc_view_frame(&plane->view, time);
+    if (drmModeCreatePropertyBlob(swc.drm->fd, &plane->mode.info,
+                                  sizeof plane->mode.info,
+                                  &plane->mode_blob) != 0)
+    {
+        ERROR("Could not create mode property blob: %s\n", strerror(errno));
+        swc_drm_plane_finalize(&plane->primary);
+        return;
+    }
+
+    plane->atomic = true;
+}
+
+static void initialize_formats(struct swc_framebuffer_plane * plane)
+{
+    drmModePlane * primary;
+    uint32_t id;
+
+    wl_array_init(&plane->formats);
+
+    if (!swc_drm_find_plane(plane->crtc, DRM_PLANE_TYPE_PRIMARY, &id)
+        || !(primary = drmModeGetPlane(swc.drm->fd, id)))
+    {
+        return;
+    }
+
+    if (!swc_drm_get_plane_formats(primary, &plane->formats))
+        plane->formats.size = 0;
+
+    drmModeFreePlane(primary);
+}
+
+bool swc_framebuffer_plane_supports_format
+    (struct swc_framebuffer_plane * plane, uint32_t format, uint64_t modifier)
+{
+    struct swc_drm_format * plane_format;
+
+    /* Every primary plane can display the formats we render into. */
+    if (plane->formats.size == 0)
+    {
+        return modifier == DRM_FORMAT_MOD_INVALID
+            && (format == DRM_FORMAT_XRGB8888 || format == DRM_FORMAT_ARGB8888);
+    }
+
+    wl_array_for_each(plane_format, &plane->formats)
+    {
+        if (plane_format->format == format
+            && (modifier == DRM_FORMAT_MOD_INVALID
+                || plane_format->modifier == modifier))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void swc_framebuffer_plane_add_plane(struct swc_framebuffer_plane * plane,
+                                     struct swc_drm_plane * other)
+{
+    wl_list_insert(plane->planes.prev, &other->link);
 }
 
 bool swc_framebuffer_plane_initialize(struct swc_framebuffer_plane * plane,
@@ -200,6 +464,7 @@ bool swc_framebuffer_plane_initialize(struct swc_framebuffer_plane * plane,
         goto error2;
     }
 
+    plane->headless = false;
     plane->crtc = crtc;
     plane->drm_handler.page_flip = &handle_page_flip;
     plane->need_modeset = true;
@@ -207,6 +472,8 @@ bool swc_framebuffer_plane_initialize(struct swc_framebuffer_plane * plane,
     plane->view.geometry.width = mode->width;
     plane->view.geometry.height = mode->height;
     plane->mode = *mode;
+    initialize_formats(plane);
+    initialize_atomic(plane);
 
     return true;
 
@@ -218,8 +485,128 @@ bool swc_framebuffer_plane_initialize(struct swc_framebuffer_plane * plane,
     return false;
 }
 
+/* Headless screens {{{ */
+
+static bool headless_attach(struct swc_view * view, struct wld_buffer * buffer)
+{
+    struct swc_framebuffer_plane * plane
+        = CONTAINER_OF(view, typeof(*plane), view);
+    uint64_t now = swc_time_nsec(), interval = refresh_interval(plane);
+    struct itimerspec timer = { };
+
+    /* The buffer is displayed at the next vblank. */
+    plane->next_vblank = now + interval - (now - plane->epoch) % interval;
+    timer.it_value.tv_sec = plane->next_vblank / 1000000000;
+    timer.it_value.tv_nsec = plane->next_vblank % 1000000000;
+
+    if (timerfd_settime(plane->timer_fd, TFD_TIMER_ABSTIME, &timer, NULL) != 0)
+    {
+        ERROR("Could not arm vblank timer: %s\n", strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+static const struct swc_view_impl headless_view_impl = {
+    .update = &update,
+    .attach = &headless_attach,
+    .move = &move
+};
+
+static int handle_vblank(int fd, uint32_t mask, void * data)
+{
+    struct swc_framebuffer_plane * plane = data;
+    uint64_t expirations, interval = refresh_interval(plane);
+    struct swc_frame frame = {
+        .time = {
+            .tv_sec = plane->next_vblank / 1000000000,
+            .tv_nsec = plane->next_vblank % 1000000000
+        },
+        .sequence = (plane->next_vblank - plane->epoch) / interval,
+        .refresh = interval,
+        .flags = WP_PRESENTATION_FEEDBACK_KIND_VSYNC,
+        .presented = true
+    };
+
+    if (read(fd, &expirations, sizeof expirations) != sizeof expirations)
+        return 0;
+
+    swc_view_frame(&plane->view, &frame);
+
+    return 0;
+}
+
+bool swc_framebuffer_plane_initialize_headless
+    (struct swc_framebuffer_plane * plane, struct swc_mode * mode)
+{
+    plane->timer_fd = timerfd_create(CLOCK_MONOTONIC,
+                                     TFD_CLOEXEC | TFD_NONBLOCK);
+
+    if (plane->timer_fd == -1)
+    {
+        ERROR("Could not create vblank timer: %s\n", strerror(errno));
+        goto error0;
+    }
+
+    plane->timer_source = wl_event_loop_add_fd
+        (swc.event_loop, plane->timer_fd, WL_EVENT_READABLE,
+         &handle_vblank, plane);
+
+    if (!plane->timer_source)
+    {
+        ERROR("Could not create event source for vblank timer\n");
+        goto error1;
+    }
+
+    plane->headless = true;
+    plane->crtc = 0;
+    plane->original_crtc_state = NULL;
+    plane->need_modeset = false;
+    plane->atomic = false;
+    plane->commit_pending = false;
+    plane->frame_pending = false;
+    plane->commit_source = NULL;
+    plane->epoch = swc_time_nsec();
+    plane->next_vblank = plane->epoch;
+    wl_array_init(&plane->connectors);
+    wl_array_init(&plane->formats);
+    wl_list_init(&plane->planes);
+    swc_view_initialize(&plane->view, &headless_view_impl);
+    plane->view.geometry.width = mode->width;
+    plane->view.geometry.height = mode->height;
+    plane->mode = *mode;
+
+    return true;
+
+  error1:
+    close(plane->timer_fd);
+  error0:
+    return false;
+}
+
+/* }}} */
+
 void swc_framebuffer_plane_finalize(struct swc_framebuffer_plane * plane)
 {
+    wl_array_release(&plane->formats);
+
+    if (plane->headless)
+    {
+        wl_event_source_remove(plane->timer_source);
+        close(plane->timer_fd);
+        return;
+    }
+
+    if (plane->commit_source)
+        wl_event_source_remove(plane->commit_source);
+
+    if (plane->atomic)
+    {
+        swc_drm_plane_finalize(&plane->primary);
+        drmModeDestroyPropertyBlob(swc.drm->fd, plane->mode_blob);
+    }
+
     wl_array_release(&plane->connectors);
     drmModeCrtcPtr crtc = plane->original_crtc_state;
     drmModeSetCrtc(swc.drm->fd, crtc->crtc_id, crtc->buffer_id,
@@ -38,6 +38,25 @@ struct swc_framebuffer_plane
     struct wl_array connectors;
     bool need_modeset;
     struct swc_drm_handler drm_handler;
+
+    /* The formats the primary plane can display, as struct swc_drm_format,
+     * or empty if they are unknown. */
+    struct wl_array formats;
+
+    /* Atomic modesetting state, used if atomic is true. */
+    bool atomic;
+    struct swc_drm_plane primary;
+    struct wl_list planes;
+    uint32_t mode_blob;
+    bool commit_pending, frame_pending;
+    struct wl_event_source * commit_source;
+
+    /* Headless screens have no CRTC. Frames are "displayed" at the vblanks of
+     * a virtual clock started at epoch, signalled by a timerfd. */
+    bool headless;
+    int timer_fd;
+    struct wl_event_source * timer_source;
+    uint64_t epoch, next_vblank;
 };
 
 bool swc_framebuffer_plane_initialize(struct swc_framebuffer_plane * plane,
@@ -45,7 +64,50 @@ bool swc_framebuffer_plane_initialize(struct swc_framebuffer_plane * plane,
                                       uint32_t * connectors,
                                       uint32_t num_connectors);
 
+/**
+ * Initialize a framebuffer plane for a headless screen, which keeps the frames
+ * rendered for it in memory.
+ */
+bool swc_framebuffer_plane_initialize_headless
+    (struct swc_framebuffer_plane * plane, struct swc_mode * mode);
+
 void swc_framebuffer_plane_finalize(struct swc_framebuffer_plane * plane);
 
+/**
+ * Check whether a buffer of the given format and modifier can be displayed
+ * on the primary plane. DRM_FORMAT_MOD_INVALID matches any layout.
+ */
+bool swc_framebuffer_plane_supports_format
+    (struct swc_framebuffer_plane * plane, uint32_t format, uint64_t modifier);
+
+/**
+ * Add a plane to the set of planes committed along with this CRTC.
+ */
+void swc_framebuffer_plane_add_plane(struct swc_framebuffer_plane * plane,
+                                     struct swc_drm_plane * other);
+
+/**
+ * Check whether the staged state of all planes on this CRTC would be accepted
+ * by the hardware, without applying it.
+ */
+bool swc_framebuffer_plane_test(struct swc_framebuffer_plane * plane);
+
+/**
+ * Submit the staged state of all planes on this CRTC in a single atomic
+ * commit.
+ *
+ * If a commit is still in flight, the state is submitted once it completes.
+ */
+bool swc_framebuffer_plane_commit(struct swc_framebuffer_plane * plane);
+
+/**
+ * Schedule a commit once the event loop is idle.
+ *
+ * This lets changes to the other planes (such as cursor motion) be picked up
+ * by the next frame if the compositor is about to repaint anyway, and
+ * coalesces several changes into one commit otherwise.
+ */
+void swc_framebuffer_plane_schedule_commit(struct swc_framebuffer_plane * plane);
+
 #endif
 
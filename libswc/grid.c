@@ -0,0 +1,167 @@
+/* swc: libswc/grid.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "grid.h"
+#include "util.h"
+
+#define MASK (SWC_GRID_SIZE - 1)
+
+static inline int32_t cell_coordinate(int32_t value)
+{
+    /* Arithmetic shift, so that negative coordinates work as well. */
+    return value >> SWC_GRID_CELL_SHIFT;
+}
+
+static inline struct swc_grid_cell * cell(struct swc_grid * grid,
+                                          int32_t x, int32_t y)
+{
+    return &grid->cells[(y & MASK) * SWC_GRID_SIZE + (x & MASK)];
+}
+
+struct range
+{
+    int32_t x1, y1, x2, y2;
+};
+
+/* Get the range of cells covered by the entry, limited to the size of the
+ * grid so that no cell is visited twice. */
+static void get_range(struct swc_grid_entry * entry, struct range * range)
+{
+    const struct swc_rectangle * geometry = &entry->geometry;
+
+    range->x1 = cell_coordinate(geometry->x);
+    range->y1 = cell_coordinate(geometry->y);
+    range->x2 = cell_coordinate
+        (geometry->x + (int32_t) MAX(geometry->width, 1) - 1);
+    range->y2 = cell_coordinate
+        (geometry->y + (int32_t) MAX(geometry->height, 1) - 1);
+    range->x2 = MIN(range->x2, range->x1 + MASK);
+    range->y2 = MIN(range->y2, range->y1 + MASK);
+}
+
+void swc_grid_initialize(struct swc_grid * grid)
+{
+    uint32_t index;
+
+    for (index = 0; index < SWC_GRID_SIZE * SWC_GRID_SIZE; ++index)
+        wl_array_init(&grid->cells[index].entries);
+}
+
+void swc_grid_finalize(struct swc_grid * grid)
+{
+    uint32_t index;
+
+    for (index = 0; index < SWC_GRID_SIZE * SWC_GRID_SIZE; ++index)
+        wl_array_release(&grid->cells[index].entries);
+}
+
+static bool cell_insert(struct swc_grid_cell * cell,
+                        struct swc_grid_entry * entry)
+{
+    struct swc_grid_entry ** entries, ** position;
+    size_t count;
+
+    if (!wl_array_add(&cell->entries, sizeof entry))
+        return false;
+
+    entries = cell->entries.data;
+    count = cell->entries.size / sizeof entry;
+
+    /* Keep the entries sorted from top to bottom. New entries are usually
+     * on top, so search from the front. */
+    for (position = entries; position < entries + count - 1; ++position)
+    {
+        if ((*position)->order < entry->order)
+            break;
+    }
+
+    memmove(position + 1, position,
+            (entries + count - 1 - position) * sizeof entry);
+    *position = entry;
+
+    return true;
+}
+
+static void cell_remove(struct swc_grid_cell * cell,
+                        struct swc_grid_entry * entry)
+{
+    struct swc_grid_entry ** position;
+
+    wl_array_for_each(position, &cell->entries)
+    {
+        if (*position == entry)
+        {
+            swc_array_remove(&cell->entries, position, sizeof entry);
+            break;
+        }
+    }
+}
+
+void swc_grid_insert(struct swc_grid * grid, struct swc_grid_entry * entry,
+                     const struct swc_rectangle * geometry)
+{
+    struct range range;
+    int32_t x, y;
+
+    if (entry->inserted)
+        swc_grid_remove(grid, entry);
+
+    entry->geometry = *geometry;
+    entry->inserted = true;
+    get_range(entry, &range);
+
+    for (y = range.y1; y <= range.y2; ++y)
+    {
+        for (x = range.x1; x <= range.x2; ++x)
+        {
+            if (!cell_insert(cell(grid, x, y), entry))
+                WARNING("Could not add entry to grid cell\n");
+        }
+    }
+}
+
+void swc_grid_remove(struct swc_grid * grid, struct swc_grid_entry * entry)
+{
+    struct range range;
+    int32_t x, y;
+
+    if (!entry->inserted)
+        return;
+
+    get_range(entry, &range);
+
+    for (y = range.y1; y <= range.y2; ++y)
+    {
+        for (x = range.x1; x <= range.x2; ++x)
+            cell_remove(cell(grid, x, y), entry);
+    }
+
+    entry->inserted = false;
+}
+
+struct swc_grid_cell * swc_grid_get_cell(struct swc_grid * grid,
+                                         int32_t x, int32_t y)
+{
+    return cell(grid, cell_coordinate(x), cell_coordinate(y));
+}
+
@@ -0,0 +1,76 @@
+/* swc: libswc/grid.h
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SWC_GRID_H
+#define SWC_GRID_H
+
+#include "swc.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <wayland-util.h>
+
+/* The grid wraps around every SWC_GRID_SIZE cells in each direction, so
+ * rectangles far apart may share a cell. Lookups still check the actual
+ * geometry. */
+#define SWC_GRID_SIZE 32
+#define SWC_GRID_CELL_SHIFT 8
+
+/**
+ * A uniform grid indexing stacked rectangles, used to quickly find the
+ * rectangles that may contain a point.
+ */
+struct swc_grid
+{
+    struct swc_grid_cell
+    {
+        /* Pointers to the entries overlapping this cell, topmost first. */
+        struct wl_array entries;
+    } cells[SWC_GRID_SIZE * SWC_GRID_SIZE];
+};
+
+struct swc_grid_entry
+{
+    struct swc_rectangle geometry;
+
+    /* Entries with a higher order are stacked above lower ones. */
+    uint64_t order;
+
+    bool inserted;
+};
+
+void swc_grid_initialize(struct swc_grid * grid);
+void swc_grid_finalize(struct swc_grid * grid);
+
+void swc_grid_insert(struct swc_grid * grid, struct swc_grid_entry * entry,
+                     const struct swc_rectangle * geometry);
+void swc_grid_remove(struct swc_grid * grid, struct swc_grid_entry * entry);
+
+/**
+ * Get the cell containing the given point.
+ */
+struct swc_grid_cell * swc_grid_get_cell(struct swc_grid * grid,
+                                         int32_t x, int32_t y);
+
+#endif
+
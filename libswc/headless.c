@@ -0,0 +1,168 @@
+/* swc: libswc/headless.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "headless.h"
+#include "drm.h"
+#include "internal.h"
+#include "output.h"
+#include "screen.h"
+#include "util.h"
+
+#include <stdlib.h>
+#include <wld/wld.h>
+#include <wld/pixman.h>
+
+#define DEFAULT_WIDTH 1024
+#define DEFAULT_HEIGHT 768
+#define DEFAULT_REFRESH 60
+
+/* Refresh rates are limited so that both the rate in mHz and the refresh
+ * interval in nanoseconds fit in 32 bits. */
+#define MIN_REFRESH 1
+#define MAX_REFRESH 1000000
+
+/* Screen IDs are used as bits in a 32-bit mask. */
+#define MAX_SCREENS 32
+
+bool swc_headless_initialize()
+{
+    if (!(swc.drm->context = wld_pixman_create_context()))
+    {
+        ERROR("Could not create pixman context\n");
+        goto error0;
+    }
+
+    if (!(swc.drm->renderer = wld_create_renderer(swc.drm->context)))
+    {
+        ERROR("Could not create pixman renderer\n");
+        goto error1;
+    }
+
+    swc.drm->fd = -1;
+    swc.drm->atomic = false;
+    swc.drm->monotonic = true;
+
+    return true;
+
+  error1:
+    wld_destroy_context(swc.drm->context);
+  error0:
+    return false;
+}
+
+void swc_headless_finalize()
+{
+    wld_destroy_renderer(swc.drm->renderer);
+    wld_destroy_context(swc.drm->context);
+}
+
+/* Parses WIDTHxHEIGHT[@REFRESH], and returns a pointer to the rest of the
+ * string. */
+static const char * parse_mode(const char * string, uint32_t * width,
+                               uint32_t * height, uint32_t * refresh)
+{
+    char * end;
+    double rate = DEFAULT_REFRESH;
+
+    *width = strtoul(string, &end, 10);
+
+    if (*end != 'x')
+        return NULL;
+
+    *height = strtoul(end + 1, &end, 10);
+
+    if (*end == '@')
+        rate = strtod(end + 1, &end);
+
+    if (*width == 0 || *width > UINT16_MAX || *height == 0
+        || *height > UINT16_MAX || !(rate >= MIN_REFRESH)
+        || !(rate <= MAX_REFRESH))
+    {
+        return NULL;
+    }
+
+    /* The refresh rate of modes is in mHz. */
+    *refresh = rate * 1000;
+
+    return end;
+}
+
+static bool create_screen(struct wl_list * screens, uint8_t id, uint32_t width,
+                          uint32_t height, uint32_t refresh)
+{
+    struct swc_output * output;
+
+    if (!(output = swc_output_new_headless(width, height, refresh)))
+        return false;
+
+    if (!(output->screen = screen_new(0, output)))
+    {
+        swc_output_destroy(output);
+        return false;
+    }
+
+    output->screen->id = id;
+    wl_list_insert(screens->prev, &output->screen->link);
+
+    DEBUG("Created headless screen %u: %ux%u at %u mHz\n",
+          id, width, height, refresh);
+
+    return true;
+}
+
+bool swc_headless_create_screens(struct wl_list * screens)
+{
+    const char * string = getenv("SWC_HEADLESS");
+    uint32_t width, height, refresh;
+    uint8_t id = 0;
+
+    if (!string || !*string)
+    {
+        return create_screen(screens, 0, DEFAULT_WIDTH, DEFAULT_HEIGHT,
+                             DEFAULT_REFRESH * 1000);
+    }
+
+    while (*string)
+    {
+        if (id == MAX_SCREENS)
+        {
+            WARNING("No more available output IDs\n");
+            break;
+        }
+
+        if (!(string = parse_mode(string, &width, &height, &refresh))
+            || (*string && *string++ != ','))
+        {
+            ERROR("Invalid headless screen list in SWC_HEADLESS\n");
+            return false;
+        }
+
+        if (!create_screen(screens, id, width, height, refresh))
+            return false;
+
+        ++id;
+    }
+
+    return true;
+}
+
@@ -0,0 +1,46 @@
+/* swc: libswc/headless.h
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SWC_HEADLESS_H
+#define SWC_HEADLESS_H
+
+#include <stdbool.h>
+
+struct wl_list;
+
+/**
+ * Set up rendering into memory with the pixman renderer, in place of the DRM
+ * device.
+ *
+ * The screens are described by the SWC_HEADLESS environment variable, as a
+ * comma-separated list of WIDTHxHEIGHT[@REFRESH], with the refresh rate in Hz
+ * (between 1 and 1000000).
+ * If it is empty, a single 1024x768 screen at 60 Hz is created.
+ */
+bool swc_headless_initialize();
+void swc_headless_finalize();
+
+bool swc_headless_create_screens(struct wl_list * screens);
+
+#endif
+
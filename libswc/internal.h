@@ -24,7 +24,38 @@
 #ifndef SWC_INTERNAL_H
 #define SWC_INTERNAL_H
 
+#include <stdbool.h>
 #include <wayland-util.h>
+#include <wld/wld.h>
+
+/* The types of the objects that swc's own exporters attach to WLD buffers.
+ * They all share the range WLD leaves for its users, so they are kept
+ * together here. */
+enum
+{
+    /* The DRM framebuffer created when a buffer is scanned out. */
+    WLD_USER_OBJECT_FRAMEBUFFER = WLD_USER_ID,
+
+    /* The buffer in the DRM context sharing the memory of a SHM buffer, if the
+     * SHM buffer could be imported. */
+    SWC_SHM_OBJECT_DRM_BUFFER,
+
+    /* The same as SWC_SHM_OBJECT_DATA, but only exported by SHM buffers in
+     * formats that must be converted before use. */
+    SWC_SHM_OBJECT_SOURCE,
+
+    /* The struct swc_dmabuf_layout describing the planes of a buffer that was
+     * imported with an explicit layout. */
+    SWC_DMABUF_OBJECT_LAYOUT,
+
+    /* The state of a buffer that belongs to a wl_buffer. */
+    WLD_USER_OBJECT_WAYLAND_BUFFER,
+
+    /* A struct swc_convert_source describing the client's pixel data, for all
+     * SHM buffers. Unlike the buffer's own mapping, it stays valid when the
+     * pool is resized. */
+    SWC_SHM_OBJECT_DATA
+};
 
 struct swc
 {
@@ -32,6 +63,10 @@ struct swc
     struct wl_event_loop * event_loop;
     const struct swc_manager * manager;
 
+    /* Whether the screens are virtual ones rendered into memory (see
+     * headless.h) rather than those of the DRM device. */
+    bool headless;
+
     struct udev * udev;
 
     struct swc_launch * const launch;
@@ -71,8 +71,13 @@ bool swc_launch_initialize()
 {
     char * socket_string, * end;
 
+    wl_signal_init(&swc.launch->event_signal);
+    launch.socket = -1;
+    launch.source = NULL;
+
+    /* Headless screens don't need any devices, so the launcher is optional. */
     if (!(socket_string = getenv(SWC_LAUNCH_SOCKET_ENV)))
-        return false;
+        return swc.headless;
 
     launch.socket = strtol(socket_string, &end, 10);
 
@@ -85,13 +90,14 @@ bool swc_launch_initialize()
     if (!launch.source)
         return false;
 
-    wl_signal_init(&swc.launch->event_signal);
-
     return true;
 }
 
 void swc_launch_finalize()
 {
+    if (launch.socket == -1)
+        return;
+
     wl_event_source_remove(launch.source);
     close(launch.socket);
 }
@@ -100,6 +106,9 @@ static bool send_request(struct swc_launch_request * request, size_t size,
                          struct swc_launch_event * event,
                          int out_fd, int * in_fd)
 {
+    if (launch.socket == -1)
+        return false;
+
     request->serial = ++launch.next_serial;
 
     if (send_fd(launch.socket, out_fd, request, size) == -1)
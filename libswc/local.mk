@@ -30,34 +30,48 @@ SWC_SOURCES =                       \
     launch/protocol.c               \
     libswc/bindings.c               \
     libswc/compositor.c             \
+    libswc/convert.c                \
     libswc/cursor_plane.c           \
+    libswc/damage.c                 \
     libswc/data.c                   \
     libswc/data_device.c            \
     libswc/data_device_manager.c    \
+    libswc/dmabuf.c                 \
     libswc/drm.c                    \
     libswc/evdev_device.c           \
     libswc/framebuffer_plane.c      \
+    libswc/grid.c                   \
+    libswc/headless.c               \
     libswc/input_focus.c            \
     libswc/keyboard.c               \
     libswc/launch.c                 \
     libswc/mode.c                   \
     libswc/output.c                 \
+    libswc/overlay_plane.c          \
     libswc/panel.c                  \
     libswc/panel_manager.c          \
     libswc/pointer.c                \
+    libswc/presentation.c           \
+    libswc/record.c                 \
     libswc/region.c                 \
     libswc/screen.c                 \
     libswc/seat.c                   \
     libswc/shell.c                  \
     libswc/shell_surface.c          \
     libswc/shm.c                    \
+    libswc/subcompositor.c          \
+    libswc/subsurface.c             \
     libswc/surface.c                \
     libswc/swc.c                    \
+    libswc/timing.c                 \
+    libswc/upload.c                 \
     libswc/util.c                   \
     libswc/view.c                   \
     libswc/wayland_buffer.c         \
     libswc/window.c                 \
     libswc/xkb.c                    \
+    protocol/linux-dmabuf-unstable-v1-protocol.c \
+    protocol/presentation-time-protocol.c \
     protocol/swc-protocol.c         \
     protocol/wayland-drm-protocol.c
 
@@ -84,16 +98,18 @@ SWC_SHARED_OBJECTS = $(SWC_SOURCES:%.c=%.lo)
 
 # Explicitly state dependencies on generated files
 objects = $(foreach obj,$(1),$(dir)/$(obj).o $(dir)/$(obj).lo)
+$(call objects,dmabuf): protocol/linux-dmabuf-unstable-v1-server-protocol.h
 $(call objects,drm drm_buffer): protocol/wayland-drm-server-protocol.h
 $(call objects,xserver): protocol/xserver-server-protocol.h
 $(call objects,panel_manager panel): protocol/swc-server-protocol.h
+$(call objects,presentation compositor framebuffer_plane surface): protocol/presentation-time-server-protocol.h
 $(call objects,pointer): cursor/cursor_data.h
 
 $(dir)/libswc.a: $(SWC_STATIC_OBJECTS)
 	$(call quiet,AR) cru $@ $^
 
 $(dir)/$(LIBSWC_LIB): $(SWC_SHARED_OBJECTS)
-	$(link) -shared -Wl,-soname,$(LIBSWC_SO) -Wl,-no-undefined $(libswc_PACKAGE_LIBS)
+	$(link) -shared -Wl,-soname,$(LIBSWC_SO) -Wl,-no-undefined $(libswc_PACKAGE_LIBS) -lpthread
 
 $(dir)/$(LIBSWC_SO): $(dir)/$(LIBSWC_LIB)
 	$(call quiet,SYM,ln -sf) $(notdir $<) $@
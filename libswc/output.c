@@ -56,11 +56,9 @@ static void bind_output(struct wl_client * client, void * data,
         wl_output_send_done(resource);
 }
 
-struct swc_output * swc_output_new(drmModeConnectorPtr connector)
+static struct swc_output * output_new(uint32_t num_modes)
 {
     struct swc_output * output;
-    struct swc_mode * modes;
-    uint32_t index;
 
     if (!(output = malloc(sizeof *output)))
     {
@@ -77,20 +75,39 @@ struct swc_output * swc_output_new(drmModeConnectorPtr connector)
         goto error1;
     }
 
-    output->physical_width = connector->mmWidth;
-    output->physical_height = connector->mmHeight;
-
     wl_list_init(&output->resources);
     wl_array_init(&output->modes);
     pixman_region32_init(&output->current_damage);
     pixman_region32_init(&output->previous_damage);
 
-    output->connector = connector->connector_id;
+    if (!wl_array_add(&output->modes, num_modes * sizeof(struct swc_mode)))
+        goto error2;
 
-    modes = wl_array_add(&output->modes, connector->count_modes * sizeof *modes);
+    output->preferred_mode = NULL;
 
-    if (!modes)
-        goto error2;
+    return output;
+
+  error2:
+    wl_global_destroy(output->global);
+  error1:
+    free(output);
+  error0:
+    return NULL;
+}
+
+struct swc_output * swc_output_new(drmModeConnectorPtr connector)
+{
+    struct swc_output * output;
+    struct swc_mode * modes;
+    uint32_t index;
+
+    if (!(output = output_new(connector->count_modes)))
+        return NULL;
+
+    output->physical_width = connector->mmWidth;
+    output->physical_height = connector->mmHeight;
+    output->connector = connector->connector_id;
+    modes = output->modes.data;
 
     for (index = 0; index < connector->count_modes; ++index)
     {
@@ -101,13 +118,29 @@ struct swc_output * swc_output_new(drmModeConnectorPtr connector)
     }
 
     return output;
+}
 
-  error2:
-    wl_global_destroy(output->global);
-  error1:
-    free(output);
-  error0:
-    return NULL;
+struct swc_output * swc_output_new_headless(uint16_t width, uint16_t height,
+                                            uint32_t refresh)
+{
+    struct swc_output * output;
+    struct swc_mode * mode;
+
+    if (!(output = output_new(1)))
+        return NULL;
+
+    output->physical_width = 0;
+    output->physical_height = 0;
+    output->connector = 0;
+    mode = output->modes.data;
+    memset(mode, 0, sizeof *mode);
+    mode->width = width;
+    mode->height = height;
+    mode->refresh = refresh;
+    mode->preferred = true;
+    output->preferred_mode = mode;
+
+    return output;
 }
 
 void swc_output_destroy(struct swc_output * output)
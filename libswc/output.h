@@ -29,6 +29,13 @@ struct swc_output
 };
 
 struct swc_output * swc_output_new(drmModeConnector * connector);
+
+/**
+ * Create an output for a headless screen with a single mode. The refresh rate
+ * is in mHz.
+ */
+struct swc_output * swc_output_new_headless(uint16_t width, uint16_t height,
+                                            uint32_t refresh);
 void swc_output_destroy(struct swc_output * output);
 
 #endif
@@ -0,0 +1,275 @@
+/* swc: libswc/overlay_plane.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "overlay_plane.h"
+#include "drm.h"
+#include "event.h"
+#include "framebuffer_plane.h"
+#include "internal.h"
+#include "launch.h"
+#include "util.h"
+#include "wayland_buffer.h"
+
+#include <errno.h>
+#include <libdrm/drm_fourcc.h>
+#include <wld/wld.h>
+#include <xf86drmMode.h>
+
+/* Stage the new state, keeping it only if the hardware accepts it along with
+ * the rest of the staged state of the CRTC. It is committed with the next
+ * frame. */
+static bool set_plane_atomic(struct swc_overlay_plane * plane,
+                             struct wld_buffer * buffer, int32_t x, int32_t y)
+{
+    struct swc_drm_plane * drm_plane = &plane->drm_plane;
+    struct wld_buffer * old_buffer = drm_plane->buffer;
+    int32_t old_x = drm_plane->x, old_y = drm_plane->y;
+    bool old_dirty = drm_plane->dirty, success;
+
+    if (old_buffer)
+        wld_buffer_reference(old_buffer);
+
+    swc_drm_plane_set(drm_plane, buffer,
+                      x - plane->origin->x, y - plane->origin->y);
+
+    if (!(success = swc_framebuffer_plane_test(plane->framebuffer)))
+    {
+        DEBUG("Overlay plane %u configuration rejected\n", plane->id);
+        swc_drm_plane_set(drm_plane, old_buffer, old_x, old_y);
+        drm_plane->dirty = old_dirty;
+    }
+
+    if (old_buffer)
+        wld_buffer_unreference(old_buffer);
+
+    return success;
+}
+
+static bool set_plane(struct swc_overlay_plane * plane,
+                      struct wld_buffer * buffer, int32_t x, int32_t y)
+{
+    uint32_t framebuffer;
+
+    if (plane->atomic)
+        return set_plane_atomic(plane, buffer, x, y);
+
+    if (!buffer)
+    {
+        if (drmModeSetPlane(swc.drm->fd, plane->id, plane->crtc, 0, 0,
+                            0, 0, 0, 0, 0, 0, 0, 0) != 0)
+        {
+            ERROR("Could not disable overlay plane: %s\n", strerror(errno));
+            return false;
+        }
+
+        return true;
+    }
+
+    if (!swc_drm_get_framebuffer(buffer, &framebuffer))
+        return false;
+
+    if (drmModeSetPlane(swc.drm->fd, plane->id, plane->crtc, framebuffer, 0,
+                        x - plane->origin->x, y - plane->origin->y,
+                        buffer->width, buffer->height,
+                        0, 0, buffer->width << 16, buffer->height << 16) != 0)
+    {
+        ERROR("Could not set overlay plane: %s\n", strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+static void retire_buffer(struct swc_overlay_plane * plane)
+{
+    if (!plane->retired)
+        return;
+
+    swc_wayland_buffer_end_scanout(plane->retired);
+    wld_buffer_unreference(plane->retired);
+    plane->retired = NULL;
+}
+
+static bool update(struct swc_view * view)
+{
+    return true;
+}
+
+static bool attach(struct swc_view * view, struct wld_buffer * buffer)
+{
+    struct swc_overlay_plane * plane = CONTAINER_OF(view, typeof(*plane), view);
+
+    if (!set_plane(plane, buffer, view->geometry.x, view->geometry.y))
+        return false;
+
+    /* The DRM plane tracks the buffers of atomic commits. With the legacy
+     * interface, the replaced buffer is kept until the CRTC flips. */
+    if (!plane->atomic)
+    {
+        if (buffer)
+            swc_wayland_buffer_begin_scanout(buffer);
+
+        if (view->buffer)
+        {
+            retire_buffer(plane);
+            wld_buffer_reference(view->buffer);
+            plane->retired = view->buffer;
+        }
+    }
+
+    swc_view_set_size_from_buffer(view, buffer);
+
+    return true;
+}
+
+static bool move(struct swc_view * view, int32_t x, int32_t y)
+{
+    struct swc_overlay_plane * plane = CONTAINER_OF(view, typeof(*plane), view);
+
+    if (view->buffer && !set_plane(plane, view->buffer, x, y))
+        return false;
+
+    swc_view_set_position(view, x, y);
+
+    return true;
+}
+
+static const struct swc_view_impl view_impl = {
+    .update = &update,
+    .attach = &attach,
+    .move = &move
+};
+
+static void handle_launch_event(struct wl_listener * listener, void * data)
+{
+    struct swc_event * event = data;
+    struct swc_overlay_plane * plane
+        = CONTAINER_OF(listener, typeof(*plane), launch_listener);
+
+    switch (event->type)
+    {
+        case SWC_LAUNCH_EVENT_ACTIVATED:
+            set_plane(plane, plane->view.buffer,
+                      plane->view.geometry.x, plane->view.geometry.y);
+            break;
+    }
+}
+
+static void handle_framebuffer_event(struct wl_listener * listener,
+                                     void * data)
+{
+    struct swc_event * event = data;
+    struct swc_overlay_plane * plane
+        = CONTAINER_OF(listener, typeof(*plane), framebuffer_listener);
+
+    switch (event->type)
+    {
+        case SWC_VIEW_EVENT_FRAME:
+            retire_buffer(plane);
+            break;
+    }
+}
+
+struct swc_overlay_plane * swc_overlay_plane_new
+    (uint32_t id, struct swc_framebuffer_plane * framebuffer,
+     const struct swc_drm_format * formats, uint32_t num_formats,
+     const struct swc_rectangle * origin)
+{
+    struct swc_overlay_plane * plane;
+    struct swc_drm_format * plane_formats;
+
+    if (!(plane = malloc(sizeof *plane)))
+        goto error0;
+
+    wl_array_init(&plane->formats);
+    plane_formats = wl_array_add(&plane->formats,
+                                 num_formats * sizeof formats[0]);
+
+    if (!plane_formats)
+        goto error1;
+
+    memcpy(plane_formats, formats, num_formats * sizeof formats[0]);
+
+    plane->atomic = framebuffer->atomic
+        && swc_drm_plane_initialize(&plane->drm_plane, id);
+
+    if (plane->atomic)
+        swc_framebuffer_plane_add_plane(framebuffer, &plane->drm_plane);
+
+    plane->id = id;
+    plane->crtc = framebuffer->crtc;
+    plane->framebuffer = framebuffer;
+    plane->origin = origin;
+    plane->retired = NULL;
+    plane->launch_listener.notify = &handle_launch_event;
+    wl_signal_add(&swc.launch->event_signal, &plane->launch_listener);
+    plane->framebuffer_listener.notify = &handle_framebuffer_event;
+    wl_signal_add(&framebuffer->view.event_signal,
+                  &plane->framebuffer_listener);
+    swc_view_initialize(&plane->view, &view_impl);
+
+    return plane;
+
+  error1:
+    wl_array_release(&plane->formats);
+    free(plane);
+  error0:
+    return NULL;
+}
+
+void swc_overlay_plane_destroy(struct swc_overlay_plane * plane)
+{
+    /* The plane won't be around for the next commit, so disable it right
+     * away. */
+    if (plane->atomic)
+        swc_drm_plane_finalize(&plane->drm_plane);
+    else if (plane->view.buffer)
+        swc_wayland_buffer_end_scanout(plane->view.buffer);
+
+    plane->atomic = false;
+    set_plane(plane, NULL, 0, 0);
+    retire_buffer(plane);
+    wl_list_remove(&plane->launch_listener.link);
+    wl_list_remove(&plane->framebuffer_listener.link);
+    swc_view_finalize(&plane->view);
+    wl_array_release(&plane->formats);
+    free(plane);
+}
+
+bool swc_overlay_plane_supports_format(struct swc_overlay_plane * plane,
+                                       uint32_t format, uint64_t modifier)
+{
+    struct swc_drm_format * plane_format;
+
+    wl_array_for_each(plane_format, &plane->formats)
+    {
+        if (plane_format->format == format
+            && (modifier == DRM_FORMAT_MOD_INVALID
+                || plane_format->modifier == modifier))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
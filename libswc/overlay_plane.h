@@ -0,0 +1,76 @@
+/* swc: libswc/overlay_plane.h
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SWC_OVERLAY_PLANE_H
+#define SWC_OVERLAY_PLANE_H
+
+#include "drm.h"
+#include "view.h"
+
+struct swc_framebuffer_plane;
+
+/**
+ * An overlay plane is a hardware plane that is blended on top of the
+ * framebuffer plane by the display controller. Views placed on an overlay
+ * plane don't need to be composited.
+ */
+struct swc_overlay_plane
+{
+    struct swc_view view;
+    const struct swc_rectangle * origin;
+    uint32_t id;
+    uint32_t crtc;
+
+    /* The formats the plane supports, as struct swc_drm_format. */
+    struct wl_array formats;
+    struct wl_listener launch_listener;
+    struct wl_list link;
+
+    /* The framebuffer plane of the CRTC, which commits this plane's state if
+     * atomic is true. */
+    struct swc_framebuffer_plane * framebuffer;
+    bool atomic;
+    struct swc_drm_plane drm_plane;
+
+    /* Otherwise, the buffer the plane displayed before its current one, which
+     * may be scanned out until the next page flip of the CRTC. */
+    struct wld_buffer * retired;
+    struct wl_listener framebuffer_listener;
+};
+
+struct swc_overlay_plane * swc_overlay_plane_new
+    (uint32_t id, struct swc_framebuffer_plane * framebuffer,
+     const struct swc_drm_format * formats, uint32_t num_formats,
+     const struct swc_rectangle * origin);
+
+void swc_overlay_plane_destroy(struct swc_overlay_plane * plane);
+
+/**
+ * Determines whether the plane can display a buffer with the given format and
+ * modifier. Buffers with an implicit layout (DRM_FORMAT_MOD_INVALID) are
+ * assumed to be supported if the format is.
+ */
+bool swc_overlay_plane_supports_format(struct swc_overlay_plane * plane,
+                                       uint32_t format, uint64_t modifier);
+
+#endif
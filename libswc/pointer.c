@@ -22,6 +22,7 @@
  */
 
 #include "pointer.h"
+#include "convert.h"
 #include "event.h"
 #include "internal.h"
 #include "screen.h"
@@ -82,20 +83,49 @@ static bool update(struct swc_view * view)
     return true;
 }
 
+static void convert_cursor(struct wld_buffer * cursor,
+                           const struct swc_convert_source * source)
+{
+    uint32_t y, width = MIN(source->width, cursor->width),
+             height = MIN(source->height, cursor->height);
+
+    if (!wld_map(cursor))
+        return;
+
+    for (y = 0; y < height; ++y)
+    {
+        swc_convert_row(source, (uint32_t *) ((char *) cursor->map
+                                              + y * cursor->pitch),
+                        0, y, width);
+    }
+
+    wld_unmap(cursor);
+}
+
 static bool attach(struct swc_view * view, struct wld_buffer * buffer)
 {
     struct swc_pointer * pointer
         = CONTAINER_OF(view, typeof(*pointer), cursor.view);
     struct swc_surface * surface = pointer->cursor.surface;
+    union wld_object object;
 
     if (surface && !pixman_region32_not_empty(&surface->state.damage))
         return true;
 
     wld_set_target_buffer(swc.shm->renderer, pointer->cursor.buffer);
     wld_fill_rectangle(swc.shm->renderer, 0x00000000, 0, 0, 64, 64);
-    wld_copy_rectangle(swc.shm->renderer, buffer, 0, 0, 0, 0,
-                       buffer->width, buffer->height);
-    wld_flush(swc.shm->renderer);
+
+    if (wld_export(buffer, SWC_SHM_OBJECT_SOURCE, &object))
+    {
+        wld_flush(swc.shm->renderer);
+        convert_cursor(pointer->cursor.buffer, object.ptr);
+    }
+    else
+    {
+        wld_copy_rectangle(swc.shm->renderer, buffer, 0, 0, 0, 0,
+                           buffer->width, buffer->height);
+        wld_flush(swc.shm->renderer);
+    }
 
     if (surface)
         pixman_region32_clear(&surface->state.damage);
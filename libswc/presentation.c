@@ -0,0 +1,158 @@
+/* swc: libswc/presentation.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "presentation.h"
+#include "internal.h"
+#include "output.h"
+#include "screen.h"
+#include "surface.h"
+#include "util.h"
+#include "view.h"
+
+#include <time.h>
+#include <wayland-server.h>
+#include "protocol/presentation-time-server-protocol.h"
+
+static struct
+{
+    struct wl_global * global;
+} presentation;
+
+static void destroy(struct wl_client * client, struct wl_resource * resource)
+{
+    wl_resource_destroy(resource);
+}
+
+static void feedback(struct wl_client * client, struct wl_resource * resource,
+                     struct wl_resource * surface_resource, uint32_t id)
+{
+    struct swc_surface * surface = wl_resource_get_user_data(surface_resource);
+    struct wl_resource * feedback_resource;
+
+    feedback_resource = wl_resource_create
+        (client, &wp_presentation_feedback_interface, 1, id);
+
+    if (!feedback_resource)
+    {
+        wl_client_post_no_memory(client);
+        return;
+    }
+
+    wl_resource_set_implementation(feedback_resource, NULL, NULL,
+                                   &swc_remove_resource);
+    wl_list_insert(surface->pending.state.feedbacks.prev,
+                   wl_resource_get_link(feedback_resource));
+}
+
+static const struct wp_presentation_interface presentation_implementation = {
+    .destroy = &destroy,
+    .feedback = &feedback
+};
+
+static void bind_presentation(struct wl_client * client, void * data,
+                              uint32_t version, uint32_t id)
+{
+    struct wl_resource * resource;
+
+    if (version >= 1)
+        version = 1;
+
+    resource = wl_resource_create(client, &wp_presentation_interface,
+                                  version, id);
+
+    if (!resource)
+    {
+        wl_client_post_no_memory(client);
+        return;
+    }
+
+    wl_resource_set_implementation(resource, &presentation_implementation,
+                                   NULL, NULL);
+    wp_presentation_send_clock_id(resource, CLOCK_MONOTONIC);
+}
+
+static void send_sync_output(struct wl_resource * resource,
+                             struct screen * screen)
+{
+    struct wl_client * client = wl_resource_get_client(resource);
+    struct swc_output * output;
+    struct wl_resource * output_resource;
+
+    wl_list_for_each(output, &screen->outputs, link)
+    {
+        output_resource = wl_resource_find_for_client(&output->resources,
+                                                      client);
+
+        if (output_resource)
+        {
+            wp_presentation_feedback_send_sync_output(resource,
+                                                      output_resource);
+        }
+    }
+}
+
+void swc_presentation_present(struct wl_list * feedbacks,
+                              const struct swc_frame * frame)
+{
+    struct wl_resource * resource, * tmp;
+    uint64_t seconds = frame->time.tv_sec;
+
+    wl_list_for_each_safe(resource, tmp, feedbacks, link)
+    {
+        if (frame->screen)
+            send_sync_output(resource, frame->screen);
+
+        wp_presentation_feedback_send_presented
+            (resource, seconds >> 32, seconds & 0xffffffff,
+             frame->time.tv_nsec, frame->refresh,
+             frame->sequence >> 32, frame->sequence & 0xffffffff,
+             frame->flags);
+        wl_resource_destroy(resource);
+    }
+}
+
+void swc_presentation_discard(struct wl_list * feedbacks)
+{
+    struct wl_resource * resource, * tmp;
+
+    wl_list_for_each_safe(resource, tmp, feedbacks, link)
+    {
+        wp_presentation_feedback_send_discarded(resource);
+        wl_resource_destroy(resource);
+    }
+}
+
+bool swc_presentation_initialize()
+{
+    presentation.global = wl_global_create(swc.display,
+                                           &wp_presentation_interface, 1,
+                                           NULL, &bind_presentation);
+
+    return presentation.global != NULL;
+}
+
+void swc_presentation_finalize()
+{
+    wl_global_destroy(presentation.global);
+}
+
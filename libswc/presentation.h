@@ -0,0 +1,49 @@
+/* swc: libswc/presentation.h
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SWC_PRESENTATION_H
+#define SWC_PRESENTATION_H
+
+#include <stdbool.h>
+
+struct swc_frame;
+struct wl_list;
+
+bool swc_presentation_initialize();
+void swc_presentation_finalize();
+
+/**
+ * Send the timing of the frame to a list of wp_presentation_feedback
+ * resources, which are then destroyed.
+ */
+void swc_presentation_present(struct wl_list * feedbacks,
+                              const struct swc_frame * frame);
+
+/**
+ * Tell a list of wp_presentation_feedback resources that their content update
+ * was never displayed, and destroy them.
+ */
+void swc_presentation_discard(struct wl_list * feedbacks);
+
+#endif
+
@@ -0,0 +1,352 @@
+/* swc: libswc/record.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "record.h"
+#include "convert.h"
+#include "internal.h"
+#include "shm.h"
+#include "surface.h"
+#include "util.h"
+#include "wayland_buffer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wayland-server.h>
+
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof(array[0]))
+
+struct client
+{
+    unsigned id;
+    struct wl_listener destroy_listener;
+};
+
+static struct
+{
+    FILE * file;
+    bool contents;
+    uint64_t start;
+    unsigned next_client_id;
+    struct wl_protocol_logger * logger;
+} record;
+
+/* The interfaces whose requests are recorded. The rest (input, data devices,
+ * panels and so on) depend on state that a replay cannot reproduce. */
+static const char * interfaces[] = {
+    "wl_display", "wl_registry", "wl_compositor", "wl_region", "wl_surface",
+    "wl_shm", "wl_shm_pool", "wl_buffer", "wl_shell", "wl_shell_surface",
+    "wl_subcompositor", "wl_subsurface"
+};
+
+static void handle_client_destroy(struct wl_listener * listener, void * data)
+{
+    struct client * client
+        = CONTAINER_OF(listener, typeof(*client), destroy_listener);
+
+    /* Clients can outlive the recording. */
+    if (record.file)
+    {
+        fprintf(record.file, "%" PRIu64 " %u @disconnect\n",
+                swc_time_nsec() - record.start, client->id);
+    }
+
+    free(client);
+}
+
+static unsigned client_id(struct wl_client * wl_client)
+{
+    struct wl_listener * listener;
+    struct client * client;
+
+    listener = wl_client_get_destroy_listener(wl_client,
+                                              &handle_client_destroy);
+
+    if (listener)
+        return CONTAINER_OF(listener, typeof(*client), destroy_listener)->id;
+
+    if (!(client = malloc(sizeof *client)))
+        return 0;
+
+    client->id = ++record.next_client_id;
+    client->destroy_listener.notify = &handle_client_destroy;
+    wl_client_add_destroy_listener(wl_client, &client->destroy_listener);
+
+    return client->id;
+}
+
+static bool is_recorded(struct wl_resource * resource)
+{
+    const char * name = wl_resource_get_class(resource);
+    unsigned index;
+
+    for (index = 0; index < ARRAY_SIZE(interfaces); ++index)
+    {
+        if (strcmp(name, interfaces[index]) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+static uint32_t object_id(struct wl_object * object)
+{
+    return object ? wl_resource_get_id((struct wl_resource *) object) : 0;
+}
+
+static void write_string(const char * string)
+{
+    if (!string)
+    {
+        fputs(" nil", record.file);
+        return;
+    }
+
+    fputs(" \"", record.file);
+
+    for (; *string; ++string)
+    {
+        if (*string == '"' || *string == '\\')
+            fprintf(record.file, "\\%c", *string);
+        else if ((unsigned char) *string < 0x20 || *string == 0x7f)
+            fprintf(record.file, "\\x%02x", (unsigned char) *string);
+        else
+            fputc(*string, record.file);
+    }
+
+    fputc('"', record.file);
+}
+
+static void write_array(const struct wl_array * array)
+{
+    const unsigned char * byte;
+
+    fputc(' ', record.file);
+
+    if (!array || array->size == 0)
+    {
+        fputc('-', record.file);
+        return;
+    }
+
+    for (byte = array->data; byte < (unsigned char *) array->data + array->size;
+         ++byte)
+    {
+        fprintf(record.file, "%02x", *byte);
+    }
+}
+
+static void write_arguments(const struct wl_message * message,
+                            const union wl_argument * arguments)
+{
+    const char * signature = message->signature;
+
+    for (; *signature; ++signature)
+    {
+        switch (*signature)
+        {
+            case 'i':
+                fprintf(record.file, " %" PRId32, arguments->i);
+                break;
+            case 'u':
+                fprintf(record.file, " %" PRIu32, arguments->u);
+                break;
+            case 'f':
+                fprintf(record.file, " %" PRId32, arguments->f);
+                break;
+            case 's':
+                write_string(arguments->s);
+                break;
+            case 'o':
+                fprintf(record.file, " %" PRIu32, object_id(arguments->o));
+                break;
+            case 'n':
+                fprintf(record.file, " %" PRIu32, arguments->n);
+                break;
+            case 'a':
+                write_array(arguments->a);
+                break;
+            case 'h':
+                fputs(" fd", record.file);
+                break;
+            default:
+                /* Version and nullability markers. */
+                continue;
+        }
+
+        ++arguments;
+    }
+}
+
+/* FNV-1a */
+static uint64_t hash(const uint8_t * data, size_t size)
+{
+    uint64_t value = 0xcbf29ce484222325;
+
+    while (size--)
+        value = (value ^ *data++) * 0x100000001b3;
+
+    return value;
+}
+
+static void write_base64(const uint8_t * data, size_t size)
+{
+    static const char digits[]
+        = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    uint32_t bits;
+    size_t index;
+
+    fputc(' ', record.file);
+
+    for (index = 0; index + 3 <= size; index += 3)
+    {
+        bits = data[index] << 16 | data[index + 1] << 8 | data[index + 2];
+        fputc(digits[bits >> 18], record.file);
+        fputc(digits[bits >> 12 & 0x3f], record.file);
+        fputc(digits[bits >> 6 & 0x3f], record.file);
+        fputc(digits[bits & 0x3f], record.file);
+    }
+
+    if (index < size)
+    {
+        bits = data[index] << 16;
+        if (index + 1 < size)
+            bits |= data[index + 1] << 8;
+
+        fputc(digits[bits >> 18], record.file);
+        fputc(digits[bits >> 12 & 0x3f], record.file);
+        fputc(index + 1 < size ? digits[bits >> 6 & 0x3f] : '=', record.file);
+        fputc('=', record.file);
+    }
+}
+
+/* The logger sees requests before they are dispatched, so the contents of a
+ * newly attached buffer are recorded ahead of the commit that latches it. */
+static void write_contents(uint64_t time, unsigned client,
+                           struct wl_resource * resource)
+{
+    struct swc_surface * surface = wl_resource_get_user_data(resource);
+    struct wl_resource * buffer_resource;
+    struct wld_buffer * buffer;
+    const struct swc_convert_source * source;
+    union wld_object object;
+    size_t size;
+
+    if (!(surface->pending.commit & SWC_SURFACE_COMMIT_ATTACH))
+        return;
+
+    buffer_resource = surface->pending.state.buffer_resource;
+
+    /* Only SHM buffers can be recreated by a replay. */
+    if (!buffer_resource || !(buffer = swc_wayland_buffer_get(buffer_resource))
+        || !wld_export(buffer, SWC_SHM_OBJECT_DATA, &object))
+    {
+        return;
+    }
+
+    source = object.ptr;
+    size = swc_convert_size(source->format, source->pitch, source->height);
+    fprintf(record.file, "%" PRIu64 " %u @content %" PRIu32 " %" PRIu32
+            " %" PRIu32 " %" PRIu32 " %" PRIu32 " %016" PRIx64,
+            time, client, wl_resource_get_id(buffer_resource),
+            source->width, source->height, source->pitch, source->format,
+            hash(source->data, size));
+    if (record.contents)
+        write_base64(source->data, size);
+
+    fputc('\n', record.file);
+}
+
+static void log_request(void * data, enum wl_protocol_logger_type direction,
+                        const struct wl_protocol_logger_message * message)
+{
+    struct wl_resource * resource = message->resource;
+    uint64_t time;
+    unsigned client;
+
+    if (direction != WL_PROTOCOL_LOGGER_REQUEST || !is_recorded(resource))
+        return;
+
+    time = swc_time_nsec() - record.start;
+    client = client_id(wl_resource_get_client(resource));
+
+    if (strcmp(wl_resource_get_class(resource), "wl_surface") == 0
+        && strcmp(message->message->name, "commit") == 0)
+    {
+        write_contents(time, client, resource);
+    }
+
+    fprintf(record.file, "%" PRIu64 " %u %s@%" PRIu32 ".%s",
+            time, client, wl_resource_get_class(resource),
+            wl_resource_get_id(resource), message->message->name);
+    write_arguments(message->message, message->arguments);
+    fputc('\n', record.file);
+}
+
+bool swc_record_initialize()
+{
+    const char * path = getenv("SWC_RECORD");
+
+    record.file = NULL;
+
+    if (!path)
+        return true;
+
+    if (!(record.file = fopen(path, "w")))
+    {
+        ERROR("Could not open recording file %s\n", path);
+        goto error0;
+    }
+
+    record.logger = wl_display_add_protocol_logger(swc.display, &log_request,
+                                                   NULL);
+
+    if (!record.logger)
+    {
+        ERROR("Could not add protocol logger\n");
+        goto error1;
+    }
+
+    record.contents = getenv("SWC_RECORD_CONTENTS") != NULL;
+    record.start = swc_time_nsec();
+    record.next_client_id = 0;
+
+    return true;
+
+  error1:
+    fclose(record.file);
+    record.file = NULL;
+  error0:
+    return false;
+}
+
+void swc_record_finalize()
+{
+    if (!record.file)
+        return;
+
+    wl_protocol_logger_destroy(record.logger);
+    fclose(record.file);
+    record.file = NULL;
+}
+
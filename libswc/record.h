@@ -0,0 +1,51 @@
+/* swc: libswc/record.h
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SWC_RECORD_H
+#define SWC_RECORD_H
+
+#include <stdbool.h>
+
+/**
+ * Start recording client requests if the SWC_RECORD environment variable
+ * names a file to write them to.
+ *
+ * Each line of the recording holds one request, as
+ *
+ *     TIME CLIENT INTERFACE@ID.REQUEST ARGUMENTS...
+ *
+ * with TIME in nanoseconds since recording started. Only the requests needed
+ * to reproduce what clients draw are recorded: those to the core compositor,
+ * surface, region, shm and shell interfaces. Before each wl_surface.commit
+ * that attaches a shm buffer, a line
+ *
+ *     TIME CLIENT @content BUFFER WIDTH HEIGHT STRIDE FORMAT HASH [DATA]
+ *
+ * describes the buffer contents by a hash, followed by the contents
+ * themselves in base64 if SWC_RECORD_CONTENTS is set.
+ */
+bool swc_record_initialize();
+void swc_record_finalize();
+
+#endif
+
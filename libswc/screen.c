@@ -24,6 +24,7 @@
 #include "screen.h"
 #include "drm.h"
 #include "event.h"
+#include "headless.h"
 #include "internal.h"
 #include "mode.h"
 #include "output.h"
@@ -38,8 +39,11 @@ bool screens_initialize()
 {
     wl_list_init(&swc.screens);
 
-    if (!swc_drm_create_screens(&swc.screens))
+    if (swc.headless ? !swc_headless_create_screens(&swc.screens)
+                     : !swc_drm_create_screens(&swc.screens))
+    {
         return false;
+    }
 
     if (wl_list_empty(&swc.screens))
         return false;
@@ -71,16 +75,21 @@ struct screen * screen_new(uint32_t crtc, struct swc_output * output)
     wl_list_init(&screen->outputs);
     wl_list_insert(&screen->outputs, &output->link);
     wl_list_init(&screen->modifiers);
-
-    if (!swc_framebuffer_plane_initialize(&screen->planes.framebuffer, crtc,
-                                          output->preferred_mode,
-                                          &output->connector, 1))
+    wl_list_init(&screen->planes.overlays);
+
+    if (swc.headless
+        ? !swc_framebuffer_plane_initialize_headless
+            (&screen->planes.framebuffer, output->preferred_mode)
+        : !swc_framebuffer_plane_initialize(&screen->planes.framebuffer, crtc,
+                                            output->preferred_mode,
+                                            &output->connector, 1))
     {
         ERROR("Failed to initialize framebuffer plane\n");
         goto error1;
     }
 
-    if (!swc_cursor_plane_initialize(&screen->planes.cursor, crtc,
+    if (!swc_cursor_plane_initialize(&screen->planes.cursor,
+                                     &screen->planes.framebuffer,
                                      &screen->base.geometry))
     {
         ERROR("Failed to initialize cursor plane\n");
@@ -106,9 +115,15 @@ struct screen * screen_new(uint32_t crtc, struct swc_output * output)
 void screen_destroy(struct screen * screen)
 {
     struct swc_output * output, * next;
+    struct swc_overlay_plane * overlay, * next_overlay;
 
     wl_list_for_each_safe(output, next, &screen->outputs, link)
         swc_output_destroy(output);
+    wl_list_for_each_safe(overlay, next_overlay,
+                          &screen->planes.overlays, link)
+    {
+        swc_overlay_plane_destroy(overlay);
+    }
     swc_framebuffer_plane_finalize(&screen->planes.framebuffer);
     swc_cursor_plane_finalize(&screen->planes.cursor);
     free(screen);
@@ -27,6 +27,7 @@
 #include "swc.h"
 #include "cursor_plane.h"
 #include "framebuffer_plane.h"
+#include "overlay_plane.h"
 
 #include <wayland-util.h>
 
@@ -56,6 +57,10 @@ struct screen
     {
         struct swc_framebuffer_plane framebuffer;
         struct swc_cursor_plane cursor;
+
+        /* Overlay planes that are available to this screen, in order of
+         * preference. */
+        struct wl_list overlays;
     } planes;
 
     struct wl_list outputs;
@@ -409,7 +409,8 @@ bool swc_seat_initialize(const char * seat_name)
         goto error5;
 #endif
 
-    if (!add_devices())
+    /* Headless compositors may run without any input devices. */
+    if (!add_devices() && !swc.headless)
         goto error6;
 
     return true;
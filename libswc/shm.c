@@ -26,14 +26,21 @@
  */
 
 #include "shm.h"
+#include "convert.h"
+#include "drm.h"
 #include "internal.h"
 #include "util.h"
 #include "wayland_buffer.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h>
+#include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <unistd.h>
+#include <linux/udmabuf.h>
 #include <wayland-server.h>
+#include <wld/drm.h>
 #include <wld/pixman.h>
 #include <wld/wld.h>
 
@@ -42,6 +49,9 @@ struct swc_shm swc_shm;
 static struct
 {
     struct wl_global * global;
+
+    /* The udmabuf device, or -1 if it is not available. */
+    int udmabuf;
 } shm;
 
 struct pool
@@ -50,12 +60,31 @@ struct pool
     void * data;
     uint32_t size;
     unsigned references;
+
+    /* The memfd backing the pool if it can be imported into the DRM
+     * context, or -1. */
+    int fd;
 };
 
 struct pool_reference
 {
+    struct wld_exporter exporter;
     struct wld_destructor destructor;
     struct pool * pool;
+    uint32_t offset;
+
+    /* Whether the data is in a format that must be converted before use. */
+    bool converted;
+
+    /* Filled in when exported, since the pool may have moved. */
+    struct swc_convert_source source;
+};
+
+struct import
+{
+    struct wld_exporter exporter;
+    struct wld_destructor destructor;
+    struct wld_buffer * buffer;
 };
 
 static void unref_pool(struct wl_resource * resource)
@@ -65,6 +94,9 @@ static void unref_pool(struct wl_resource * resource)
     if (--pool->references > 0)
         return;
 
+    if (pool->fd != -1)
+        close(pool->fd);
+
     munmap(pool->data, pool->size);
     free(pool);
 }
@@ -77,6 +109,142 @@ static void handle_buffer_destroy(struct wld_destructor * destructor)
     unref_pool(reference->pool->resource);
 }
 
+static bool reference_export(struct wld_exporter * exporter,
+                             struct wld_buffer * buffer,
+                             uint32_t type, union wld_object * object)
+{
+    struct pool_reference * reference
+        = CONTAINER_OF(exporter, typeof(*reference), exporter);
+
+    switch (type)
+    {
+        case SWC_SHM_OBJECT_SOURCE:
+            if (!reference->converted)
+                return false;
+            /* fallthrough */
+        case SWC_SHM_OBJECT_DATA:
+            reference->source.data = (void *)((uintptr_t) reference->pool->data
+                                              + reference->offset);
+            object->ptr = &reference->source;
+            break;
+        default: return false;
+    }
+
+    return true;
+}
+
+static bool import_export(struct wld_exporter * exporter,
+                          struct wld_buffer * buffer,
+                          uint32_t type, union wld_object * object)
+{
+    struct import * import = CONTAINER_OF(exporter, typeof(*import), exporter);
+
+    switch (type)
+    {
+        case SWC_SHM_OBJECT_DRM_BUFFER:
+            object->ptr = import->buffer;
+            break;
+        default: return false;
+    }
+
+    return true;
+}
+
+static void import_destroy(struct wld_destructor * destructor)
+{
+    struct import * import
+        = CONTAINER_OF(destructor, typeof(*import), destructor);
+
+    wld_buffer_unreference(import->buffer);
+    free(import);
+}
+
+/**
+ * Determines whether a pool's file descriptor is a memfd that can be handed to
+ * udmabuf, which requires that it can't be shrunk, but can still be written.
+ */
+static bool pool_is_importable(int fd)
+{
+    int seals;
+
+    if (shm.udmabuf == -1)
+        return false;
+
+    seals = fcntl(fd, F_GET_SEALS);
+
+    return seals != -1 && seals & F_SEAL_SHRINK && !(seals & F_SEAL_WRITE);
+}
+
+/**
+ * Try to create a buffer in the DRM context sharing the memory of a SHM
+ * buffer, so the renderer can read from it without a proxy copy.
+ *
+ * This is best effort; if it fails, the compositor falls back to copying the
+ * SHM buffer into a proxy.
+ */
+static void import_buffer(struct pool * pool, struct wld_buffer * buffer,
+                          uint32_t offset, uint32_t stride)
+{
+    struct import * import;
+    struct udmabuf_create create;
+    union wld_object object;
+    long page_size = sysconf(_SC_PAGESIZE);
+    uint32_t size;
+    int fd;
+
+    if (pool->fd == -1 || offset % page_size != 0)
+        return;
+
+    size = (stride * buffer->height + page_size - 1) & ~(page_size - 1);
+
+    if (offset + size > pool->size)
+        return;
+
+    create.memfd = pool->fd;
+    create.flags = UDMABUF_FLAGS_CLOEXEC;
+    create.offset = offset;
+    create.size = size;
+
+    if ((fd = ioctl(shm.udmabuf, UDMABUF_CREATE, &create)) == -1)
+    {
+        DEBUG("Could not create udmabuf: %s\n", strerror(errno));
+        return;
+    }
+
+    if (!(import = malloc(sizeof *import)))
+        goto error0;
+
+    object.i = fd;
+    import->buffer = wld_import_buffer(swc.drm->context,
+                                       WLD_DRM_OBJECT_PRIME_FD, object,
+                                       buffer->width, buffer->height,
+                                       buffer->format, stride);
+
+    if (!import->buffer)
+        goto error1;
+
+    if (!(wld_capabilities(swc.drm->renderer, import->buffer)
+          & WLD_CAPABILITY_READ))
+    {
+        goto error2;
+    }
+
+    close(fd);
+    import->exporter.export = &import_export;
+    wld_buffer_add_exporter(buffer, &import->exporter);
+    import->destructor.destroy = &import_destroy;
+    wld_buffer_add_destructor(buffer, &import->destructor);
+
+    return;
+
+  error2:
+    wld_buffer_unreference(import->buffer);
+  error1:
+    free(import);
+  error0:
+    close(fd);
+}
+
 static inline uint32_t format_shm_to_wld(uint32_t format)
 {
     switch (format)
@@ -90,6 +258,22 @@ static inline uint32_t format_shm_to_wld(uint32_t format)
     }
 }
 
+/**
+ * Create a buffer for pixel data in a format the renderers can't use.
+ *
+ * The buffer only stands in for the client's data, which is converted when it
+ * is copied into a proxy buffer, so its own pixels are never used. The data is
+ * found through the SWC_SHM_OBJECT_SOURCE export added by create_buffer.
+ */
+static struct wld_buffer * create_converted_buffer(int32_t width,
+                                                   int32_t height,
+                                                   uint32_t format)
+{
+    return wld_create_buffer
+        (swc.shm->context, width, height,
+         format_shm_to_wld(swc_convert_target_format(format)), 0);
+}
+
 static void create_buffer(struct wl_client * client,
                           struct wl_resource * resource, uint32_t id,
                           int32_t offset, int32_t width, int32_t height,
@@ -100,6 +284,15 @@ static void create_buffer(struct wl_client * client,
     struct wld_buffer * buffer;
     struct wl_resource * buffer_resource;
     union wld_object object;
+    bool native = format == WL_SHM_FORMAT_XRGB8888
+        || format == WL_SHM_FORMAT_ARGB8888;
+
+    if (!native && !swc_convert_is_supported(format))
+    {
+        wl_resource_post_error(resource, WL_SHM_ERROR_INVALID_FORMAT,
+                               "invalid format 0x%x", format);
+        return;
+    }
 
     if (offset > pool->size || offset < 0)
     {
@@ -108,10 +301,28 @@ static void create_buffer(struct wl_client * client,
         return;
     }
 
+    if (width <= 0 || height <= 0 || stride < 0
+        || stride < swc_convert_min_pitch(format, width)
+        || offset + swc_convert_size(format, stride, height) > pool->size)
+    {
+        wl_resource_post_error(resource, WL_SHM_ERROR_INVALID_STRIDE,
+                               "invalid width, height or stride (%dx%d, %d)",
+                               width, height, stride);
+        return;
+    }
+
     object.ptr = (void *)((uintptr_t) pool->data + offset);
-    buffer = wld_import_buffer(swc.shm->context, WLD_OBJECT_DATA, object,
-                               width, height, format_shm_to_wld(format),
-                               stride);
+
+    if (native)
+    {
+        buffer = wld_import_buffer(swc.shm->context, WLD_OBJECT_DATA, object,
+                                   width, height, format_shm_to_wld(format),
+                                   stride);
+    }
+    else
+    {
+        buffer = create_converted_buffer(width, height, format);
+    }
 
     if (!buffer)
         goto error0;
@@ -125,10 +336,21 @@ static void create_buffer(struct wl_client * client,
         goto error2;
 
     reference->pool = pool;
+    reference->offset = offset;
+    reference->converted = !native;
+    reference->source.format = format;
+    reference->source.pitch = stride;
+    reference->source.width = width;
+    reference->source.height = height;
+    reference->exporter.export = &reference_export;
+    wld_buffer_add_exporter(buffer, &reference->exporter);
     reference->destructor.destroy = &handle_buffer_destroy;
     wld_buffer_add_destructor(buffer, &reference->destructor);
     ++pool->references;
 
+    if (native)
+        import_buffer(pool, buffer, offset, stride);
+
     return;
 
   error2:
@@ -178,9 +400,12 @@ static void create_pool(struct wl_client * client,
     if (!(pool = malloc(sizeof *pool)))
     {
         wl_resource_post_no_memory(resource);
+        close(fd);
         return;
     }
 
+    pool->fd = -1;
+
     pool->resource = wl_resource_create(client, &wl_shm_pool_interface,
                                         wl_resource_get_version(resource), id);
 
@@ -204,12 +429,19 @@ static void create_pool(struct wl_client * client,
     pool->size = size;
     pool->references = 1;
 
+    /* Hold on to the file descriptor only if we may import it later. */
+    if (pool_is_importable(fd))
+        pool->fd = fd;
+    else
+        close(fd);
+
     return;
 
   error1:
     wl_resource_destroy(pool->resource);
   error0:
     free(pool);
+    close(fd);
 }
 
 static struct wl_shm_interface shm_implementation = {
@@ -229,10 +461,18 @@ static void bind_shm(struct wl_client * client, void * data, uint32_t version,
 
     wl_shm_send_format(resource, WL_SHM_FORMAT_XRGB8888);
     wl_shm_send_format(resource, WL_SHM_FORMAT_ARGB8888);
+    wl_shm_send_format(resource, WL_SHM_FORMAT_XBGR8888);
+    wl_shm_send_format(resource, WL_SHM_FORMAT_ABGR8888);
+    wl_shm_send_format(resource, WL_SHM_FORMAT_RGB565);
+    wl_shm_send_format(resource, WL_SHM_FORMAT_XRGB2101010);
+    wl_shm_send_format(resource, WL_SHM_FORMAT_YUYV);
+    wl_shm_send_format(resource, WL_SHM_FORMAT_NV12);
 }
 
 bool swc_shm_initialize()
 {
+    swc_convert_initialize();
+
     if (!(swc.shm->context = wld_pixman_create_context()))
         goto error0;
 
@@ -245,6 +485,9 @@ bool swc_shm_initialize()
     if (!shm.global)
         goto error2;
 
+    if ((shm.udmabuf = open("/dev/udmabuf", O_RDWR | O_CLOEXEC)) == -1)
+        DEBUG("udmabuf is not available, SHM buffers will be copied\n");
+
     return true;
 
   error2:
@@ -257,6 +500,9 @@ bool swc_shm_initialize()
 
 void swc_shm_finalize()
 {
+    if (shm.udmabuf != -1)
+        close(shm.udmabuf);
+
     wl_global_destroy(shm.global);
     wld_destroy_renderer(swc.shm->renderer);
     wld_destroy_context(swc.shm->context);
@@ -0,0 +1,113 @@
+/* swc: libswc/subcompositor.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "subcompositor.h"
+#include "internal.h"
+#include "subsurface.h"
+#include "surface.h"
+
+#include <wayland-server.h>
+
+static struct
+{
+    struct wl_global * global;
+} subcompositor;
+
+static void destroy(struct wl_client * client, struct wl_resource * resource)
+{
+    wl_resource_destroy(resource);
+}
+
+static void get_subsurface(struct wl_client * client,
+                           struct wl_resource * resource, uint32_t id,
+                           struct wl_resource * surface_resource,
+                           struct wl_resource * parent_resource)
+{
+    struct swc_surface * surface = wl_resource_get_user_data(surface_resource),
+                       * parent = wl_resource_get_user_data(parent_resource),
+                       * ancestor;
+    struct swc_subsurface * subsurface;
+
+    if (surface->subsurface || surface->view)
+    {
+        wl_resource_post_error(resource, WL_SUBCOMPOSITOR_ERROR_BAD_SURFACE,
+                               "wl_surface@%u already has a role",
+                               wl_resource_get_id(surface_resource));
+        return;
+    }
+
+    /* The parent can't be the surface itself, or one of its descendants. */
+    for (ancestor = parent; ancestor;
+         ancestor = ancestor->subsurface ? ancestor->subsurface->parent : NULL)
+    {
+        if (ancestor == surface)
+        {
+            wl_resource_post_error
+                (resource, WL_SUBCOMPOSITOR_ERROR_BAD_SURFACE,
+                 "wl_surface@%u is an ancestor of its parent wl_surface@%u",
+                 wl_resource_get_id(surface_resource),
+                 wl_resource_get_id(parent_resource));
+            return;
+        }
+    }
+
+    subsurface = swc_subsurface_new(client, wl_resource_get_version(resource),
+                                    id, surface, parent);
+
+    if (!subsurface)
+        wl_resource_post_no_memory(resource);
+}
+
+static const struct wl_subcompositor_interface subcompositor_implementation = {
+    .destroy = &destroy,
+    .get_subsurface = &get_subsurface
+};
+
+static void bind_subcompositor(struct wl_client * client, void * data,
+                               uint32_t version, uint32_t id)
+{
+    struct wl_resource * resource;
+
+    if (version >= 1)
+        version = 1;
+
+    resource = wl_resource_create(client, &wl_subcompositor_interface,
+                                  version, id);
+    wl_resource_set_implementation(resource, &subcompositor_implementation,
+                                   NULL, NULL);
+}
+
+bool swc_subcompositor_initialize()
+{
+    subcompositor.global = wl_global_create
+        (swc.display, &wl_subcompositor_interface, 1, NULL,
+         &bind_subcompositor);
+
+    return subcompositor.global;
+}
+
+void swc_subcompositor_finalize()
+{
+    wl_global_destroy(subcompositor.global);
+}
+
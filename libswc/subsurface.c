@@ -0,0 +1,268 @@
+/* swc: libswc/subsurface.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "subsurface.h"
+#include "compositor.h"
+#include "surface.h"
+#include "util.h"
+#include "view.h"
+
+#include <stdlib.h>
+
+/**
+ * Removes a subsurface from the stack of its parent, hiding it along with its
+ * own subsurfaces.
+ */
+static void detach(struct swc_subsurface * subsurface)
+{
+    if (!subsurface->parent)
+        return;
+
+    wl_list_remove(&subsurface->link);
+    wl_list_remove(&subsurface->pending_link);
+    wl_list_remove(&subsurface->parent_destroy_listener.link);
+    subsurface->parent = NULL;
+    swc_compositor_surface_hide(subsurface->surface);
+}
+
+/**
+ * Removes the subsurface role from its surface.
+ */
+static void release_surface(struct swc_subsurface * subsurface)
+{
+    if (!subsurface->surface)
+        return;
+
+    detach(subsurface);
+    wl_list_remove(&subsurface->surface_destroy_listener.link);
+    swc_compositor_remove_surface(subsurface->surface);
+    subsurface->surface->subsurface = NULL;
+    subsurface->surface = NULL;
+}
+
+static void destroy(struct wl_client * client, struct wl_resource * resource)
+{
+    wl_resource_destroy(resource);
+}
+
+static void set_position(struct wl_client * client,
+                         struct wl_resource * resource, int32_t x, int32_t y)
+{
+    struct swc_subsurface * subsurface = wl_resource_get_user_data(resource);
+
+    subsurface->pending_position.x = x;
+    subsurface->pending_position.y = y;
+    subsurface->pending_position.set = true;
+}
+
+static void place(struct wl_resource * resource,
+                  struct wl_resource * sibling_resource, bool above)
+{
+    struct swc_subsurface * subsurface = wl_resource_get_user_data(resource);
+    struct swc_surface * sibling = wl_resource_get_user_data(sibling_resource),
+                       * parent = subsurface->parent;
+    struct wl_list * link;
+
+    if (!parent)
+        return;
+
+    if (sibling == parent)
+        link = &parent->stack.pending_link;
+    else if (sibling->subsurface && sibling->subsurface != subsurface
+             && sibling->subsurface->parent == parent)
+    {
+        link = &sibling->subsurface->pending_link;
+    }
+    else
+    {
+        wl_resource_post_error(resource, WL_SUBSURFACE_ERROR_BAD_SURFACE,
+                               "wl_surface@%u is not a parent or sibling",
+                               wl_resource_get_id(sibling_resource));
+        return;
+    }
+
+    /* The stack is ordered from bottom to top. */
+    wl_list_remove(&subsurface->pending_link);
+    wl_list_insert(above ? link : link->prev, &subsurface->pending_link);
+    parent->pending.commit |= SWC_SURFACE_COMMIT_SUBSURFACES;
+}
+
+static void place_above(struct wl_client * client,
+                        struct wl_resource * resource,
+                        struct wl_resource * sibling_resource)
+{
+    place(resource, sibling_resource, true);
+}
+
+static void place_below(struct wl_client * client,
+                        struct wl_resource * resource,
+                        struct wl_resource * sibling_resource)
+{
+    place(resource, sibling_resource, false);
+}
+
+static void set_sync(struct wl_client * client, struct wl_resource * resource)
+{
+    struct swc_subsurface * subsurface = wl_resource_get_user_data(resource);
+
+    subsurface->synchronized = true;
+}
+
+static void set_desync(struct wl_client * client,
+                       struct wl_resource * resource)
+{
+    struct swc_subsurface * subsurface = wl_resource_get_user_data(resource);
+
+    if (!subsurface->synchronized)
+        return;
+
+    subsurface->synchronized = false;
+
+    /* Any cached state is applied right away, unless an ancestor is still
+     * synchronized. */
+    if (subsurface->surface && !swc_subsurface_is_synchronized(subsurface))
+        swc_surface_apply_cached(subsurface->surface);
+}
+
+static const struct wl_subsurface_interface subsurface_implementation = {
+    .destroy = &destroy,
+    .set_position = &set_position,
+    .place_above = &place_above,
+    .place_below = &place_below,
+    .set_sync = &set_sync,
+    .set_desync = &set_desync
+};
+
+static void handle_surface_destroy(struct wl_listener * listener, void * data)
+{
+    struct swc_subsurface * subsurface = CONTAINER_OF
+        (listener, typeof(*subsurface), surface_destroy_listener);
+
+    release_surface(subsurface);
+}
+
+static void handle_parent_destroy(struct wl_listener * listener, void * data)
+{
+    struct swc_subsurface * subsurface = CONTAINER_OF
+        (listener, typeof(*subsurface), parent_destroy_listener);
+
+    detach(subsurface);
+}
+
+static void destroy_subsurface(struct wl_resource * resource)
+{
+    struct swc_subsurface * subsurface = wl_resource_get_user_data(resource);
+
+    release_surface(subsurface);
+    free(subsurface);
+}
+
+struct swc_subsurface * swc_subsurface_new
+    (struct wl_client * client, uint32_t version, uint32_t id,
+     struct swc_surface * surface, struct swc_surface * parent)
+{
+    struct swc_subsurface * subsurface;
+
+    if (!(subsurface = malloc(sizeof *subsurface)))
+        goto error0;
+
+    subsurface->resource = wl_resource_create
+        (client, &wl_subsurface_interface, version, id);
+
+    if (!subsurface->resource)
+        goto error1;
+
+    if (!swc_compositor_add_surface(surface))
+        goto error2;
+
+    subsurface->surface = surface;
+    subsurface->parent = parent;
+    subsurface->x = 0;
+    subsurface->y = 0;
+    subsurface->pending_position.set = false;
+    subsurface->synchronized = true;
+    surface->subsurface = subsurface;
+
+    subsurface->surface_destroy_listener.notify = &handle_surface_destroy;
+    wl_resource_add_destroy_listener(surface->resource,
+                                     &subsurface->surface_destroy_listener);
+    subsurface->parent_destroy_listener.notify = &handle_parent_destroy;
+    wl_resource_add_destroy_listener(parent->resource,
+                                     &subsurface->parent_destroy_listener);
+
+    /* New subsurfaces are placed on top of the stack of their parent right
+     * away, rather than when the parent is committed. */
+    wl_list_insert(parent->stack.current.prev, &subsurface->link);
+    wl_list_insert(parent->stack.pending.prev, &subsurface->pending_link);
+
+    wl_resource_set_implementation(subsurface->resource,
+                                   &subsurface_implementation, subsurface,
+                                   &destroy_subsurface);
+
+    swc_subsurface_update_position(subsurface);
+    swc_compositor_surface_restack(parent);
+
+    return subsurface;
+
+  error2:
+    wl_resource_destroy(subsurface->resource);
+  error1:
+    free(subsurface);
+  error0:
+    return NULL;
+}
+
+bool swc_subsurface_is_synchronized(struct swc_subsurface * subsurface)
+{
+    /* Inert subsurfaces behave as if they were desynchronized. */
+    while (subsurface && subsurface->parent)
+    {
+        if (subsurface->synchronized)
+            return true;
+
+        subsurface = subsurface->parent->subsurface;
+    }
+
+    return false;
+}
+
+void swc_subsurface_update_position(struct swc_subsurface * subsurface)
+{
+    struct swc_surface * parent = subsurface->parent;
+
+    if (!parent || !parent->view || !subsurface->surface->view)
+        return;
+
+    swc_view_move(subsurface->surface->view,
+                  parent->view->geometry.x + subsurface->x,
+                  parent->view->geometry.y + subsurface->y);
+}
+
+struct swc_surface * swc_subsurface_get_root(struct swc_surface * surface)
+{
+    while (surface->subsurface && surface->subsurface->parent)
+        surface = surface->subsurface->parent;
+
+    return surface;
+}
+
@@ -0,0 +1,83 @@
+/* swc: libswc/subsurface.h
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SWC_SUBSURFACE_H
+#define SWC_SUBSURFACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <wayland-server.h>
+
+struct swc_surface;
+
+struct swc_subsurface
+{
+    struct wl_resource * resource;
+
+    /* The parent is NULL once it has been destroyed, and the surface once it
+     * has been destroyed, in which case the subsurface is inert. */
+    struct swc_surface * surface, * parent;
+    struct wl_listener surface_destroy_listener, parent_destroy_listener;
+
+    /* The position relative to the parent, and the position to take once the
+     * state of the parent is applied. */
+    int32_t x, y;
+
+    struct
+    {
+        int32_t x, y;
+        bool set;
+    } pending_position;
+
+    bool synchronized;
+
+    /* The entries of the subsurface in the current and pending stacking order
+     * of its parent. */
+    struct wl_list link, pending_link;
+};
+
+struct swc_subsurface * swc_subsurface_new
+    (struct wl_client * client, uint32_t version, uint32_t id,
+     struct swc_surface * surface, struct swc_surface * parent);
+
+/**
+ * Determines whether the state committed to the surface of a subsurface is
+ * cached until the state of its parent is applied, which is the case if the
+ * subsurface or any of its ancestors are in synchronized mode.
+ */
+bool swc_subsurface_is_synchronized(struct swc_subsurface * subsurface);
+
+/**
+ * Moves the view of a subsurface to its position relative to the view of its
+ * parent.
+ */
+void swc_subsurface_update_position(struct swc_subsurface * subsurface);
+
+/**
+ * Get the surface at the root of the tree of subsurfaces containing a
+ * surface.
+ */
+struct swc_surface * swc_subsurface_get_root(struct swc_surface * surface);
+
+#endif
+
@@ -22,11 +22,16 @@
  */
 
 #include "surface.h"
+#include "compositor.h"
+#include "damage.h"
+#include "dmabuf.h"
 #include "event.h"
 #include "internal.h"
 #include "output.h"
+#include "presentation.h"
 #include "region.h"
 #include "screen.h"
+#include "subsurface.h"
 #include "util.h"
 #include "view.h"
 #include "wayland_buffer.h"
@@ -56,6 +61,7 @@ static void state_initialize(struct swc_surface_state * state)
     pixman_region32_init_with_extents(&state->input, &infinite_extents);
 
     wl_list_init(&state->frame_callbacks);
+    wl_list_init(&state->feedbacks);
 }
 
 static void state_finish(struct swc_surface_state * state)
@@ -75,6 +81,8 @@ static void state_finish(struct swc_surface_state * state)
     /* Remove all leftover callbacks. */
     wl_list_for_each_safe(resource, tmp, &state->frame_callbacks, link)
         wl_resource_destroy(resource);
+
+    swc_presentation_discard(&state->feedbacks);
 }
 
 /**
@@ -134,6 +142,7 @@ static void damage(struct wl_client * client, struct wl_resource * resource,
     pixman_region32_union_rect(&surface->pending.state.damage,
                                &surface->pending.state.damage,
                                x, y, width, height);
+    swc_damage_simplify(&surface->pending.state.damage);
 }
 
 static void frame(struct wl_client * client, struct wl_resource * resource,
@@ -188,70 +197,202 @@ static void set_input_region(struct wl_client * client,
         pixman_region32_reset(&surface->pending.state.input, &infinite_extents);
 }
 
-static void commit(struct wl_client * client, struct wl_resource * resource)
+/**
+ * Applies the stacking order and positions of the subsurfaces of a surface,
+ * along with any state cached by synchronized subsurfaces, once the state of
+ * the surface itself is applied.
+ */
+static void apply_subsurfaces(struct swc_surface * surface, uint32_t commit)
+{
+    struct swc_subsurface * subsurface;
+    struct wl_list * link;
+
+    if (commit & SWC_SURFACE_COMMIT_SUBSURFACES)
+    {
+        /* Every entry in the pending order has one in the current order, so
+         * the current order can be rebuilt from scratch. */
+        wl_list_init(&surface->stack.current);
+
+        for (link = surface->stack.pending.next;
+             link != &surface->stack.pending; link = link->next)
+        {
+            if (link == &surface->stack.pending_link)
+            {
+                wl_list_insert(surface->stack.current.prev,
+                               &surface->stack.link);
+            }
+            else
+            {
+                subsurface = CONTAINER_OF(link, typeof(*subsurface),
+                                          pending_link);
+                wl_list_insert(surface->stack.current.prev, &subsurface->link);
+            }
+        }
+
+        swc_compositor_surface_restack(surface);
+    }
+
+    for (link = surface->stack.current.next;
+         link != &surface->stack.current; link = link->next)
+    {
+        if (link == &surface->stack.link)
+            continue;
+
+        subsurface = CONTAINER_OF(link, typeof(*subsurface), link);
+
+        if (subsurface->pending_position.set)
+        {
+            subsurface->x = subsurface->pending_position.x;
+            subsurface->y = subsurface->pending_position.y;
+            subsurface->pending_position.set = false;
+            swc_subsurface_update_position(subsurface);
+        }
+
+        swc_surface_apply_cached(subsurface->surface);
+    }
+}
+
+static void apply_state(struct swc_surface * surface,
+                        struct swc_surface_pending * pending)
 {
-    struct swc_surface * surface = wl_resource_get_user_data(resource);
     struct wld_buffer * buffer;
+    uint32_t commit = pending->commit;
 
     /* Attach */
-    if (surface->pending.commit & SWC_SURFACE_COMMIT_ATTACH)
+    if (commit & SWC_SURFACE_COMMIT_ATTACH)
     {
         if (surface->state.buffer
-            && surface->state.buffer != surface->pending.state.buffer)
+            && surface->state.buffer != pending->state.buffer)
         {
-            wl_buffer_send_release(surface->state.buffer_resource);
+            swc_wayland_buffer_release(surface->state.buffer_resource);
         }
 
-        state_set_buffer(&surface->state,
-                         surface->pending.state.buffer_resource);
+        /* The buffer may still be waiting to be released from a previous
+         * attachment, but is in use again. */
+        if (pending->state.buffer)
+            swc_wayland_buffer_cancel_release(pending->state.buffer);
+
+        state_set_buffer(&surface->state, pending->state.buffer_resource);
     }
 
     buffer = surface->state.buffer;
 
     /* Damage */
-    if (surface->pending.commit & SWC_SURFACE_COMMIT_DAMAGE)
+    if (commit & SWC_SURFACE_COMMIT_DAMAGE)
     {
-        pixman_region32_intersect_rect(&surface->pending.state.damage,
-                                       &surface->pending.state.damage, 0, 0,
+        pixman_region32_intersect_rect(&pending->state.damage,
+                                       &pending->state.damage, 0, 0,
                                        buffer ? buffer->width : 0,
                                        buffer ? buffer->height : 0);
         pixman_region32_union(&surface->state.damage, &surface->state.damage,
-                              &surface->pending.state.damage);
-        pixman_region32_clear(&surface->pending.state.damage);
+                              &pending->state.damage);
+        swc_damage_simplify(&surface->state.damage);
+        pixman_region32_clear(&pending->state.damage);
     }
 
     /* Opaque */
-    if (surface->pending.commit & SWC_SURFACE_COMMIT_OPAQUE)
+    if (commit & SWC_SURFACE_COMMIT_OPAQUE)
     {
         pixman_region32_intersect_rect(&surface->state.opaque,
-                                       &surface->pending.state.opaque, 0, 0,
+                                       &pending->state.opaque, 0, 0,
                                        buffer ? buffer->width : 0,
                                        buffer ? buffer->height : 0);
     }
 
     /* Input */
-    if (surface->pending.commit & SWC_SURFACE_COMMIT_INPUT)
-    {
-        pixman_region32_copy(&surface->state.input,
-                             &surface->pending.state.input);
-    }
+    if (commit & SWC_SURFACE_COMMIT_INPUT)
+        pixman_region32_copy(&surface->state.input, &pending->state.input);
 
     /* Frame */
-    if (surface->pending.commit & SWC_SURFACE_COMMIT_FRAME)
+    if (commit & SWC_SURFACE_COMMIT_FRAME)
     {
         wl_list_insert_list(&surface->state.frame_callbacks,
-                            &surface->pending.state.frame_callbacks);
-        wl_list_init(&surface->pending.state.frame_callbacks);
+                            &pending->state.frame_callbacks);
+        wl_list_init(&pending->state.frame_callbacks);
     }
 
+    /* Presentation feedback for the previous content update, if it hasn't
+     * made it into a frame yet, won't ever be. */
+    swc_presentation_discard(&surface->state.feedbacks);
+    wl_list_insert_list(&surface->state.feedbacks, &pending->state.feedbacks);
+    wl_list_init(&pending->state.feedbacks);
+
+    pending->commit = 0;
+    apply_subsurfaces(surface, commit);
+
     if (surface->view)
     {
-        if (surface->pending.commit & SWC_SURFACE_COMMIT_ATTACH)
+        if (commit & SWC_SURFACE_COMMIT_ATTACH)
             swc_view_attach(surface->view, surface->state.buffer);
         swc_view_update(surface->view);
     }
+}
 
-    surface->pending.commit = 0;
+/**
+ * Merges the pending state of a synchronized subsurface into its cached
+ * state, to be applied along with the state of its parent.
+ */
+static void cache_state(struct swc_surface * surface)
+{
+    struct swc_surface_pending * pending = &surface->pending,
+                               * cached = &surface->cached;
+
+    if (pending->commit & SWC_SURFACE_COMMIT_ATTACH)
+    {
+        /* A cached buffer that is replaced never makes it to the screen. */
+        if (cached->state.buffer
+            && cached->state.buffer != pending->state.buffer
+            && cached->state.buffer != surface->state.buffer)
+        {
+            swc_wayland_buffer_release(cached->state.buffer_resource);
+        }
+
+        state_set_buffer(&cached->state, pending->state.buffer_resource);
+        cached->x = pending->x;
+        cached->y = pending->y;
+    }
+
+    if (pending->commit & SWC_SURFACE_COMMIT_DAMAGE)
+    {
+        pixman_region32_union(&cached->state.damage, &cached->state.damage,
+                              &pending->state.damage);
+        swc_damage_simplify(&cached->state.damage);
+        pixman_region32_clear(&pending->state.damage);
+    }
+
+    if (pending->commit & SWC_SURFACE_COMMIT_OPAQUE)
+        pixman_region32_copy(&cached->state.opaque, &pending->state.opaque);
+
+    if (pending->commit & SWC_SURFACE_COMMIT_INPUT)
+        pixman_region32_copy(&cached->state.input, &pending->state.input);
+
+    if (pending->commit & SWC_SURFACE_COMMIT_FRAME)
+    {
+        wl_list_insert_list(cached->state.frame_callbacks.prev,
+                            &pending->state.frame_callbacks);
+        wl_list_init(&pending->state.frame_callbacks);
+    }
+
+    swc_presentation_discard(&cached->state.feedbacks);
+    wl_list_insert_list(&cached->state.feedbacks, &pending->state.feedbacks);
+    wl_list_init(&pending->state.feedbacks);
+
+    cached->commit |= pending->commit;
+    pending->commit = 0;
+    surface->has_cached_state = true;
+}
+
+static void commit(struct wl_client * client, struct wl_resource * resource)
+{
+    struct swc_surface * surface = wl_resource_get_user_data(resource);
+
+    if (surface->subsurface
+        && swc_subsurface_is_synchronized(surface->subsurface))
+    {
+        cache_state(surface);
+    }
+    else
+        apply_state(surface, &surface->pending);
 }
 
 void set_buffer_transform(struct wl_client * client,
@@ -285,6 +426,8 @@ static void surface_destroy(struct wl_resource * resource)
     /* Finish the surface. */
     state_finish(&surface->state);
     state_finish(&surface->pending.state);
+    state_finish(&surface->cached.state);
+    swc_dmabuf_surface_destroyed(surface);
 
     if (surface->view)
         wl_list_remove(&surface->view_listener.link);
@@ -308,7 +451,8 @@ static void handle_view_event(struct wl_listener * listener, void * data)
             wl_list_for_each_safe(resource, tmp,
                                   &surface->state.frame_callbacks, link)
             {
-                wl_callback_send_done(resource, event_data->frame.time);
+                wl_callback_send_done
+                    (resource, swc_timespec_to_msec(&event_data->frame.time));
                 wl_resource_destroy(resource);
             }
 
@@ -355,6 +499,9 @@ static void handle_view_event(struct wl_listener * listener, void * data)
                 (&surface->state.damage, &surface->state.damage, 0, 0,
                  surface->view->geometry.width, surface->view->geometry.height);
             break;
+        case SWC_VIEW_EVENT_SCANOUT_CHANGED:
+            swc_dmabuf_surface_feedback_changed(surface);
+            break;
     }
 }
 
@@ -377,12 +524,22 @@ struct swc_surface * swc_surface_new(struct wl_client * client,
 
     /* Initialize the surface. */
     surface->pending.commit = 0;
+    surface->cached.commit = 0;
+    surface->has_cached_state = false;
+    surface->subsurface = NULL;
     surface->window = NULL;
     surface->view = NULL;
     surface->view_listener.notify = &handle_view_event;
 
     state_initialize(&surface->state);
     state_initialize(&surface->pending.state);
+    state_initialize(&surface->cached.state);
+
+    wl_list_init(&surface->stack.current);
+    wl_list_init(&surface->stack.pending);
+    wl_list_insert(&surface->stack.current, &surface->stack.link);
+    wl_list_insert(&surface->stack.pending, &surface->stack.pending_link);
+    wl_list_init(&surface->dmabuf_feedbacks);
 
     /* Add the surface to the client. */
     surface->resource = wl_resource_create(client, &wl_surface_interface,
@@ -411,3 +568,12 @@ void swc_surface_set_view(struct swc_surface * surface, struct swc_view * view)
     }
 }
 
+void swc_surface_apply_cached(struct swc_surface * surface)
+{
+    if (!surface->has_cached_state)
+        return;
+
+    surface->has_cached_state = false;
+    apply_state(surface, &surface->cached);
+}
+
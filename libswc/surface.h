@@ -34,7 +34,8 @@ enum
     SWC_SURFACE_COMMIT_DAMAGE = (1 << 1),
     SWC_SURFACE_COMMIT_OPAQUE = (1 << 2),
     SWC_SURFACE_COMMIT_INPUT = (1 << 3),
-    SWC_SURFACE_COMMIT_FRAME = (1 << 4)
+    SWC_SURFACE_COMMIT_FRAME = (1 << 4),
+    SWC_SURFACE_COMMIT_SUBSURFACES = (1 << 5)
 };
 
 struct swc_surface_state
@@ -53,6 +54,20 @@ struct swc_surface_state
     pixman_region32_t input;
 
     struct wl_list frame_callbacks;
+
+    /* wp_presentation_feedback resources for the content update, until the
+     * compositor includes it in a frame. */
+    struct wl_list feedbacks;
+};
+
+/**
+ * State that has been requested by the client, but not yet applied.
+ */
+struct swc_surface_pending
+{
+    struct swc_surface_state state;
+    uint32_t commit;
+    int32_t x, y;
 };
 
 struct swc_surface
@@ -60,18 +75,33 @@ struct swc_surface
     struct wl_resource * resource;
 
     struct swc_surface_state state;
+    struct swc_surface_pending pending;
 
+    /* State committed by a synchronized subsurface, which is applied along
+     * with the state of its parent. */
+    struct swc_surface_pending cached;
+    bool has_cached_state;
+
+    /* The subsurface role of the surface, if it has one. */
+    struct swc_subsurface * subsurface;
+
+    /* The stacking order of the surface and its subsurfaces, from bottom to
+     * top. The surface itself is represented by the link fields. Changes are
+     * made to the pending order, which takes effect when the surface is
+     * committed. */
     struct
     {
-        struct swc_surface_state state;
-        uint32_t commit;
-        int32_t x, y;
-    } pending;
+        struct wl_list current, pending;
+        struct wl_list link, pending_link;
+    } stack;
 
     struct window * window;
     struct swc_view * view;
     struct wl_listener view_listener;
 
+    /* zwp_linux_dmabuf_feedback_v1 resources for the surface. */
+    struct wl_list dmabuf_feedbacks;
+
     struct wl_list link;
 };
 
@@ -80,5 +110,10 @@ struct swc_surface * swc_surface_new(struct wl_client * client,
 
 void swc_surface_set_view(struct swc_surface * surface, struct swc_view * view);
 
+/**
+ * Apply the state cached by a synchronized subsurface, if any.
+ */
+void swc_surface_apply_cached(struct swc_surface * surface);
+
 #endif
 
@@ -24,17 +24,22 @@
 #include "swc.h"
 #include "bindings.h"
 #include "compositor.h"
+#include "damage.h"
 #include "data_device_manager.h"
 #include "drm.h"
+#include "headless.h"
 #include "internal.h"
 #include "launch.h"
 #include "keyboard.h"
 #include "panel_manager.h"
 #include "pointer.h"
+#include "presentation.h"
+#include "record.h"
 #include "screen.h"
 #include "seat.h"
 #include "shell.h"
 #include "shm.h"
+#include "subcompositor.h"
 #include "util.h"
 #include "window.h"
 #ifdef ENABLE_XWAYLAND
@@ -92,6 +97,8 @@ bool swc_initialize(struct wl_display * display,
     swc.display = display;
     swc.event_loop = event_loop ?: wl_display_get_event_loop(display);
     swc.manager = manager;
+    swc.headless = getenv("SWC_HEADLESS") != NULL;
+    swc_damage_initialize();
     const char * default_seat = "seat0";
 
     if (!(swc_launch_initialize()))
@@ -100,9 +107,10 @@ bool swc_initialize(struct wl_display * display,
         goto error0;
     }
 
-    if (!swc_drm_initialize())
+    if (swc.headless ? !swc_headless_initialize() : !swc_drm_initialize())
     {
-        ERROR("Could not initialize DRM\n");
+        ERROR("Could not initialize %s\n", swc.headless ? "headless screens"
+                                                        : "DRM");
         goto error1;
     }
 
@@ -148,17 +156,35 @@ bool swc_initialize(struct wl_display * display,
         goto error8;
     }
 
+    if (!swc_subcompositor_initialize())
+    {
+        ERROR("Could not initialize subcompositor\n");
+        goto error9;
+    }
+
     if (!swc_panel_manager_initialize())
     {
         ERROR("Could not initialize panel manager\n");
-        goto error9;
+        goto error10;
+    }
+
+    if (!swc_presentation_initialize())
+    {
+        ERROR("Could not initialize presentation\n");
+        goto error11;
+    }
+
+    if (!swc_record_initialize())
+    {
+        ERROR("Could not initialize recording\n");
+        goto error12;
     }
 
 #ifdef ENABLE_XWAYLAND
     if (!swc_xserver_initialize())
     {
         ERROR("Could not initialize xwayland\n");
-        goto error10;
+        goto error13;
     }
 #endif
 
@@ -167,9 +193,15 @@ bool swc_initialize(struct wl_display * display,
     return true;
 
 #ifdef ENABLE_XWAYLAND
-  error10:
-    swc_panel_manager_finalize();
+  error13:
+    swc_record_finalize();
 #endif
+  error12:
+    swc_presentation_finalize();
+  error11:
+    swc_panel_manager_finalize();
+  error10:
+    swc_subcompositor_finalize();
   error9:
     swc_shell_finalize();
   error8:
@@ -185,7 +217,10 @@ bool swc_initialize(struct wl_display * display,
   error3:
     swc_shm_finalize();
   error2:
-    swc_drm_finalize();
+    if (swc.headless)
+        swc_headless_finalize();
+    else
+        swc_drm_finalize();
   error1:
     swc_launch_finalize();
   error0:
@@ -198,7 +233,10 @@ void swc_finalize()
 #ifdef ENABLE_XWAYLAND
     swc_xserver_finalize();
 #endif
+    swc_record_finalize();
+    swc_presentation_finalize();
     swc_panel_manager_finalize();
+    swc_subcompositor_finalize();
     swc_shell_finalize();
     swc_seat_finalize();
     swc_data_device_manager_finalize();
@@ -206,7 +244,10 @@ void swc_finalize()
     screens_finalize();
     swc_bindings_finalize();
     swc_shm_finalize();
-    swc_drm_finalize();
+    if (swc.headless)
+        swc_headless_finalize();
+    else
+        swc_drm_finalize();
     swc_launch_finalize();
 }
 
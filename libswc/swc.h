@@ -257,6 +257,31 @@ bool swc_initialize(struct wl_display * display,
  */
 void swc_finalize();
 
+/**
+ * Writes histograms of how long each phase of a frame took, and the number of
+ * missed vblanks, for each screen to stderr.
+ *
+ * swc doesn't handle any signals itself. This uses stdio, so it must not be
+ * called from an asynchronous signal handler; a compositor that wants the
+ * statistics on demand can call it from an event loop signal source
+ * (wl_event_loop_add_signal) instead.
+ */
+void swc_print_frame_timing();
+
+/**
+ * Writes the same statistics to a file as JSON, for tools to compare between
+ * runs. Durations are in microseconds.
+ *
+ * The file is replaced atomically, so it is never seen partially written.
+ */
+bool swc_write_frame_timing(const char * path);
+
+/**
+ * Clears the frame timing statistics of every screen, so that they only cover
+ * what happens from now on (for example, a single benchmark run).
+ */
+void swc_reset_frame_timing();
+
 #endif
 
 /* vim: set fdm=marker : */
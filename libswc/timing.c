@@ -0,0 +1,183 @@
+/* swc: libswc/timing.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "timing.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+static const char * phase_names[] = {
+    [SWC_TIMING_DAMAGE]     = "damage",
+    [SWC_TIMING_UPLOAD]     = "upload",
+    [SWC_TIMING_REPAINT]    = "repaint",
+    [SWC_TIMING_FLUSH]      = "flush",
+    [SWC_TIMING_FLIP]       = "flip"
+};
+
+static unsigned bucket(uint64_t duration)
+{
+    uint64_t usec = duration / 1000;
+    unsigned index;
+
+    if (usec == 0)
+        return 0;
+
+    index = 64 - __builtin_clzll(usec);
+
+    return index < SWC_HISTOGRAM_BUCKETS ? index : SWC_HISTOGRAM_BUCKETS - 1;
+}
+
+/* Prints a duration given in nanoseconds with a sensible unit. */
+static void print_duration(FILE * file, uint64_t duration)
+{
+    if (duration < 1000)
+        fprintf(file, "%lluns", (unsigned long long) duration);
+    else if (duration < 1000000)
+        fprintf(file, "%.1fus", duration / 1e3);
+    else
+        fprintf(file, "%.2fms", duration / 1e6);
+}
+
+static void print_histogram(struct swc_histogram * histogram, FILE * file)
+{
+    unsigned index;
+    uint64_t lower;
+
+    fprintf(file, "%llu samples, min ", (unsigned long long) histogram->count);
+    print_duration(file, histogram->min);
+    fputs(", mean ", file);
+    print_duration(file, histogram->total / histogram->count);
+    fputs(", max ", file);
+    print_duration(file, histogram->max);
+    fputc('\n', file);
+
+    for (index = 0; index < SWC_HISTOGRAM_BUCKETS; ++index)
+    {
+        if (!histogram->buckets[index])
+            continue;
+
+        lower = index ? 1ull << (index - 1) : 0;
+
+        if (index == SWC_HISTOGRAM_BUCKETS - 1)
+            fprintf(file, "\t\t>= %lluus", (unsigned long long) lower);
+        else
+            fprintf(file, "\t\t< %lluus", 1ull << index);
+
+        fprintf(file, ": %llu\n",
+                (unsigned long long) histogram->buckets[index]);
+    }
+}
+
+void swc_timing_initialize(struct swc_timing * timing)
+{
+    memset(timing, 0, sizeof *timing);
+}
+
+void swc_timing_add(struct swc_timing * timing, enum swc_timing_phase phase,
+                    uint64_t duration)
+{
+    struct swc_histogram * histogram = &timing->phases[phase];
+
+    if (histogram->count == 0 || duration < histogram->min)
+        histogram->min = duration;
+    if (duration > histogram->max)
+        histogram->max = duration;
+
+    ++histogram->count;
+    histogram->total += duration;
+    ++histogram->buckets[bucket(duration)];
+}
+
+void swc_timing_add_flip(struct swc_timing * timing, uint64_t submitted,
+                         uint64_t flipped, uint64_t refresh_interval)
+{
+    ++timing->frames;
+
+    /* The flip timestamp can be slightly earlier than the time we submitted
+     * the frame if it was submitted right at the vblank. */
+    if (flipped <= submitted)
+        return;
+
+    swc_timing_add(timing, SWC_TIMING_FLIP, flipped - submitted);
+
+    /* A frame should be displayed by the first vblank after it was
+     * submitted. */
+    if (refresh_interval)
+        timing->missed_vblanks += (flipped - submitted) / refresh_interval;
+}
+
+void swc_timing_print(struct swc_timing * timing, FILE * file)
+{
+    unsigned index;
+
+    fprintf(file, "\t%llu frames, %llu missed vblanks\n",
+            (unsigned long long) timing->frames,
+            (unsigned long long) timing->missed_vblanks);
+
+    for (index = 0; index < SWC_TIMING_NUM_PHASES; ++index)
+    {
+        if (!timing->phases[index].count)
+            continue;
+
+        fprintf(file, "\t%s: ", phase_names[index]);
+        print_histogram(&timing->phases[index], file);
+    }
+}
+
+void swc_timing_print_json(struct swc_timing * timing, FILE * file)
+{
+    struct swc_histogram * histogram;
+    unsigned index, bucket;
+    bool first = true;
+
+    fprintf(file, "{ \"frames\": %llu, \"missed_vblanks\": %llu, "
+                  "\"phases\": {",
+            (unsigned long long) timing->frames,
+            (unsigned long long) timing->missed_vblanks);
+
+    for (index = 0; index < SWC_TIMING_NUM_PHASES; ++index)
+    {
+        histogram = &timing->phases[index];
+
+        if (!histogram->count)
+            continue;
+
+        fprintf(file, "%s \"%s\": { \"count\": %llu, \"min_us\": %.1f, "
+                      "\"mean_us\": %.1f, \"max_us\": %.1f, \"buckets\": [",
+                first ? "" : ",", phase_names[index],
+                (unsigned long long) histogram->count, histogram->min / 1e3,
+                histogram->total / 1e3 / histogram->count,
+                histogram->max / 1e3);
+
+        for (bucket = 0; bucket < SWC_HISTOGRAM_BUCKETS; ++bucket)
+        {
+            fprintf(file, "%s%llu", bucket ? ", " : " ",
+                    (unsigned long long) histogram->buckets[bucket]);
+        }
+
+        fputs(" ] }", file);
+        first = false;
+    }
+
+    fputs(" } }", file);
+}
@@ -0,0 +1,100 @@
+/* swc: libswc/timing.h
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SWC_TIMING_H
+#define SWC_TIMING_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* Bucket 0 counts durations under a microsecond, and bucket n those in
+ * [2^(n - 1), 2^n) microseconds. The last bucket counts everything above. */
+#define SWC_HISTOGRAM_BUCKETS 24
+
+struct swc_histogram
+{
+    uint64_t buckets[SWC_HISTOGRAM_BUCKETS];
+
+    /* The number of samples, and their sum, minimum and maximum in
+     * nanoseconds. */
+    uint64_t count, total, min, max;
+};
+
+enum swc_timing_phase
+{
+    /* Calculating clip regions and damage (calculate_damage). */
+    SWC_TIMING_DAMAGE,
+
+    /* Copying SHM buffers into their proxies, including waiting for the
+     * upload threads. */
+    SWC_TIMING_UPLOAD,
+
+    /* Issuing the rendering commands for a screen (renderer_repaint). */
+    SWC_TIMING_REPAINT,
+
+    /* Flushing the rendering commands to the GPU (wld_flush). */
+    SWC_TIMING_FLUSH,
+
+    /* From submitting a frame to the page flip that displays it. */
+    SWC_TIMING_FLIP,
+
+    SWC_TIMING_NUM_PHASES
+};
+
+/**
+ * Frame timing statistics for a screen.
+ */
+struct swc_timing
+{
+    struct swc_histogram phases[SWC_TIMING_NUM_PHASES];
+
+    /* The number of frames displayed, and the number of vblanks that passed
+     * while a frame was waiting to be flipped after the first. */
+    uint64_t frames, missed_vblanks;
+};
+
+void swc_timing_initialize(struct swc_timing * timing);
+
+/**
+ * Record that a phase of a frame took the given number of nanoseconds.
+ */
+void swc_timing_add(struct swc_timing * timing, enum swc_timing_phase phase,
+                    uint64_t duration);
+
+/**
+ * Record that a frame submitted at the given time was displayed by a page
+ * flip at another, and count the vblanks it missed.
+ */
+void swc_timing_add_flip(struct swc_timing * timing, uint64_t submitted,
+                         uint64_t flipped, uint64_t refresh_interval);
+
+void swc_timing_print(struct swc_timing * timing, FILE * file);
+
+/**
+ * Write the statistics as a JSON object. Durations are in microseconds, and
+ * the buckets are listed in order, as described above.
+ */
+void swc_timing_print_json(struct swc_timing * timing, FILE * file);
+
+#endif
+
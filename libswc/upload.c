@@ -0,0 +1,366 @@
+/* swc: libswc/upload.c
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "upload.h"
+#include "convert.h"
+#include "internal.h"
+#include "shm.h"
+#include "util.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <wayland-util.h>
+#include <wld/wld.h>
+
+#define MAX_THREADS 8
+
+/* Large rectangles are split into bands of at most this many rows so that
+ * they can be spread across threads. */
+#define BAND_HEIGHT 64
+
+struct job
+{
+    struct wld_buffer * dst, * src;
+
+    /* If set, the data to convert instead of copying from src. */
+    const struct swc_convert_source * source;
+
+    pixman_box32_t box;
+};
+
+static struct
+{
+    pthread_t threads[MAX_THREADS];
+    unsigned num_threads;
+    bool quit;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t work, done;
+
+    /* The jobs of the current frame, the index of the next one to start, and
+     * the number that have not yet completed. */
+    struct wl_array jobs;
+    size_t next, remaining;
+
+    /* The buffers mapped for the current frame. */
+    struct wl_array buffers;
+} upload;
+
+static unsigned bytes_per_pixel(uint32_t format)
+{
+    switch (format)
+    {
+        case WLD_FORMAT_XRGB8888:
+        case WLD_FORMAT_ARGB8888:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+static void copy(const struct job * job)
+{
+    unsigned bpp = bytes_per_pixel(job->dst->format);
+    uint32_t width = job->box.x2 - job->box.x1;
+    int32_t y;
+    const char * src;
+    char * dst;
+
+    dst = (char *) job->dst->map
+        + job->box.y1 * job->dst->pitch + job->box.x1 * bpp;
+
+    if (job->source)
+    {
+        for (y = job->box.y1; y < job->box.y2; ++y)
+        {
+            swc_convert_row(job->source, (uint32_t *) dst,
+                            job->box.x1, y, width);
+            dst += job->dst->pitch;
+        }
+
+        return;
+    }
+
+    src = (const char *) job->src->map
+        + job->box.y1 * job->src->pitch + job->box.x1 * bpp;
+
+    for (y = job->box.y1; y < job->box.y2; ++y)
+    {
+        memcpy(dst, src, width * bpp);
+        src += job->src->pitch;
+        dst += job->dst->pitch;
+    }
+}
+
+static inline size_t num_jobs()
+{
+    return upload.jobs.size / sizeof(struct job);
+}
+
+/* Runs the next job; the mutex must be locked. */
+static void run_job()
+{
+    struct job job = ((struct job *) upload.jobs.data)[upload.next++];
+
+    pthread_mutex_unlock(&upload.mutex);
+    copy(&job);
+    pthread_mutex_lock(&upload.mutex);
+
+    if (--upload.remaining == 0)
+        pthread_cond_broadcast(&upload.done);
+}
+
+static void * run(void * data)
+{
+    pthread_mutex_lock(&upload.mutex);
+
+    while (true)
+    {
+        while (!upload.quit && upload.next == num_jobs())
+            pthread_cond_wait(&upload.work, &upload.mutex);
+
+        if (upload.quit)
+            break;
+
+        run_job();
+    }
+
+    pthread_mutex_unlock(&upload.mutex);
+
+    return NULL;
+}
+
+static bool add_buffer(struct wld_buffer * buffer)
+{
+    struct wld_buffer ** entry;
+
+    if (!(entry = wl_array_add(&upload.buffers, sizeof *entry)))
+        return false;
+
+    if (!wld_map(buffer))
+    {
+        upload.buffers.size -= sizeof *entry;
+        return false;
+    }
+
+    *entry = buffer;
+
+    return true;
+}
+
+bool swc_upload_queue(struct wld_buffer * dst, struct wld_buffer * src,
+                      pixman_region32_t * region)
+{
+    pixman_box32_t * boxes, box;
+    struct job * job;
+    const struct swc_convert_source * source = NULL;
+    union wld_object object;
+    int num_boxes, index;
+    int32_t y;
+    size_t size, remaining;
+
+    if (src->format != dst->format || !bytes_per_pixel(src->format)
+        || src->width != dst->width || src->height != dst->height)
+    {
+        return false;
+    }
+
+    /* Buffers in formats the renderers can't use are converted from the
+     * client's data, so they don't need to be mapped. */
+    if (wld_export(src, SWC_SHM_OBJECT_SOURCE, &object))
+        source = object.ptr;
+
+    if (!add_buffer(dst))
+        return false;
+
+    if (!source && !add_buffer(src))
+        return false;
+
+    boxes = pixman_region32_rectangles(region, &num_boxes);
+    pthread_mutex_lock(&upload.mutex);
+    size = upload.jobs.size;
+    remaining = upload.remaining;
+
+    for (index = 0; index < num_boxes; ++index)
+    {
+        box.x1 = MAX(boxes[index].x1, 0);
+        box.x2 = MIN(boxes[index].x2, (int32_t) src->width);
+        box.y1 = MAX(boxes[index].y1, 0);
+        box.y2 = MIN(boxes[index].y2, (int32_t) src->height);
+
+        if (box.x1 >= box.x2)
+            continue;
+
+        for (y = box.y1; y < box.y2; y += BAND_HEIGHT)
+        {
+            if (!(job = wl_array_add(&upload.jobs, sizeof *job)))
+                goto error0;
+
+            job->dst = dst;
+            job->src = src;
+            job->source = source;
+            job->box.x1 = box.x1;
+            job->box.x2 = box.x2;
+            job->box.y1 = y;
+            job->box.y2 = MIN(y + BAND_HEIGHT, box.y2);
+            ++upload.remaining;
+        }
+    }
+
+    pthread_cond_broadcast(&upload.work);
+    pthread_mutex_unlock(&upload.mutex);
+
+    return true;
+
+  error0:
+    /* The lock has been held since the first of these jobs was added, so none
+     * of them have started yet. Drop them all so that the caller can do the
+     * whole copy itself. */
+    upload.jobs.size = size;
+    upload.remaining = remaining;
+    pthread_mutex_unlock(&upload.mutex);
+
+    return false;
+}
+
+bool swc_upload_convert(struct wld_buffer * dst,
+                        const struct swc_convert_source * source,
+                        pixman_region32_t * region)
+{
+    pixman_box32_t * boxes;
+    struct job job = { .dst = dst, .source = source };
+    int num_boxes, index;
+
+    if (!bytes_per_pixel(dst->format)
+        || source->width != dst->width || source->height != dst->height
+        || !wld_map(dst))
+    {
+        return false;
+    }
+
+    boxes = pixman_region32_rectangles(region, &num_boxes);
+
+    for (index = 0; index < num_boxes; ++index)
+    {
+        job.box.x1 = MAX(boxes[index].x1, 0);
+        job.box.x2 = MIN(boxes[index].x2, (int32_t) dst->width);
+        job.box.y1 = MAX(boxes[index].y1, 0);
+        job.box.y2 = MIN(boxes[index].y2, (int32_t) dst->height);
+
+        if (job.box.x1 < job.box.x2 && job.box.y1 < job.box.y2)
+            copy(&job);
+    }
+
+    wld_unmap(dst);
+
+    return true;
+}
+
+void swc_upload_wait()
+{
+    struct wld_buffer ** buffer;
+
+    pthread_mutex_lock(&upload.mutex);
+
+    /* Help out with any jobs that haven't been started yet. */
+    while (upload.next < num_jobs())
+        run_job();
+
+    while (upload.remaining > 0)
+        pthread_cond_wait(&upload.done, &upload.mutex);
+
+    upload.jobs.size = 0;
+    upload.next = 0;
+    pthread_mutex_unlock(&upload.mutex);
+
+    wl_array_for_each(buffer, &upload.buffers)
+        wld_unmap(*buffer);
+
+    upload.buffers.size = 0;
+}
+
+bool swc_upload_initialize()
+{
+    const char * threads_string;
+    sigset_t signals, old_signals;
+    long num_threads;
+
+    if ((threads_string = getenv("SWC_UPLOAD_THREADS")))
+        num_threads = strtol(threads_string, NULL, 10);
+    else
+        num_threads = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+
+    num_threads = MAX(MIN(num_threads, MAX_THREADS), 0);
+
+    pthread_mutex_init(&upload.mutex, NULL);
+    pthread_cond_init(&upload.work, NULL);
+    pthread_cond_init(&upload.done, NULL);
+    wl_array_init(&upload.jobs);
+    wl_array_init(&upload.buffers);
+    upload.next = 0;
+    upload.remaining = 0;
+    upload.quit = false;
+
+    /* Signals are handled by the event loop on the main thread. */
+    sigfillset(&signals);
+    pthread_sigmask(SIG_BLOCK, &signals, &old_signals);
+
+    for (upload.num_threads = 0; upload.num_threads < num_threads;
+         ++upload.num_threads)
+    {
+        if (pthread_create(&upload.threads[upload.num_threads], NULL,
+                           &run, NULL) != 0)
+        {
+            WARNING("Could not create upload thread\n");
+            break;
+        }
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old_signals, NULL);
+    DEBUG("Using %u upload threads\n", upload.num_threads);
+
+    return true;
+}
+
+void swc_upload_finalize()
+{
+    unsigned index;
+
+    pthread_mutex_lock(&upload.mutex);
+    upload.quit = true;
+    pthread_cond_broadcast(&upload.work);
+    pthread_mutex_unlock(&upload.mutex);
+
+    for (index = 0; index < upload.num_threads; ++index)
+        pthread_join(upload.threads[index], NULL);
+
+    wl_array_release(&upload.jobs);
+    wl_array_release(&upload.buffers);
+    pthread_cond_destroy(&upload.done);
+    pthread_cond_destroy(&upload.work);
+    pthread_mutex_destroy(&upload.mutex);
+}
+
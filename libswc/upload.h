@@ -0,0 +1,66 @@
+/* swc: libswc/upload.h
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SWC_UPLOAD_H
+#define SWC_UPLOAD_H
+
+#include <stdbool.h>
+#include <pixman.h>
+
+struct swc_convert_source;
+struct wld_buffer;
+
+bool swc_upload_initialize();
+void swc_upload_finalize();
+
+/**
+ * Queue a copy of a region of one buffer into another buffer of the same
+ * format and size, to be run by the upload threads.
+ *
+ * If src is a SHM buffer in a format that must be converted, the client's
+ * data is converted instead.
+ *
+ * The region is copied, so it may be modified after this returns. The buffers
+ * must stay alive until swc_upload_wait is called.
+ *
+ * Returns false if the copy can't be done by the upload threads, in which case
+ * nothing was queued.
+ */
+bool swc_upload_queue(struct wld_buffer * dst, struct wld_buffer * src,
+                      pixman_region32_t * region);
+
+/**
+ * Convert a region of pixel data into a buffer of the same size on the calling
+ * thread, for when swc_upload_queue can't be used.
+ */
+bool swc_upload_convert(struct wld_buffer * dst,
+                        const struct swc_convert_source * source,
+                        pixman_region32_t * region);
+
+/**
+ * Wait for all queued copies to complete.
+ */
+void swc_upload_wait();
+
+#endif
+
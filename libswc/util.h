@@ -30,8 +30,9 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
-#include <sys/time.h>
+#include <time.h>
 #include <sys/param.h>
+#include <sys/time.h>
 #include <pixman.h>
 #include <wayland-util.h>
 
@@ -73,12 +74,41 @@ struct wl_resource;
 
 void swc_remove_resource(struct wl_resource * resource);
 
-static inline uint32_t swc_time()
+/* All timestamps are taken from the monotonic clock: page flip events (if the
+ * DRM device supports it), input events and our own. They are kept in
+ * nanoseconds internally and only truncated to milliseconds for protocol
+ * events. */
+static inline uint64_t swc_timespec_to_nsec(const struct timespec * time)
+{
+    return (uint64_t) time->tv_sec * 1000000000 + time->tv_nsec;
+}
+
+static inline uint64_t swc_timeval_to_nsec(const struct timeval * time)
 {
-    struct timeval timeval;
+    return (uint64_t) time->tv_sec * 1000000000 + time->tv_usec * 1000;
+}
+
+static inline uint32_t swc_nsec_to_msec(uint64_t nsec)
+{
+    return nsec / 1000000;
+}
 
-    gettimeofday(&timeval, NULL);
-    return timeval.tv_sec * 1000 + timeval.tv_usec / 1000;
+static inline uint64_t swc_time_nsec()
+{
+    struct timespec timespec;
+
+    clock_gettime(CLOCK_MONOTONIC, &timespec);
+    return swc_timespec_to_nsec(&timespec);
+}
+
+static inline uint32_t swc_timespec_to_msec(const struct timespec * time)
+{
+    return swc_nsec_to_msec(swc_timespec_to_nsec(time));
+}
+
+static inline uint32_t swc_timeval_to_msec(const struct timeval * time)
+{
+    return swc_nsec_to_msec(swc_timeval_to_nsec(time));
 }
 
 extern pixman_box32_t infinite_extents;
@@ -39,6 +39,7 @@ void swc_view_initialize(struct swc_view * view,
     view->geometry.height = 0;
     view->buffer = NULL;
     view->screens = 0;
+    view->scanout = 0;
     wl_signal_init(&view->event_signal);
 }
 
@@ -139,9 +140,20 @@ void swc_view_update_screens(struct swc_view * view)
     swc_view_set_screens(view, screens);
 }
 
-void swc_view_frame(struct swc_view * view, uint32_t time)
+void swc_view_set_scanout(struct swc_view * view, uint32_t scanout)
 {
-    struct swc_view_event_data data = { .view = view, .frame = { time } };
+    struct swc_view_event_data data = { .view = view };
+
+    if (view->scanout == scanout)
+        return;
+
+    view->scanout = scanout;
+    swc_send_event(&view->event_signal, SWC_VIEW_EVENT_SCANOUT_CHANGED, &data);
+}
+
+void swc_view_frame(struct swc_view * view, const struct swc_frame * frame)
+{
+    struct swc_view_event_data data = { .view = view, .frame = *frame };
 
     swc_send_event(&view->event_signal, SWC_VIEW_EVENT_FRAME, &data);
 }
@@ -26,6 +26,8 @@
 
 #include "swc.h"
 
+#include <time.h>
+
 enum
 {
     /* Sent when the view has displayed the next frame. */
@@ -38,7 +40,38 @@ enum
     SWC_VIEW_EVENT_RESIZED,
 
     /* Sent when the set of screens the view is visible on changes. */
-    SWC_VIEW_EVENT_SCREENS_CHANGED
+    SWC_VIEW_EVENT_SCREENS_CHANGED,
+
+    /* Sent when the set of screens that scan out the view's buffer directly
+     * changes. */
+    SWC_VIEW_EVENT_SCANOUT_CHANGED
+};
+
+struct screen;
+
+/**
+ * Timing information about a frame displayed by a view.
+ */
+struct swc_frame
+{
+    /* The time the frame was displayed, using CLOCK_MONOTONIC. */
+    struct timespec time;
+
+    /* The vblank counter of the screen at that time, and the screen's refresh
+     * interval in nanoseconds, or 0 if unknown. */
+    uint64_t sequence;
+    uint32_t refresh;
+
+    /* The screen the frame was synchronized to, if any. */
+    struct screen * screen;
+
+    /* WP_PRESENTATION_FEEDBACK_KIND_* flags describing how the frame was
+     * displayed. */
+    uint32_t flags;
+
+    /* Whether the frame could actually be seen. If not (for example, if the
+     * view was covered by other views), presentation feedback is discarded. */
+    bool presented;
 };
 
 /**
@@ -52,10 +85,7 @@ struct swc_view_event_data
     struct swc_view * view;
     union
     {
-        struct
-        {
-            uint32_t time;
-        } frame;
+        struct swc_frame frame;
 
         struct
         {
@@ -84,6 +114,10 @@ struct swc_view
     struct swc_rectangle geometry;
     uint32_t screens;
 
+    /* The screens whose display hardware scans out the view's buffer, without
+     * it being composited first. */
+    uint32_t scanout;
+
     struct wld_buffer * buffer;
 };
 
@@ -141,15 +175,16 @@ void swc_view_set_size_from_buffer(struct swc_view * view,
                                    struct wld_buffer * bufer);
 void swc_view_set_screens(struct swc_view * view, uint32_t screens);
 void swc_view_update_screens(struct swc_view * view);
+void swc_view_set_scanout(struct swc_view * view, uint32_t scanout);
 
 /**
  * Send a new frame event through the view's event signal.
  *
  * This should be called by the view itself when the next frame is visible to
- * the user. If time information is not available, swc_time() can be passed
- * instead.
+ * the user. If precise timing is not available, the current time can be used
+ * instead, with no flags set.
  */
-void swc_view_frame(struct swc_view * view, uint32_t time);
+void swc_view_frame(struct swc_view * view, const struct swc_frame * frame);
 
 #endif
 
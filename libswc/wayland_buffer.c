@@ -26,9 +26,24 @@
 #include "shm.h"
 #include "util.h"
 
+#include <stdlib.h>
 #include <wld/wld.h>
 #include <wld/pixman.h>
 
+/* The state of a WLD buffer that belongs to a wl_buffer. It lives as long as
+ * the WLD buffer, which may be scanned out after the resource is gone. */
+struct wayland_buffer
+{
+    struct wld_exporter exporter;
+    struct wld_destructor destructor;
+    struct wl_resource * resource;
+
+    /* How many planes are scanning out the buffer, and whether a release
+     * event is waiting for them to stop. */
+    unsigned scanouts;
+    bool release_pending;
+};
+
 static void destroy(struct wl_client * client, struct wl_resource * resource)
 {
     wl_resource_destroy(resource);
@@ -49,9 +64,47 @@ struct wld_buffer * swc_wayland_buffer_get(struct wl_resource * resource)
     return NULL;
 }
 
+static struct wayland_buffer * get_wayland_buffer(struct wld_buffer * buffer)
+{
+    union wld_object object;
+
+    return wld_export(buffer, WLD_USER_OBJECT_WAYLAND_BUFFER, &object)
+        ? object.ptr : NULL;
+}
+
+static bool wayland_buffer_export(struct wld_exporter * exporter,
+                                  struct wld_buffer * buffer,
+                                  uint32_t type, union wld_object * object)
+{
+    struct wayland_buffer * wayland_buffer
+        = CONTAINER_OF(exporter, typeof(*wayland_buffer), exporter);
+
+    switch (type)
+    {
+        case WLD_USER_OBJECT_WAYLAND_BUFFER:
+            object->ptr = wayland_buffer;
+            break;
+        default: return false;
+    }
+
+    return true;
+}
+
+static void wayland_buffer_destroy(struct wld_destructor * destructor)
+{
+    struct wayland_buffer * wayland_buffer
+        = CONTAINER_OF(destructor, typeof(*wayland_buffer), destructor);
+
+    free(wayland_buffer);
+}
+
 static void destroy_buffer(struct wl_resource * resource)
 {
     struct wld_buffer * buffer = wl_resource_get_user_data(resource);
+    struct wayland_buffer * wayland_buffer = get_wayland_buffer(buffer);
+
+    if (wayland_buffer)
+        wayland_buffer->resource = NULL;
 
     wld_buffer_unreference(buffer);
 }
@@ -60,18 +113,76 @@ struct wl_resource * swc_wayland_buffer_create_resource
     (struct wl_client * client, uint32_t id, struct wld_buffer * buffer)
 {
     struct wl_resource * resource;
+    struct wayland_buffer * wayland_buffer;
+
+    if (!(wayland_buffer = malloc(sizeof *wayland_buffer)))
+        goto error0;
 
     resource = wl_resource_create(client, &wl_buffer_interface, 1, id);
 
     if (!resource)
-    {
-        wl_client_post_no_memory(client);
-        return NULL;
-    }
+        goto error1;
 
     wl_resource_set_implementation(resource, &buffer_implementation,
                                    buffer, &destroy_buffer);
 
+    wayland_buffer->resource = resource;
+    wayland_buffer->scanouts = 0;
+    wayland_buffer->release_pending = false;
+    wayland_buffer->exporter.export = &wayland_buffer_export;
+    wld_buffer_add_exporter(buffer, &wayland_buffer->exporter);
+    wayland_buffer->destructor.destroy = &wayland_buffer_destroy;
+    wld_buffer_add_destructor(buffer, &wayland_buffer->destructor);
+
     return resource;
+
+  error1:
+    free(wayland_buffer);
+  error0:
+    wl_client_post_no_memory(client);
+    return NULL;
+}
+
+void swc_wayland_buffer_release(struct wl_resource * resource)
+{
+    struct wayland_buffer * wayland_buffer
+        = get_wayland_buffer(wl_resource_get_user_data(resource));
+
+    if (wayland_buffer && wayland_buffer->scanouts > 0)
+    {
+        wayland_buffer->release_pending = true;
+        return;
+    }
+
+    wl_buffer_send_release(resource);
+}
+
+void swc_wayland_buffer_cancel_release(struct wld_buffer * buffer)
+{
+    struct wayland_buffer * wayland_buffer = get_wayland_buffer(buffer);
+
+    if (wayland_buffer)
+        wayland_buffer->release_pending = false;
+}
+
+void swc_wayland_buffer_begin_scanout(struct wld_buffer * buffer)
+{
+    struct wayland_buffer * wayland_buffer = get_wayland_buffer(buffer);
+
+    if (wayland_buffer)
+        ++wayland_buffer->scanouts;
+}
+
+void swc_wayland_buffer_end_scanout(struct wld_buffer * buffer)
+{
+    struct wayland_buffer * wayland_buffer = get_wayland_buffer(buffer);
+
+    if (!wayland_buffer || --wayland_buffer->scanouts > 0)
+        return;
+
+    if (wayland_buffer->release_pending && wayland_buffer->resource)
+        wl_buffer_send_release(wayland_buffer->resource);
+
+    wayland_buffer->release_pending = false;
 }
 
@@ -34,5 +34,29 @@ struct wld_buffer * swc_wayland_buffer_get(struct wl_resource * resource);
 struct wl_resource * swc_wayland_buffer_create_resource
     (struct wl_client * client, uint32_t id, struct wld_buffer * buffer);
 
+/**
+ * Tell the client that the compositor is done with a buffer.
+ *
+ * If the display hardware is still scanning the buffer out, the release is
+ * deferred until it stops.
+ */
+void swc_wayland_buffer_release(struct wl_resource * resource);
+
+/**
+ * Cancel a deferred release, for example because the client attached the
+ * buffer again.
+ */
+void swc_wayland_buffer_cancel_release(struct wld_buffer * buffer);
+
+/**
+ * Mark a buffer as being scanned out by the display hardware, until a
+ * matching call to swc_wayland_buffer_end_scanout.
+ *
+ * These calls can be nested, and do nothing for buffers that don't belong to
+ * a client.
+ */
+void swc_wayland_buffer_begin_scanout(struct wld_buffer * buffer);
+void swc_wayland_buffer_end_scanout(struct wld_buffer * buffer);
+
 #endif
 
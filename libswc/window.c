@@ -27,6 +27,7 @@
 #include "internal.h"
 #include "keyboard.h"
 #include "seat.h"
+#include "subsurface.h"
 #include "swc.h"
 #include "util.h"
 #include "view.h"
@@ -45,7 +46,11 @@ static void handle_window_enter(struct wl_listener * listener, void * data)
     if (event->type != SWC_INPUT_FOCUS_EVENT_CHANGED)
         return;
 
-    if (!event_data->new || !(window = event_data->new->window))
+    if (!event_data->new)
+        return;
+
+    /* Entering a subsurface enters the window it is part of. */
+    if (!(window = swc_subsurface_get_root(event_data->new)->window))
         return;
 
     swc_send_event(&window->base.event_signal, SWC_WINDOW_ENTERED, NULL);
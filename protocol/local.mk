@@ -3,6 +3,8 @@
 dir := protocol
 
 PROTOCOL_EXTENSIONS =           \
+    $(dir)/linux-dmabuf-unstable-v1.xml \
+    $(dir)/presentation-time.xml \
     $(dir)/swc.xml              \
     $(dir)/wayland-drm.xml      \
     $(dir)/xserver.xml
@@ -16,6 +18,11 @@ $(dir)/%-protocol.c: $(dir)/%.xml
 $(dir)/%-server-protocol.h: $(dir)/%.xml
 	$(call quiet,GEN,$(WAYLAND_SCANNER)) server-header < $< > $@
 
+$(dir)/%-client-protocol.h: $(dir)/%.xml
+	$(call quiet,GEN,$(WAYLAND_SCANNER)) client-header < $< > $@
+
+CLEAN_FILES += $(dir)/presentation-time-client-protocol.h
+
 install-protocol: | $(DESTDIR)$(DATADIR)/swc
 	install -m0644 protocol/swc.xml "$(DESTDIR)$(DATADIR)/swc"
 